@@ -0,0 +1,184 @@
+/*
+ * Copyright (C) 2006 Cooper Street Innovations Inc.
+ *	Charles Eidsness    <charles@cooper-street.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ */
+
+#ifndef SIMULATOR_H
+#define SIMULATOR_H
+
+#define SIMULATOR_MAJOR_VERSION		2
+#define SIMULATOR_MINOR_VERSION		4
+
+typedef struct _simulator simulator_;
+
+/* The data returned by a run is handed over without a copy, it belongs to
+ * the caller and has to be freed by it. Every run only returns the points
+ * it added, so a transient that's continued (restart == 0) starts where
+ * the last one ended and its first point repeats that run's last time.
+ */
+int simulatorRunTransient(simulator_ *r,
+	double tstep,	/* Seconds */
+	double tstop,	/* Seconds */
+	double tmax,	/* Seconds (0.0 for none) */
+	int restart,	/* Clear out the data and restart the simulator */
+	double *data[],
+	char **variables[],
+	int *numPoints,
+	int *numVariables);
+int simulatorRunOperatingPoint(simulator_ *r,
+	double *data[],
+	char **variables[],
+	int *numPoints,
+	int *numVariables);
+
+/* Only the saved variables (i.e. v(1) or i(Vx)) are returned from a run,
+ * everything is if none are, NULL clears the list. Takes effect the next
+ * time the simulator is (re)started.
+ */
+int simulatorSave(simulator_ *r,
+	char *variable);
+
+/* Sets an analysis option by its lower case Spice style name (i.e. reltol,
+ * maxorder), enumerated options take the number of their value:
+ *	method		0 trap, 1 gear
+ *	lulibrary	0 superlu, 1 dense, 2 cktlu, 3 auto
+ *	luordering	0 colamd, 1 mmd_ata, 2 mmd_atplusa, 3 natural, 4 auto
+ * The lu options, chord, woodburyrank and predictor have to be set before
+ * the first analysis.
+ */
+int simulatorSetOption(simulator_ *r,
+	char *name,
+	double value);
+
+int simulatorAddResistor(simulator_ *r,
+	char *refdes,
+	char *pNode,
+	char *nNode,
+	double *resistance); /* Ohms */
+
+int simulatorAddCapacitor(simulator_ *r,
+	char *refdes,
+	char *pNode,
+	char *nNode,
+	double *capacitance); /* Farads */
+
+int simulatorAddInductor(simulator_ *r,
+	char *refdes,
+	char *pNode,
+	char *nNode,
+	double *inductance); /* Henrys */
+
+int simulatorAddNonlinearSource(simulator_ *r,
+	char *refdes,
+	char *pNode,
+	char *nNode,
+	char type,		/* Either 'i' or 'v' */
+	char *equation);
+
+int simulatorAddSource(simulator_ *r,
+	char *refdes,
+	char *pNode,
+	char *nNode,
+	char type,
+	double *dc,		/* Volts / Amps (can be NULL) */
+	char stimulus,	/*-------------*
+					 | none  | 0x0 |
+					 | pulse | 'p' |
+					 | sin   | 's' |
+					 | exp   | 'e' |
+					 | pwl   | 'l' |
+					 | pwc   | 'c' |
+					 | sffm  | 'f' |
+					 *-------------*/
+	double *args[7]);
+
+int simulatorAddTLine(simulator_ *r,
+	char *refdes,
+	char *pNodeLeft,
+	char *nNodeLeft,
+	char *pNodeRight,
+	char *nNodeRight,
+	double *Z0,
+	double *Td,
+	double *loss);
+
+
+int simulatorAddTLineW(simulator_ *r,
+	char *refdes,
+	char *nodes[], int nNodes,
+	int *M,			/* order of approixmation */
+	double *len, 	/* Length of the T-Line in inches */
+	double **L0,	/* DC inductance matrix per unit length */
+	double **C0,	/* DC capacitance matrix per unit length */
+	double **R0,	/* DC resistance matrix per unit length */
+	double **G0,	/* DC shunt conductance matrix per unit length */
+	double **Rs,	/* Skin-effect resistance matrix per unit length */
+	double **Gd,	/* Dielectric-loss conductance matrix per unit length */
+	double *fgd,		/* Cut-off for the Dielectric Loss */
+	double *fK		/* Cut-off frequency */
+);
+
+int simulatorAddVoltageControlledCap(simulator_ *r,
+	char *refdes,
+	char *pNode,	/* positive node */
+	char *nNode,	/* negative node */
+	char *cNode);	/* control node */
+
+int simulatorAddVICurve(simulator_ *r,
+	char *refdes,
+	char *pNode,
+	char *nNode,
+	double **vi,
+	int *viLength,
+	char viType,
+	double **ta,
+	int *taLength,
+	char taType);
+
+typedef int (*simulatorCallback_)(double *xN, void *private);
+int simulatorAddCallbackSource(simulator_ *r,
+	char *refdes,
+	char *pNode,
+	char *nNode,
+	char type,
+	char *variables[],
+	double values[],
+	double derivs[],
+	int numVariables,
+	simulatorCallback_ callback,
+	void *private);
+
+int simulatorInfo(void);
+int simulatorPrintDevices(simulator_ *r);
+int simulatorGetStats(simulator_ *r,
+	int *factorizations,	/* Full LU factorizations (can be NULL) */
+	int *refactorizations,	/* Numeric only refactorizations (can be NULL) */
+	int *substitutions,		/* Solves that reused the last LU (can be NULL) */
+	int *bypasses);			/* Device evaluations skipped (can be NULL) */
+int simulatorGetBlocks(simulator_ *r,
+	int *numBlocks,		/* Independent diagonal blocks (can be NULL) */
+	int *maxBlock);		/* Unknowns in the largest block (can be NULL) */
+int simulatorGetSymbolicStats(	/* Shared by every simulator in the process */
+	int *hits,			/* Topologies that had been analyzed (can be NULL) */
+	int *misses);		/* Topologies analyzed from scratch (can be NULL) */
+
+int simulatorDestroy(simulator_ **r);
+simulator_ * simulatorNew(simulator_ *r);
+
+#endif
@@ -0,0 +1,328 @@
+/*
+ * Copyright (C) 2006 Cooper Street Innovations Inc.
+ *	Charles Eidsness    <charles@cooper-street.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ */
+
+#include <math.h>
+#include <log.h>
+
+#include "cktlu_internal.h"
+
+/*
+ * Approximate Minimum Degree ordering.
+ *
+ * Based on the algorithm by Amestoy, Davis and Duff. Eliminated nodes
+ * become elements in a quotient graph, elements adjacent to the pivot are
+ * absorbed into the new element and degrees are replaced by AMD's
+ * approximate external degree, which only needs one pass over the new
+ * element to update. Dense rows are removed up front and ordered last.
+ * Supervariable detection is not done, circuit matrices have very few
+ * indistinguishable nodes.
+ */
+
+#define AMD_VARIABLE	0
+#define AMD_ELEMENT		1
+#define AMD_ABSORBED	2
+
+typedef struct {
+	int *data;
+	int length;
+	int size;
+} amdList_;
+
+/*---------------------------------------------------------------------------*/
+
+static int amdListAdd(amdList_ *r, int value)
+{
+	int *data;
+	if(r->length >= r->size) {
+		r->size = (r->size > 0) ? 2*r->size : 4;
+		data = realloc(r->data, r->size * sizeof(int));
+		ReturnErrIf(data == NULL);
+		r->data = data;
+	}
+	r->data[r->length++] = value;
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void amdListFree(amdList_ *r)
+{
+	if(r->data != NULL) {
+		free(r->data);
+	}
+	r->data = NULL;
+	r->length = 0;
+	r->size = 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void amdDegreeRemove(int i, int *deg, int *head, int *next, int *prev)
+{
+	if(prev[i] >= 0) {
+		next[prev[i]] = next[i];
+	} else {
+		head[deg[i]] = next[i];
+	}
+	if(next[i] >= 0) {
+		prev[next[i]] = prev[i];
+	}
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void amdDegreeInsert(int i, int *deg, int *head, int *next, int *prev)
+{
+	prev[i] = -1;
+	next[i] = head[deg[i]];
+	if(next[i] >= 0) {
+		prev[next[i]] = i;
+	}
+	head[deg[i]] = i;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Orders the symmetric pattern S (compressed column, both triangles, the
+ * diagonal and duplicates are ignored). order[k] is the kth node to
+ * eliminate.
+ */
+int cktluAMD(int n, int *Sp, int *Si, int *order)
+{
+	amdList_ *vars = NULL, *elements = NULL;
+	int *work = NULL, *status, *deg, *head, *next, *prev, *mark, *wmark, *w;
+	int *esize, *lp, *dense;
+	int i, j, e, p, t, k, d, v, stamp, nlp, nlive, mindeg, dmax, length;
+
+	ReturnErrIf(Sp == NULL);
+	ReturnErrIf(Si == NULL);
+	ReturnErrIf(order == NULL);
+
+	if(n == 0) {
+		return 0;
+	}
+
+	vars = calloc(n, sizeof(amdList_));
+	GotoFailedIf(vars == NULL);
+	elements = calloc(n, sizeof(amdList_));
+	GotoFailedIf(elements == NULL);
+	work = calloc(12 * n + 1, sizeof(int));
+	GotoFailedIf(work == NULL);
+	status = work;
+	deg = work + n;
+	head = work + 2*n;		/* n + 1 */
+	next = work + 3*n + 1;
+	prev = work + 4*n + 1;
+	mark = work + 5*n + 1;
+	wmark = work + 6*n + 1;
+	w = work + 7*n + 1;
+	esize = work + 8*n + 1;
+	lp = work + 9*n + 1;
+	dense = work + 10*n + 1;
+
+	/* Find the degree of each node and remove the dense ones */
+	dmax = (int)(10.0 * sqrt((double)n));
+	dmax = (dmax < 16) ? 16 : dmax;
+	stamp = 0;
+	for(i = 0; i < n; i++) {
+		stamp++;
+		mark[i] = stamp;
+		d = 0;
+		for(p = Sp[i]; p < Sp[i+1]; p++) {
+			if(mark[Si[p]] != stamp) {
+				mark[Si[p]] = stamp;
+				d++;
+			}
+		}
+		dense[i] = (d > dmax);
+	}
+
+	/* Build the variable lists */
+	for(i = 0; i < n; i++) {
+		if(dense[i]) {
+			continue;
+		}
+		stamp++;
+		mark[i] = stamp;
+		for(p = Sp[i]; p < Sp[i+1]; p++) {
+			j = Si[p];
+			if((mark[j] != stamp) && !dense[j]) {
+				mark[j] = stamp;
+				GotoFailedIf(amdListAdd(&vars[i], j));
+			}
+		}
+	}
+
+	for(i = 0; i <= n; i++) {
+		head[i] = -1;
+	}
+	nlive = 0;
+	for(i = 0; i < n; i++) {
+		status[i] = AMD_VARIABLE;
+		if(!dense[i]) {
+			deg[i] = vars[i].length;
+			amdDegreeInsert(i, deg, head, next, prev);
+			nlive++;
+		}
+	}
+
+	mindeg = 0;
+	for(k = 0; k < nlive; ) {
+		/* Select the pivot with the smallest approximate degree */
+		while((mindeg < n) && (head[mindeg] < 0)) {
+			mindeg++;
+		}
+		p = head[mindeg];
+		amdDegreeRemove(p, deg, head, next, prev);
+		order[k++] = p;
+
+		/* Construct the new element Lp from the variables adjacent to p
+		 * and the variables of every element adjacent to p, those elements
+		 * are absorbed.
+		 */
+		stamp++;
+		mark[p] = stamp;
+		nlp = 0;
+		for(t = 0; t < vars[p].length; t++) {
+			v = vars[p].data[t];
+			if((status[v] == AMD_VARIABLE) && (mark[v] != stamp)) {
+				mark[v] = stamp;
+				lp[nlp++] = v;
+			}
+		}
+		for(t = 0; t < elements[p].length; t++) {
+			e = elements[p].data[t];
+			if(status[e] != AMD_ELEMENT) {
+				continue;
+			}
+			for(j = 0; j < vars[e].length; j++) {
+				v = vars[e].data[j];
+				if((status[v] == AMD_VARIABLE) && (mark[v] != stamp)) {
+					mark[v] = stamp;
+					lp[nlp++] = v;
+				}
+			}
+			status[e] = AMD_ABSORBED;
+			amdListFree(&vars[e]);
+		}
+		amdListFree(&elements[p]);
+		status[p] = AMD_ELEMENT;
+		vars[p].length = 0;
+		for(t = 0; t < nlp; t++) {
+			GotoFailedIf(amdListAdd(&vars[p], lp[t]));
+		}
+		esize[p] = nlp;
+
+		/* w[e] = |Le \ Lp| for every element adjacent to Lp */
+		for(t = 0; t < nlp; t++) {
+			i = lp[t];
+			amdDegreeRemove(i, deg, head, next, prev);
+			length = 0;
+			for(j = 0; j < elements[i].length; j++) {
+				e = elements[i].data[j];
+				if(status[e] != AMD_ELEMENT) {
+					continue;
+				}
+				elements[i].data[length++] = e;
+				if(wmark[e] != stamp) {
+					wmark[e] = stamp;
+					w[e] = esize[e];
+				}
+				w[e]--;
+			}
+			elements[i].length = length;
+		}
+
+		/* Prune the lists and update the approximate degree of Lp */
+		for(t = 0; t < nlp; t++) {
+			i = lp[t];
+			length = 0;
+			for(j = 0; j < vars[i].length; j++) {
+				v = vars[i].data[j];
+				if((status[v] == AMD_VARIABLE) && (mark[v] != stamp)) {
+					vars[i].data[length++] = v;
+				}
+			}
+			vars[i].length = length;
+
+			d = length + nlp - 1;
+			length = 0;
+			for(j = 0; j < elements[i].length; j++) {
+				e = elements[i].data[j];
+				if(status[e] != AMD_ELEMENT) {
+					continue;
+				}
+				if(w[e] == 0) {
+					/* Le is a subset of Lp, aggressive absorption */
+					status[e] = AMD_ABSORBED;
+					amdListFree(&vars[e]);
+					continue;
+				}
+				d += w[e];
+				elements[i].data[length++] = e;
+			}
+			elements[i].length = length;
+			GotoFailedIf(amdListAdd(&elements[i], p));
+
+			d = (d < (deg[i] + nlp - 1)) ? d : (deg[i] + nlp - 1);
+			d = (d < (nlive - k - 1)) ? d : (nlive - k - 1);
+			deg[i] = (d > 0) ? d : 0;
+			amdDegreeInsert(i, deg, head, next, prev);
+			mindeg = (deg[i] < mindeg) ? deg[i] : mindeg;
+		}
+	}
+
+	/* Dense nodes go last */
+	for(i = 0; i < n; i++) {
+		if(dense[i]) {
+			order[k++] = i;
+		}
+	}
+
+	for(i = 0; i < n; i++) {
+		amdListFree(&vars[i]);
+		amdListFree(&elements[i]);
+	}
+	free(vars);
+	free(elements);
+	free(work);
+	return 0;
+
+failed:
+	if(vars != NULL) {
+		for(i = 0; i < n; i++) {
+			amdListFree(&vars[i]);
+		}
+		free(vars);
+	}
+	if(elements != NULL) {
+		for(i = 0; i < n; i++) {
+			amdListFree(&elements[i]);
+		}
+		free(elements);
+	}
+	if(work != NULL) {
+		free(work);
+	}
+	return -1;
+}
+
+/*===========================================================================*/
@@ -0,0 +1,216 @@
+/*
+ * Copyright (C) 2006 Cooper Street Innovations Inc.
+ *	Charles Eidsness    <charles@cooper-street.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ */
+
+#include <log.h>
+
+#include "cktlu_internal.h"
+
+/*===========================================================================
+ |                           Maximum Transversal                             |
+  ===========================================================================*/
+
+/* Find an augmenting path starting at column k, a depth first search with
+ * a cheap assignment look-ahead (Duff's MC21 algorithm).
+ */
+static void cktluAugment(int k, int *Ap, int *Ai, int *match, int *cheap,
+		int *visited, int *js, int *is, int *ps)
+{
+	int found = 0, head = 0, p, i = -1, j;
+
+	js[0] = k;
+	while(head >= 0) {
+		j = js[head];
+		if(visited[j] != k) {
+			/* First time the column has been seen, look for a free row */
+			visited[j] = k;
+			for(p = cheap[j]; (p < Ap[j+1]) && !found; p++) {
+				i = Ai[p];
+				found = (match[i] == -1);
+			}
+			cheap[j] = p;
+			if(found) {
+				is[head] = i;
+				break;
+			}
+			ps[head] = Ap[j];
+		}
+		/* Continue the search through a matched row */
+		for(p = ps[head]; p < Ap[j+1]; p++) {
+			i = Ai[p];
+			if(visited[match[i]] == k) {
+				continue;
+			}
+			ps[head] = p + 1;
+			is[head] = i;
+			js[++head] = match[i];
+			break;
+		}
+		if(p == Ap[j+1]) {
+			head--;
+		}
+	}
+
+	if(found) {
+		for(p = head; p >= 0; p--) {
+			match[is[p]] = js[p];
+		}
+	}
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Matches every row with a column such that A(i,match[i]) is non-zero,
+ * returns the structural rank of A.
+ */
+int cktluMaxTransversal(int n, int *Ap, int *Ai, int *match)
+{
+	int *work, *cheap, *visited, *js, *is, *ps;
+	int i, k, rank;
+
+	ReturnErrIf(Ap == NULL);
+	ReturnErrIf(Ai == NULL);
+	ReturnErrIf(match == NULL);
+
+	work = malloc(5 * n * sizeof(int) + 1);
+	ReturnErrIf(work == NULL);
+	cheap = work;
+	visited = work + n;
+	js = work + 2*n;
+	is = work + 3*n;
+	ps = work + 4*n;
+
+	for(k = 0; k < n; k++) {
+		cheap[k] = Ap[k];
+		visited[k] = -1;
+		match[k] = -1;
+	}
+
+	for(k = 0; k < n; k++) {
+		cktluAugment(k, Ap, Ai, match, cheap, visited, js, is, ps);
+	}
+
+	rank = 0;
+	for(i = 0; i < n; i++) {
+		if(match[i] >= 0) {
+			rank++;
+		}
+	}
+
+	free(work);
+	return rank;
+}
+
+/*===========================================================================
+ |                      Strongly Connected Components                        |
+  ===========================================================================*/
+
+/* Tarjan's algorithm (non-recursive) on the graph of A(:,Q), which has a
+ * zero free diagonal. On return P holds the nodes grouped by component and
+ * R the start of each component, so that A(P,Q(P)) is block upper
+ * triangular. Returns the number of blocks.
+ */
+int cktluStrongComponents(int n, int *Ap, int *Ai, int *Q, int *P, int *R)
+{
+	int *work, *index, *low, *stack, *call, *edge;
+	int s, v, w, p, end, head, top, count, numBlocks, k;
+
+	ReturnErrIf(Ap == NULL);
+	ReturnErrIf(Ai == NULL);
+	ReturnErrIf(Q == NULL);
+	ReturnErrIf(P == NULL);
+	ReturnErrIf(R == NULL);
+
+	work = malloc(5 * n * sizeof(int) + 1);
+	ReturnErrIf(work == NULL);
+	index = work;
+	low = work + n;
+	stack = work + 2*n;
+	call = work + 3*n;
+	edge = work + 4*n;
+
+	for(v = 0; v < n; v++) {
+		index[v] = -1;
+	}
+
+	/* low[v] is set to n once v has been assigned to a component, which
+	 * keeps it from changing the low link of any other node.
+	 */
+	count = 0;
+	top = 0;
+	numBlocks = 0;
+	k = 0;
+	for(s = 0; s < n; s++) {
+		if(index[s] >= 0) {
+			continue;
+		}
+		head = 0;
+		call[0] = s;
+		index[s] = low[s] = count++;
+		stack[top++] = s;
+		edge[s] = Ap[Q[s]];
+
+		while(head >= 0) {
+			v = call[head];
+			end = Ap[Q[v]+1];
+			for(p = edge[v]; p < end; p++) {
+				w = Ai[p];
+				if(index[w] < 0) {
+					break;
+				}
+				if(low[w] < n) {
+					low[v] = (index[w] < low[v]) ? index[w] : low[v];
+				}
+			}
+
+			if(p < end) {
+				/* Descend into w */
+				edge[v] = p + 1;
+				index[w] = low[w] = count++;
+				stack[top++] = w;
+				edge[w] = Ap[Q[w]];
+				call[++head] = w;
+				continue;
+			}
+
+			if(low[v] == index[v]) {
+				/* v is the root of a component */
+				R[numBlocks++] = k;
+				do {
+					w = stack[--top];
+					low[w] = n;
+					P[k++] = w;
+				} while(w != v);
+			}
+
+			head--;
+			if(head >= 0) {
+				w = call[head];
+				low[w] = (low[v] < low[w]) ? low[v] : low[w];
+			}
+		}
+	}
+	R[numBlocks] = n;
+
+	free(work);
+	return numBlocks;
+}
+
+/*===========================================================================*/
@@ -0,0 +1,1051 @@
+/*
+ * Copyright (C) 2006 Cooper Street Innovations Inc.
+ *	Charles Eidsness    <charles@cooper-street.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ */
+
+#include <math.h>
+#include <log.h>
+
+#ifdef CKTLU_THREADS
+#include <sched.h>
+#endif
+
+#include "cktlu_internal.h"
+
+int cktluInfo(void)
+{
+	Info("Circuit LU Library %i.%i", CKTLU_MAJOR_VERSION, CKTLU_MINOR_VERSION);
+	Info("Compiled " __DATE__ " at " __TIME__);
+	Info("(c) 2006 Cooper Street Innovations Inc.");
+	return ((CKTLU_MAJOR_VERSION << 16) + CKTLU_MINOR_VERSION);
+}
+
+/*===========================================================================
+ |                                Utilities                                  |
+  ===========================================================================*/
+
+/* Only one of value and valueSingle is in use, depending on r->single */
+static int cktluGrow(cktlu_ *r, int **index, double **value,
+		float **valueSingle, int *size, int needed)
+{
+	int *newIndex;
+	double *newValue;
+	float *newValueSingle;
+
+	if(needed <= *size) {
+		return 0;
+	}
+
+	*size = (2*(*size) > needed) ? 2*(*size) : needed;
+	newIndex = realloc(*index, (*size) * sizeof(int));
+	ReturnErrIf(newIndex == NULL);
+	*index = newIndex;
+	if(r->single) {
+		newValueSingle = realloc(*valueSingle, (*size) * sizeof(float));
+		ReturnErrIf(newValueSingle == NULL);
+		*valueSingle = newValueSingle;
+	} else {
+		newValue = realloc(*value, (*size) * sizeof(double));
+		ReturnErrIf(newValue == NULL);
+		*value = newValue;
+	}
+
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Depth first search of the graph of L from node j, the nodes are pushed
+ * onto xi[top-1], xi[top-2]... as they finish so xi[top..n-1] ends up in
+ * topological order. Rows are in the pre-pivot numbering, pinv maps them
+ * to the column of L they were pivotal in (or -1).
+ */
+static int cktluDepthFirst(cktlu_ *r, int j, int top, int *pinv, int stamp)
+{
+	int *Lp = r->Lp, *Li = r->Li, *xi = r->xi, *stack = r->stack;
+	int *pstack = r->pstack, *mark = r->mark;
+	int head = 0, i, k, p, end, done;
+
+	stack[0] = j;
+	while(head >= 0) {
+		i = stack[head];
+		k = pinv[i];
+		if(mark[i] != stamp) {
+			mark[i] = stamp;
+			pstack[head] = (k < 0) ? 0 : Lp[k];
+		}
+		done = 1;
+		end = (k < 0) ? 0 : Lp[k+1];
+		for(p = pstack[head]; p < end; p++) {
+			if(mark[Li[p]] != stamp) {
+				pstack[head] = p + 1;
+				stack[++head] = Li[p];
+				done = 0;
+				break;
+			}
+		}
+		if(done) {
+			head--;
+			xi[--top] = i;
+		}
+	}
+
+	return top;
+}
+
+/*===========================================================================
+ |                                 Factor                                    |
+  ===========================================================================*/
+
+/* Column j of the factors depends on the columns of L in the pattern of
+ * U(:,j), which only changes when cktluFactor picks new pivots. Columns in
+ * different blocks never depend on each other.
+ */
+static int cktluSchedule(cktlu_ *r)
+{
+	int n = r->n, b, j, p, k;
+	int *child;
+
+	child = realloc(r->child, (r->unz + 1) * sizeof(int));
+	ReturnErrIf(child == NULL);
+	r->child = child;
+
+	for(b = 0; b < r->numBlocks; b++) {
+		for(j = r->R[b]; j < r->R[b+1]; j++) {
+			r->blockStart[j] = r->R[b];
+		}
+	}
+
+	for(k = 0; k <= n; k++) {
+		r->childStart[k] = 0;
+	}
+	for(j = 0; j < n; j++) {
+		r->depCount[j] = r->Up[j+1] - r->Up[j];
+		for(p = r->Up[j]; p < r->Up[j+1]; p++) {
+			r->childStart[r->Ui[p] + 1]++;
+		}
+	}
+	for(k = 0; k < n; k++) {
+		r->childStart[k+1] += r->childStart[k];
+	}
+	for(k = 0; k < n; k++) {
+		r->pending[k] = r->childStart[k];
+	}
+	for(j = 0; j < n; j++) {
+		for(p = r->Up[j]; p < r->Up[j+1]; p++) {
+			r->child[r->pending[r->Ui[p]]++] = j;
+		}
+	}
+
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+int cktluFactor(cktlu_ *r, double *A, double tol)
+{
+	int *Ap, *Ai, *pinv, *rowInv, *xi;
+	double *x, pivot, max;
+	int n, b, k1, k2, j, p, i, k, top, ipiv, stamp, px, col;
+
+	ReturnErrIf(r == NULL);
+	ReturnErrIf(A == NULL);
+
+	n = r->n;
+	Ap = r->Ap;
+	Ai = r->Ai;
+	x = r->x;
+	xi = r->xi;
+	r->factored = 0;
+
+	/* pinv holds the pivot column of each row in the ordered (pre-pivot)
+	 * numbering, rowInv maps rows of A to that numbering.
+	 */
+	pinv = r->Pinv;
+	rowInv = r->stack + n;
+	for(k = 0; k < n; k++) {
+		rowInv[r->Ps[k]] = k;
+		pinv[k] = -1;
+		r->mark[k] = -1;
+	}
+
+	r->lnz = 0;
+	r->unz = 0;
+	r->fnz = 0;
+	stamp = 0;
+	for(b = 0; b < r->numBlocks; b++) {
+		k1 = r->R[b];
+		k2 = r->R[b+1];
+		for(j = k1; j < k2; j++) {
+			r->Lp[j] = r->lnz;
+			r->Up[j] = r->unz;
+			r->Fp[j] = r->fnz;
+			col = r->Q[j];
+
+			/* Symbolic, find the rows reachable from the column of A */
+			top = n;
+			for(p = Ap[col]; p < Ap[col+1]; p++) {
+				i = rowInv[Ai[p]];
+				if(i < k1) {
+					/* Off-diagonal block, earlier blocks are already pivoted */
+					r->Fi[r->fnz] = pinv[i];
+					r->Fx[r->fnz++] = A[p];
+				} else if(r->mark[i] != stamp) {
+					top = cktluDepthFirst(r, i, top, pinv, stamp);
+				}
+			}
+			stamp++;
+
+			ReturnErrIf(cktluGrow(r, &r->Li, &r->Lx, &r->Lf, &r->lmax,
+					r->lnz + n - top));
+			ReturnErrIf(cktluGrow(r, &r->Ui, &r->Ux, &r->Uf, &r->umax,
+					r->unz + n - top));
+
+			/* Numeric, sparse triangular solve */
+			for(p = Ap[col]; p < Ap[col+1]; p++) {
+				i = rowInv[Ai[p]];
+				if(i >= k1) {
+					x[i] = A[p];
+				}
+			}
+			for(px = top; px < n; px++) {
+				i = xi[px];
+				k = pinv[i];
+				if(k < 0) {
+					continue;
+				}
+				if(r->single) {
+					for(p = r->Lp[k]; p < r->Lp[k+1]; p++) {
+						x[r->Li[p]] -= r->Lf[p] * x[i];
+					}
+				} else {
+					for(p = r->Lp[k]; p < r->Lp[k+1]; p++) {
+						x[r->Li[p]] -= r->Lx[p] * x[i];
+					}
+				}
+			}
+
+			/* Threshold partial pivoting, prefer the diagonal */
+			ipiv = -1;
+			max = 0.0;
+			for(px = top; px < n; px++) {
+				i = xi[px];
+				if((pinv[i] < 0) && (fabs(x[i]) > max)) {
+					max = fabs(x[i]);
+					ipiv = i;
+				}
+			}
+			if((ipiv == -1) || (max == 0.0)) {
+				for(px = top; px < n; px++) {
+					x[xi[px]] = 0.0;
+				}
+				ReturnErr("Matrix is singular at column %i", j);
+			}
+			if((pinv[j] < 0) && (fabs(x[j]) >= tol*max)) {
+				ipiv = j;
+			}
+			pivot = x[ipiv];
+			pinv[ipiv] = j;
+			r->Udiag[j] = pivot;
+
+			/* Store U in topological order and L, and clear x */
+			for(px = top; px < n; px++) {
+				i = xi[px];
+				if(i != ipiv) {
+					k = pinv[i];
+					if(k >= 0) {
+						r->Ui[r->unz] = k;
+						CktluSetU(r, r->unz, x[i]);
+						r->unz++;
+					} else {
+						r->Li[r->lnz] = i;
+						CktluSetL(r, r->lnz, x[i] / pivot);
+						r->lnz++;
+					}
+				}
+				x[i] = 0.0;
+			}
+		}
+		r->Lp[k2] = r->lnz;
+
+		/* Every row in the block has been pivoted, so L can be moved to
+		 * the pivoted numbering.
+		 */
+		for(p = r->Lp[k1]; p < r->Lp[k2]; p++) {
+			r->Li[p] = pinv[r->Li[p]];
+		}
+	}
+	r->Up[n] = r->unz;
+	r->Fp[n] = r->fnz;
+
+	/* Combine the ordering and the pivoting into one row permutation */
+	for(k = 0; k < n; k++) {
+		r->P[pinv[k]] = r->Ps[k];
+	}
+	for(k = 0; k < n; k++) {
+		pinv[r->P[k]] = k;
+	}
+
+	if(r->pool != NULL) {
+		ReturnErrIf(cktluSchedule(r));
+	}
+
+	r->factored = 1;
+
+	return 0;
+}
+
+/*===========================================================================
+ |                                Refactor                                   |
+  ===========================================================================*/
+
+/* Refactor column j of the block starting at k1 using x as workspace,
+ * returns j + 1 if the old pivot is no longer good enough. x is left
+ * cleared either way.
+ */
+static int cktluRefactorColumn(cktlu_ *r, double *A, double tol, int j,
+		int k1, double *x)
+{
+	int *Ap = r->Ap, *Ai = r->Ai, *Pinv = r->Pinv, *Lp = r->Lp, *Li = r->Li;
+	int *Up = r->Up, *Ui = r->Ui;
+	double *Lx = r->Lx, ukj, pivot, max;
+	float *Lf = r->Lf;
+	int p, q, k, col, pf;
+
+	col = r->Q[j];
+
+	/* Scatter, off-diagonal entries are in the same order as they were
+	 * found by cktluFactor.
+	 */
+	pf = r->Fp[j];
+	for(p = Ap[col]; p < Ap[col+1]; p++) {
+		k = Pinv[Ai[p]];
+		if(k < k1) {
+			r->Fx[pf++] = A[p];
+		} else {
+			x[k] = A[p];
+		}
+	}
+
+	/* Left-looking update in the stored topological order */
+	for(p = Up[j]; p < Up[j+1]; p++) {
+		k = Ui[p];
+		ukj = x[k];
+		x[k] = 0.0;
+		CktluSetU(r, p, ukj);
+		if(ukj == 0.0) {
+			continue;
+		}
+		if(r->single) {
+			for(q = Lp[k]; q < Lp[k+1]; q++) {
+				x[Li[q]] -= Lf[q] * ukj;
+			}
+		} else {
+			for(q = Lp[k]; q < Lp[k+1]; q++) {
+				x[Li[q]] -= Lx[q] * ukj;
+			}
+		}
+	}
+
+	/* Check the old pivot is still good enough */
+	pivot = x[j];
+	max = fabs(pivot);
+	for(q = Lp[j]; q < Lp[j+1]; q++) {
+		max = (fabs(x[Li[q]]) > max) ? fabs(x[Li[q]]) : max;
+	}
+	if((pivot == 0.0) || !(fabs(pivot) >= tol*max)) {
+		x[j] = 0.0;
+		for(q = Lp[j]; q < Lp[j+1]; q++) {
+			x[Li[q]] = 0.0;
+		}
+		Debug("Refactor pivot %i failed (%e, %e)", j, pivot, max);
+		return j + 1;
+	}
+
+	r->Udiag[j] = pivot;
+	x[j] = 0.0;
+	for(q = Lp[j]; q < Lp[j+1]; q++) {
+		CktluSetL(r, q, x[Li[q]] / pivot);
+		x[Li[q]] = 0.0;
+	}
+
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+#ifdef CKTLU_THREADS
+
+/* Every thread takes the next column off the ready list, waits for it to
+ * be filled in if it has to, refactors it and then releases any columns
+ * that were only waiting on it. The list is lock free, slots are claimed
+ * with atomic adds and a thread spins until its slot has been filled.
+ */
+static int cktluRefactorTask(void *data, int thread)
+{
+	cktlu_ *r = data;
+	volatile int *ready = r->ready;
+	double *x;
+	int i, j, p, c, failed;
+
+	x = (thread == 0) ? r->x : (r->xThreads + (thread - 1)*r->n);
+
+	while(1) {
+		i = __sync_fetch_and_add(&r->readyHead, 1);
+		if(i >= r->n) {
+			break;
+		}
+		while((j = ready[i]) < 0) {
+			sched_yield();
+		}
+		__sync_synchronize();
+
+		/* Columns still have to be released after a failure or the
+		 * other threads would never finish.
+		 */
+		if(!(*(volatile int *)&r->failed)) {
+			failed = cktluRefactorColumn(r, r->refactorA, r->refactorTol, j,
+					r->blockStart[j], x);
+			if(failed) {
+				__sync_bool_compare_and_swap(&r->failed, 0, failed);
+			}
+		}
+
+		for(p = r->childStart[j]; p < r->childStart[j+1]; p++) {
+			c = r->child[p];
+			if(__sync_sub_and_fetch(&r->pending[c], 1) == 0) {
+				ready[__sync_fetch_and_add(&r->readyTail, 1)] = c;
+			}
+		}
+	}
+
+	return 0;
+}
+
+#endif
+
+/*---------------------------------------------------------------------------*/
+
+int cktluRefactor(cktlu_ *r, double *A, double tol)
+{
+	int b, j, failed;
+
+	ReturnErrIf(r == NULL);
+	ReturnErrIf(A == NULL);
+	ReturnErrIf(!r->factored);
+
+#ifdef CKTLU_THREADS
+	if(r->pool != NULL) {
+		r->refactorA = A;
+		r->refactorTol = tol;
+		r->failed = 0;
+		r->readyHead = 0;
+		r->readyTail = 0;
+		for(j = 0; j < r->n; j++) {
+			r->pending[j] = r->depCount[j];
+			r->ready[j] = -1;
+		}
+		for(j = 0; j < r->n; j++) {
+			if(r->depCount[j] == 0) {
+				r->ready[r->readyTail++] = j;
+			}
+		}
+		ReturnErrIf(cktluPoolRun(r->pool, cktluRefactorTask, r));
+		if(r->failed) {
+			r->factored = 0;
+			return r->failed;
+		}
+		return 0;
+	}
+#endif
+
+	for(b = 0; b < r->numBlocks; b++) {
+		for(j = r->R[b]; j < r->R[b+1]; j++) {
+			failed = cktluRefactorColumn(r, A, tol, j, r->R[b], r->x);
+			if(failed) {
+				r->factored = 0;
+				return failed;
+			}
+		}
+	}
+
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+int cktluSetSingle(cktlu_ *r, int single)
+{
+	ReturnErrIf(r == NULL);
+
+	single = (single != 0);
+	if(single == r->single) {
+		return 0;
+	}
+
+	Debug("Switching to %s precision factors", single ? "single" : "double");
+
+	/* The old factors are lost, cktluFactor has to be called again */
+	if(single) {
+		r->Lf = malloc(r->lmax * sizeof(float));
+		ReturnErrIf(r->Lf == NULL);
+		r->Uf = malloc(r->umax * sizeof(float));
+		ReturnErrIf(r->Uf == NULL);
+		free(r->Lx);
+		free(r->Ux);
+		r->Lx = NULL;
+		r->Ux = NULL;
+	} else {
+		r->Lx = malloc(r->lmax * sizeof(double));
+		ReturnErrIf(r->Lx == NULL);
+		r->Ux = malloc(r->umax * sizeof(double));
+		ReturnErrIf(r->Ux == NULL);
+		free(r->Lf);
+		free(r->Uf);
+		r->Lf = NULL;
+		r->Uf = NULL;
+	}
+	r->single = single;
+	r->factored = 0;
+
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+int cktluSetThreads(cktlu_ *r, int threads)
+{
+	ReturnErrIf(r == NULL);
+	ReturnErrIf(threads < 1);
+
+	if(r->pool != NULL) {
+		ReturnErrIf(cktluPoolDestroy(&r->pool));
+	}
+	r->threads = 1;
+	if(threads == 1) {
+		return 0;
+	}
+
+#ifdef CKTLU_THREADS
+	Debug("Using %i threads", threads);
+
+	if(r->xThreads != NULL)
+		free(r->xThreads);
+	r->xThreads = calloc((threads - 1)*r->n + 1, sizeof(double));
+	ReturnErrIf(r->xThreads == NULL);
+	if(r->blockStart == NULL) {
+		r->blockStart = malloc((r->n + 1) * sizeof(int));
+		ReturnErrIf(r->blockStart == NULL);
+		r->depCount = malloc((r->n + 1) * sizeof(int));
+		ReturnErrIf(r->depCount == NULL);
+		r->childStart = malloc((r->n + 1) * sizeof(int));
+		ReturnErrIf(r->childStart == NULL);
+		r->pending = malloc((r->n + 1) * sizeof(int));
+		ReturnErrIf(r->pending == NULL);
+		r->ready = malloc((r->n + 1) * sizeof(int));
+		ReturnErrIf(r->ready == NULL);
+	}
+
+	r->pool = cktluPoolNew(r->pool, threads);
+	ReturnErrIf(r->pool == NULL);
+	r->threads = threads;
+
+	if(r->factored) {
+		ReturnErrIf(cktluSchedule(r));
+	}
+#else
+	Warn("Built without thread support, using one thread");
+#endif
+
+	return 0;
+}
+
+/*===========================================================================
+ |                                  Solve                                    |
+  ===========================================================================*/
+
+int cktluSolve(cktlu_ *r, double *b)
+{
+	int *Lp, *Li, *Up, *Ui, *Fp, *Fi;
+	double *x, *Lx, *Ux, *Fx, xj;
+	float *Lf, *Uf;
+	int n, k, k1, k2, j, p;
+
+	ReturnErrIf(r == NULL);
+	ReturnErrIf(b == NULL);
+	ReturnErrIf(!r->factored);
+
+	n = r->n;
+	Lp = r->Lp;
+	Li = r->Li;
+	Lx = r->Lx;
+	Lf = r->Lf;
+	Up = r->Up;
+	Ui = r->Ui;
+	Ux = r->Ux;
+	Uf = r->Uf;
+	Fp = r->Fp;
+	Fi = r->Fi;
+	Fx = r->Fx;
+	x = r->x;
+
+	for(k = 0; k < n; k++) {
+		x[k] = b[r->P[k]];
+	}
+
+	/* Block back substitution, last block first */
+	for(k = r->numBlocks - 1; k >= 0; k--) {
+		k1 = r->R[k];
+		k2 = r->R[k+1];
+		if(r->single) {
+			for(j = k1; j < k2; j++) {
+				xj = x[j];
+				for(p = Lp[j]; p < Lp[j+1]; p++) {
+					x[Li[p]] -= Lf[p] * xj;
+				}
+			}
+			for(j = k2 - 1; j >= k1; j--) {
+				x[j] /= r->Udiag[j];
+				xj = x[j];
+				for(p = Up[j]; p < Up[j+1]; p++) {
+					x[Ui[p]] -= Uf[p] * xj;
+				}
+			}
+		} else {
+			for(j = k1; j < k2; j++) {
+				xj = x[j];
+				for(p = Lp[j]; p < Lp[j+1]; p++) {
+					x[Li[p]] -= Lx[p] * xj;
+				}
+			}
+			for(j = k2 - 1; j >= k1; j--) {
+				x[j] /= r->Udiag[j];
+				xj = x[j];
+				for(p = Up[j]; p < Up[j+1]; p++) {
+					x[Ui[p]] -= Ux[p] * xj;
+				}
+			}
+		}
+		for(j = k1; j < k2; j++) {
+			xj = x[j];
+			for(p = Fp[j]; p < Fp[j+1]; p++) {
+				x[Fi[p]] -= Fx[p] * xj;
+			}
+		}
+	}
+
+	for(k = 0; k < n; k++) {
+		b[r->Q[k]] = x[k];
+	}
+	for(k = 0; k < n; k++) {
+		x[k] = 0.0;
+	}
+
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+int cktluGetInfo(cktlu_ *r, int *numBlocks, int *maxBlock, int *lnz,
+		int *unz)
+{
+	ReturnErrIf(r == NULL);
+	if(numBlocks != NULL)
+		*numBlocks = r->numBlocks;
+	if(maxBlock != NULL)
+		*maxBlock = r->maxBlock;
+	if(lnz != NULL)
+		*lnz = r->lnz;
+	if(unz != NULL)
+		*unz = r->unz + r->n;
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+int cktluGetOrder(cktlu_ *r, int *Ps, int *Q, int *R)
+{
+	ReturnErrIf(r == NULL);
+	ReturnErrIf(Ps == NULL);
+	ReturnErrIf(Q == NULL);
+	ReturnErrIf(R == NULL);
+
+	memcpy(Ps, r->Ps, r->n * sizeof(int));
+	memcpy(Q, r->Q, r->n * sizeof(int));
+	memcpy(R, r->R, (r->numBlocks + 1) * sizeof(int));
+
+	return r->numBlocks;
+}
+
+/*===========================================================================
+ |                             Block Structure                               |
+  ===========================================================================*/
+
+int cktluBlocks(int n, int *colStart, int *row, int *R)
+{
+	int *match = NULL, *P = NULL, rank, numBlocks;
+
+	ReturnErrIf(n < 0);
+	ReturnErrIf(colStart == NULL);
+	ReturnErrIf(row == NULL);
+	ReturnErrIf(R == NULL);
+
+	match = malloc((n + 1) * sizeof(int));
+	GotoFailedIf(match == NULL);
+	P = malloc((n + 1) * sizeof(int));
+	GotoFailedIf(P == NULL);
+
+	rank = cktluMaxTransversal(n, colStart, row, match);
+	GotoFailedIf(rank < 0);
+	if(rank < n) {
+		numBlocks = 0;
+	} else {
+		numBlocks = cktluStrongComponents(n, colStart, row, match, P, R);
+		GotoFailedIf(numBlocks < 0);
+	}
+
+	free(P);
+	free(match);
+	return numBlocks;
+
+failed:
+	if(match != NULL)
+		free(match);
+	if(P != NULL)
+		free(P);
+	return -1;
+}
+
+/*===========================================================================
+ |                                 Analyze                                   |
+  ===========================================================================*/
+
+/* Block triangular form followed by AMD on each block, sets Ps, Q and R */
+static int cktluAnalyze(cktlu_ *r)
+{
+	int *match = NULL, *block = NULL, *Sp = NULL, *Si = NULL, *order = NULL;
+	int *local = NULL;
+	int n, b, k1, k2, size, rank, i, j, k, p;
+
+	n = r->n;
+
+	match = malloc((n + 1) * sizeof(int));
+	GotoFailedIf(match == NULL);
+	block = malloc((n + 1) * sizeof(int));
+	GotoFailedIf(block == NULL);
+	local = malloc((n + 1) * sizeof(int));
+	GotoFailedIf(local == NULL);
+	order = malloc((n + 1) * sizeof(int));
+	GotoFailedIf(order == NULL);
+	Sp = malloc((n + 1) * sizeof(int));
+	GotoFailedIf(Sp == NULL);
+	Si = malloc((2 * r->Ap[n] + 1) * sizeof(int));
+	GotoFailedIf(Si == NULL);
+
+	/* Zero free diagonal */
+	rank = cktluMaxTransversal(n, r->Ap, r->Ai, match);
+	GotoFailedIf(rank < 0);
+	GotoFailedIf(rank < n, "Matrix is structurally singular (rank %i of %i)",
+			rank, n);
+
+	/* Block upper triangular form */
+	r->numBlocks = cktluStrongComponents(n, r->Ap, r->Ai, match, r->Ps, r->R);
+	GotoFailedIf(r->numBlocks < 0);
+
+	r->maxBlock = 0;
+	for(b = 0; b < r->numBlocks; b++) {
+		for(k = r->R[b]; k < r->R[b+1]; k++) {
+			block[r->Ps[k]] = b;
+			local[r->Ps[k]] = k - r->R[b];
+		}
+	}
+
+	/* Order each block with AMD on B+B' */
+	for(b = 0; b < r->numBlocks; b++) {
+		k1 = r->R[b];
+		k2 = r->R[b+1];
+		size = k2 - k1;
+		r->maxBlock = (size > r->maxBlock) ? size : r->maxBlock;
+		if(size < 3) {
+			continue;
+		}
+
+		for(k = 0; k <= size; k++) {
+			Sp[k] = 0;
+		}
+		for(k = k1; k < k2; k++) {
+			j = match[r->Ps[k]];
+			for(p = r->Ap[j]; p < r->Ap[j+1]; p++) {
+				i = r->Ai[p];
+				if((block[i] == b) && (i != r->Ps[k])) {
+					Sp[local[i]+1]++;
+					Sp[k-k1+1]++;
+				}
+			}
+		}
+		for(k = 0; k < size; k++) {
+			Sp[k+1] += Sp[k];
+		}
+		for(k = 0; k < size; k++) {
+			order[k] = Sp[k];
+		}
+		for(k = k1; k < k2; k++) {
+			j = match[r->Ps[k]];
+			for(p = r->Ap[j]; p < r->Ap[j+1]; p++) {
+				i = r->Ai[p];
+				if((block[i] == b) && (i != r->Ps[k])) {
+					Si[order[local[i]]++] = k - k1;
+					Si[order[k-k1]++] = local[i];
+				}
+			}
+		}
+
+		GotoFailedIf(cktluAMD(size, Sp, Si, order));
+		for(k = 0; k < size; k++) {
+			Sp[k] = r->Ps[k1 + order[k]];
+		}
+		for(k = 0; k < size; k++) {
+			r->Ps[k1 + k] = Sp[k];
+		}
+	}
+
+	for(k = 0; k < n; k++) {
+		r->Q[k] = match[r->Ps[k]];
+	}
+
+	Debug("BTF %i blocks, largest %i, %i x %i with %i non-zeros",
+			r->numBlocks, r->maxBlock, n, n, r->Ap[n]);
+
+	free(match);
+	free(block);
+	free(local);
+	free(order);
+	free(Sp);
+	free(Si);
+	return 0;
+
+failed:
+	if(match != NULL)
+		free(match);
+	if(block != NULL)
+		free(block);
+	if(local != NULL)
+		free(local);
+	if(order != NULL)
+		free(order);
+	if(Sp != NULL)
+		free(Sp);
+	if(Si != NULL)
+		free(Si);
+	return -1;
+}
+
+/*===========================================================================
+ |                          Constructor / Destructor                         |
+  ===========================================================================*/
+
+int cktluDestroy(cktlu_ **r)
+{
+	ReturnErrIf(r == NULL);
+	ReturnErrIf(*r == NULL);
+
+	Debug("Destroying Circuit LU %p", *r);
+
+	if((*r)->pool != NULL) {
+		if(cktluPoolDestroy(&(*r)->pool)) {
+			Warn("Error destroying thread pool");
+		}
+	}
+
+	if((*r)->Ps != NULL)
+		free((*r)->Ps);
+	if((*r)->P != NULL)
+		free((*r)->P);
+	if((*r)->Pinv != NULL)
+		free((*r)->Pinv);
+	if((*r)->Q != NULL)
+		free((*r)->Q);
+	if((*r)->R != NULL)
+		free((*r)->R);
+	if((*r)->Lp != NULL)
+		free((*r)->Lp);
+	if((*r)->Li != NULL)
+		free((*r)->Li);
+	if((*r)->Lx != NULL)
+		free((*r)->Lx);
+	if((*r)->Up != NULL)
+		free((*r)->Up);
+	if((*r)->Ui != NULL)
+		free((*r)->Ui);
+	if((*r)->Ux != NULL)
+		free((*r)->Ux);
+	if((*r)->Lf != NULL)
+		free((*r)->Lf);
+	if((*r)->Uf != NULL)
+		free((*r)->Uf);
+	if((*r)->Udiag != NULL)
+		free((*r)->Udiag);
+	if((*r)->Fp != NULL)
+		free((*r)->Fp);
+	if((*r)->Fi != NULL)
+		free((*r)->Fi);
+	if((*r)->Fx != NULL)
+		free((*r)->Fx);
+	if((*r)->x != NULL)
+		free((*r)->x);
+	if((*r)->xi != NULL)
+		free((*r)->xi);
+	if((*r)->stack != NULL)
+		free((*r)->stack);
+	if((*r)->pstack != NULL)
+		free((*r)->pstack);
+	if((*r)->mark != NULL)
+		free((*r)->mark);
+	if((*r)->xThreads != NULL)
+		free((*r)->xThreads);
+	if((*r)->blockStart != NULL)
+		free((*r)->blockStart);
+	if((*r)->depCount != NULL)
+		free((*r)->depCount);
+	if((*r)->childStart != NULL)
+		free((*r)->childStart);
+	if((*r)->child != NULL)
+		free((*r)->child);
+	if((*r)->pending != NULL)
+		free((*r)->pending);
+	if((*r)->ready != NULL)
+		free((*r)->ready);
+
+	free(*r);
+	*r = NULL;
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Everything but the ordering, see cktluNew and cktluNewOrdered */
+static cktlu_ * cktluCreate(cktlu_ *r, int n, int *colStart, int *row)
+{
+	int nz;
+
+	ReturnNULLIf(r != NULL);
+	ReturnNULLIf(n < 0);
+	ReturnNULLIf(colStart == NULL);
+	ReturnNULLIf(row == NULL);
+
+	r = calloc(1, sizeof(cktlu_));
+	ReturnNULLIf(r == NULL);
+
+	Debug("Creating Circuit LU %p", r);
+
+	r->n = n;
+	r->threads = 1;
+	r->Ap = colStart;
+	r->Ai = row;
+	nz = colStart[n];
+
+	r->Ps = malloc((n + 1) * sizeof(int));
+	GotoFailedIf(r->Ps == NULL);
+	r->P = malloc((n + 1) * sizeof(int));
+	GotoFailedIf(r->P == NULL);
+	r->Pinv = malloc((n + 1) * sizeof(int));
+	GotoFailedIf(r->Pinv == NULL);
+	r->Q = malloc((n + 1) * sizeof(int));
+	GotoFailedIf(r->Q == NULL);
+	r->R = malloc((n + 1) * sizeof(int));
+	GotoFailedIf(r->R == NULL);
+	r->Lp = malloc((n + 1) * sizeof(int));
+	GotoFailedIf(r->Lp == NULL);
+	r->Up = malloc((n + 1) * sizeof(int));
+	GotoFailedIf(r->Up == NULL);
+	r->Fp = malloc((n + 1) * sizeof(int));
+	GotoFailedIf(r->Fp == NULL);
+	r->Udiag = malloc((n + 1) * sizeof(double));
+	GotoFailedIf(r->Udiag == NULL);
+	r->Fi = malloc((nz + 1) * sizeof(int));
+	GotoFailedIf(r->Fi == NULL);
+	r->Fx = malloc((nz + 1) * sizeof(double));
+	GotoFailedIf(r->Fx == NULL);
+	r->x = calloc(n + 1, sizeof(double));
+	GotoFailedIf(r->x == NULL);
+	r->xi = malloc((n + 1) * sizeof(int));
+	GotoFailedIf(r->xi == NULL);
+	r->stack = malloc((2*n + 1) * sizeof(int));
+	GotoFailedIf(r->stack == NULL);
+	r->pstack = malloc((n + 1) * sizeof(int));
+	GotoFailedIf(r->pstack == NULL);
+	r->mark = malloc((n + 1) * sizeof(int));
+	GotoFailedIf(r->mark == NULL);
+
+	/* First guess at the size of the factors, they grow as needed */
+	GotoFailedIf(cktluGrow(r, &r->Li, &r->Lx, &r->Lf, &r->lmax, nz + n + 1));
+	GotoFailedIf(cktluGrow(r, &r->Ui, &r->Ux, &r->Uf, &r->umax, nz + n + 1));
+
+	return r;
+
+failed:
+	cktluDestroy(&r);
+	return NULL;
+}
+
+/*---------------------------------------------------------------------------*/
+
+cktlu_ * cktluNewOrdered(cktlu_ *r, int n, int *colStart, int *row,
+		int numBlocks, int *Ps, int *Q, int *R)
+{
+	int b;
+
+	ReturnNULLIf(numBlocks < 1);
+	ReturnNULLIf(Ps == NULL);
+	ReturnNULLIf(Q == NULL);
+	ReturnNULLIf(R == NULL);
+
+	r = cktluCreate(r, n, colStart, row);
+	ReturnNULLIf(r == NULL);
+
+	memcpy(r->Ps, Ps, n * sizeof(int));
+	memcpy(r->Q, Q, n * sizeof(int));
+	memcpy(r->R, R, (numBlocks + 1) * sizeof(int));
+	r->numBlocks = numBlocks;
+	r->maxBlock = 0;
+	for(b = 0; b < numBlocks; b++) {
+		if((R[b+1] - R[b]) > r->maxBlock) {
+			r->maxBlock = R[b+1] - R[b];
+		}
+	}
+
+	return r;
+}
+
+/*---------------------------------------------------------------------------*/
+
+cktlu_ * cktluNew(cktlu_ *r, int n, int *colStart, int *row)
+{
+	r = cktluCreate(r, n, colStart, row);
+	ReturnNULLIf(r == NULL);
+
+	if(cktluAnalyze(r)) {
+		cktluDestroy(&r);
+		ReturnNULL("Failed to analyze the pattern of A");
+	}
+
+	return r;
+}
+
+/*===========================================================================*/
@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2006 Cooper Street Innovations Inc.
+ *	Charles Eidsness    <charles@cooper-street.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ */
+
+#ifndef CKTLU_H
+#define CKTLU_H
+
+#define CKTLU_MAJOR_VERSION		1
+#define CKTLU_MINOR_VERSION		0
+
+/*
+ * Sparse LU factorization for circuit matrices.
+ *
+ * The matrix is first permuted to block upper triangular form (a maximum
+ * transversal followed by Tarjan's strongly connected components), each
+ * diagonal block is ordered with an approximate minimum degree ordering
+ * of B+B' and then factored with a left-looking Gilbert-Peierls algorithm
+ * using threshold partial pivoting. The off-diagonal blocks are never
+ * factored, only used during the solve.
+ *
+ * The pattern of A is passed to cktluNew as a compressed column matrix and
+ * must not change for the life of the object, the values are passed to
+ * each factor call.
+ */
+
+typedef struct _cktlu cktlu_;
+
+int cktluInfo(void);
+
+/* Full factorization, pivots are chosen with a threshold of tol relative
+ * to the largest entry in the column, diagonal entries are preferred.
+ */
+int cktluFactor(cktlu_ *r, double *A, double tol);
+
+/* Numeric only factorization reusing the pivot order and pattern of the
+ * last cktluFactor call. Returns a positive value if a pivot fails the
+ * tol test, in which case cktluFactor has to be called.
+ */
+int cktluRefactor(cktlu_ *r, double *A, double tol);
+
+/* Keep L and U in single precision, which halves their size and the
+ * memory traffic in the factor and solve. The arithmetic is still done in
+ * double but the solution is only as good as float, so the caller has to
+ * refine it. Changing precision throws away the factors.
+ */
+int cktluSetSingle(cktlu_ *r, int single);
+
+/* Use more than one thread in cktluRefactor, independent columns are
+ * refactored concurrently. Set to 1 (the default) to stay sequential.
+ */
+int cktluSetThreads(cktlu_ *r, int threads);
+
+/* Solve A*x = b, b is overwritten with x */
+int cktluSolve(cktlu_ *r, double *b);
+
+int cktluGetInfo(cktlu_ *r, int *numBlocks, int *maxBlock, int *lnz,
+		int *unz);
+
+/* Block upper triangular form of a pattern without building a cktlu_
+ * object, block k is R[k] to R[k+1]-1 (R needs n+1 entries). Returns the
+ * number of blocks, 0 if the pattern is structurally singular.
+ */
+int cktluBlocks(int n, int *colStart, int *row, int *R);
+
+/* Ordering found by the analysis, Ps and Q need n entries and R n+1.
+ * Returns the number of blocks. Another object for the same pattern can
+ * be built from it with cktluNewOrdered, which skips the analysis.
+ */
+int cktluGetOrder(cktlu_ *r, int *Ps, int *Q, int *R);
+
+int cktluDestroy(cktlu_ **r);
+cktlu_ * cktluNewOrdered(cktlu_ *r, int n, int *colStart, int *row,
+		int numBlocks, int *Ps, int *Q, int *R);
+cktlu_ * cktluNew(cktlu_ *r, int n, int *colStart, int *row);
+
+#endif
@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2006 Cooper Street Innovations Inc.
+ *	Charles Eidsness    <charles@cooper-street.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ */
+
+#ifndef CKTLU_INTERNAL_H
+#define CKTLU_INTERNAL_H
+
+#include "cktlu.h"
+
+/* Store value v in L or U, as a float if the factors are single precision */
+#define CktluSetL(r, p, v) \
+	do { \
+		if((r)->single) (r)->Lf[p] = (float)(v); else (r)->Lx[p] = (v); \
+	} while(0)
+
+#define CktluSetU(r, p, v) \
+	do { \
+		if((r)->single) (r)->Uf[p] = (float)(v); else (r)->Ux[p] = (v); \
+	} while(0)
+
+typedef struct _cktluPool cktluPool_;
+typedef int (*cktluPoolTask_)(void *data, int thread);
+
+struct _cktlu {
+	int n;
+	int *Ap;		/* Pattern of A (not owned) */
+	int *Ai;
+	/* Ordering */
+	int *Ps;		/* Row order from the analysis, before pivoting */
+	int *P;			/* Row k of the factors is row P[k] of A */
+	int *Pinv;
+	int *Q;			/* Column k of the factors is column Q[k] of A */
+	int *R;			/* Block k is columns R[k] to R[k+1]-1 */
+	int numBlocks;
+	int maxBlock;
+	/* Factors, L is unit lower triangular and stored without its diagonal,
+	 * U is stored in the topological order used by the refactorization.
+	 */
+	int *Lp;
+	int *Li;
+	double *Lx;
+	float *Lf;		/* Lx when the factors are kept in single precision */
+	int lnz;
+	int lmax;
+	int *Up;
+	int *Ui;
+	double *Ux;
+	float *Uf;
+	int unz;
+	int umax;
+	double *Udiag;
+	int single;
+	/* Off-diagonal blocks */
+	int *Fp;
+	int *Fi;
+	double *Fx;
+	int fnz;
+	/* Workspace */
+	double *x;
+	int *xi;
+	int *stack;
+	int *pstack;
+	int *mark;
+	int factored;
+	/* Parallel Refactorization, column j can be refactored once every
+	 * column in the pattern of U(:,j) is done, see cktluSchedule.
+	 */
+	int threads;
+	cktluPool_ *pool;
+	double *xThreads;	/* x for threads 1 and up */
+	int *blockStart;	/* First column of the block column j is in */
+	int *depCount;		/* Number of columns column j waits for */
+	int *childStart;	/* Columns waiting on column k */
+	int *child;
+	int *pending;
+	int *ready;			/* Columns in the order they became ready */
+	int readyHead;
+	int readyTail;
+	int failed;
+	double *refactorA;
+	double refactorTol;
+};
+
+/* btf.c */
+int cktluMaxTransversal(int n, int *Ap, int *Ai, int *match);
+int cktluStrongComponents(int n, int *Ap, int *Ai, int *Q, int *P, int *R);
+
+/* amd.c */
+int cktluAMD(int n, int *Sp, int *Si, int *order);
+
+/* pool.c */
+int cktluPoolRun(cktluPool_ *r, cktluPoolTask_ task, void *data);
+int cktluPoolDestroy(cktluPool_ **r);
+cktluPool_ * cktluPoolNew(cktluPool_ *r, int threads);
+
+#endif
@@ -0,0 +1,212 @@
+/*
+ * Copyright (C) 2006 Cooper Street Innovations Inc.
+ *	Charles Eidsness    <charles@cooper-street.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ */
+
+#include <log.h>
+
+#include "cktlu_internal.h"
+
+#ifdef CKTLU_THREADS
+
+#include <pthread.h>
+
+/* A fixed set of worker threads that all run the same task, the caller is
+ * thread 0 and takes part in the work. Anything finer grained than that,
+ * handing out columns for example, is left to the task.
+ */
+
+typedef struct {
+	cktluPool_ *pool;
+	int index;
+} cktluPoolThread_;
+
+struct _cktluPool {
+	int threads;
+	pthread_t *thread;
+	cktluPoolThread_ *info;
+	pthread_mutex_t lock;
+	pthread_cond_t start;
+	pthread_cond_t done;
+	cktluPoolTask_ task;
+	void *data;
+	int generation;	/* Incremented every time a task is started */
+	int running;	/* Workers that haven't finished the task yet */
+	int quit;
+};
+
+/*===========================================================================
+ |                                 Workers                                   |
+  ===========================================================================*/
+
+static void * cktluPoolWorker(void *arg)
+{
+	cktluPoolThread_ *info = arg;
+	cktluPool_ *r = info->pool;
+	int generation = 0;
+
+	while(1) {
+		pthread_mutex_lock(&r->lock);
+		while((r->generation == generation) && !r->quit) {
+			pthread_cond_wait(&r->start, &r->lock);
+		}
+		if(r->quit) {
+			pthread_mutex_unlock(&r->lock);
+			break;
+		}
+		generation = r->generation;
+		pthread_mutex_unlock(&r->lock);
+
+		r->task(r->data, info->index);
+
+		pthread_mutex_lock(&r->lock);
+		if(--r->running == 0) {
+			pthread_cond_signal(&r->done);
+		}
+		pthread_mutex_unlock(&r->lock);
+	}
+
+	return NULL;
+}
+
+/*---------------------------------------------------------------------------*/
+
+int cktluPoolRun(cktluPool_ *r, cktluPoolTask_ task, void *data)
+{
+	int error;
+
+	ReturnErrIf(r == NULL);
+	ReturnErrIf(task == NULL);
+
+	pthread_mutex_lock(&r->lock);
+	r->task = task;
+	r->data = data;
+	r->running = r->threads - 1;
+	r->generation++;
+	pthread_cond_broadcast(&r->start);
+	pthread_mutex_unlock(&r->lock);
+
+	error = task(data, 0);
+
+	pthread_mutex_lock(&r->lock);
+	while(r->running > 0) {
+		pthread_cond_wait(&r->done, &r->lock);
+	}
+	pthread_mutex_unlock(&r->lock);
+
+	return error;
+}
+
+/*===========================================================================
+ |                          Constructor / Destructor                         |
+  ===========================================================================*/
+
+int cktluPoolDestroy(cktluPool_ **r)
+{
+	int i;
+
+	ReturnErrIf(r == NULL);
+	ReturnErrIf(*r == NULL);
+
+	Debug("Destroying Thread Pool %p", *r);
+
+	if((*r)->thread != NULL) {
+		pthread_mutex_lock(&(*r)->lock);
+		(*r)->quit = 1;
+		pthread_cond_broadcast(&(*r)->start);
+		pthread_mutex_unlock(&(*r)->lock);
+		for(i = 1; i < (*r)->threads; i++) {
+			pthread_join((*r)->thread[i], NULL);
+		}
+		free((*r)->thread);
+	}
+	if((*r)->info != NULL)
+		free((*r)->info);
+
+	pthread_mutex_destroy(&(*r)->lock);
+	pthread_cond_destroy(&(*r)->start);
+	pthread_cond_destroy(&(*r)->done);
+
+	free(*r);
+	*r = NULL;
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+cktluPool_ * cktluPoolNew(cktluPool_ *r, int threads)
+{
+	int i;
+
+	ReturnNULLIf(r != NULL);
+	ReturnNULLIf(threads < 2);
+
+	r = calloc(1, sizeof(cktluPool_));
+	ReturnNULLIf(r == NULL);
+
+	Debug("Creating Thread Pool %p (%i threads)", r, threads);
+
+	pthread_mutex_init(&r->lock, NULL);
+	pthread_cond_init(&r->start, NULL);
+	pthread_cond_init(&r->done, NULL);
+
+	r->info = calloc(threads, sizeof(cktluPoolThread_));
+	GotoFailedIf(r->info == NULL);
+	r->thread = calloc(threads, sizeof(pthread_t));
+	GotoFailedIf(r->thread == NULL);
+
+	/* Thread 0 is the caller */
+	r->threads = 1;
+	for(i = 1; i < threads; i++) {
+		r->info[i].pool = r;
+		r->info[i].index = i;
+		GotoFailedIf(pthread_create(&r->thread[i], NULL, cktluPoolWorker,
+				&r->info[i]));
+		r->threads++;
+	}
+
+	return r;
+
+failed:
+	cktluPoolDestroy(&r);
+	return NULL;
+}
+
+#else
+
+/* Built without thread support, cktluSetThreads stays at one thread */
+
+int cktluPoolRun(cktluPool_ *r, cktluPoolTask_ task, void *data)
+{
+	ReturnErr("Built without thread support");
+}
+
+int cktluPoolDestroy(cktluPool_ **r)
+{
+	ReturnErr("Built without thread support");
+}
+
+cktluPool_ * cktluPoolNew(cktluPool_ *r, int threads)
+{
+	ReturnNULL("Built without thread support");
+}
+
+#endif
+
+/*===========================================================================*/
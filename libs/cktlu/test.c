@@ -0,0 +1,377 @@
+/*
+ * Copyright (C) 2006 Cooper Street Innovations Inc.
+ *	Charles Eidsness    <charles@cooper-street.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ */
+#include <unistd.h>
+#define _GNU_SOURCE
+#include <getopt.h>
+#include <math.h>
+#include <sys/time.h>
+
+#include <log.h>
+LogMaster;
+#include "cktlu.h"
+
+/* A resistor ladder with a voltage source at one end and a current
+ * controlled coupling at the other, in the same Modified Nodal Analysis
+ * form the simulator builds, stored as a compressed column matrix.
+ */
+typedef struct {
+	int n;
+	int nz;
+	int *colStart;
+	int *row;
+	double *value;
+} matrix_;
+
+static int matrixAdd(double *dense, int n, int row, int col, double value)
+{
+	dense[col*n + row] += value;
+	return 0;
+}
+
+static int matrixCompress(matrix_ *r, double *dense, int *pattern)
+{
+	int i, j;
+
+	r->nz = 0;
+	for(j = 0; j < r->n; j++) {
+		r->colStart[j] = r->nz;
+		for(i = 0; i < r->n; i++) {
+			if(pattern[j*r->n + i]) {
+				r->row[r->nz] = i;
+				r->value[r->nz++] = dense[j*r->n + i];
+			}
+		}
+	}
+	r->colStart[r->n] = r->nz;
+	return 0;
+}
+
+static double matrixResidual(matrix_ *r, double *x, double *b)
+{
+	double *Ax, max = 0.0;
+	int i, p;
+
+	Ax = calloc(r->n, sizeof(double));
+	ExitFailureIf(Ax == NULL);
+	for(i = 0; i < r->n; i++) {
+		for(p = r->colStart[i]; p < r->colStart[i+1]; p++) {
+			Ax[r->row[p]] += r->value[p] * x[i];
+		}
+	}
+	for(i = 0; i < r->n; i++) {
+		max = (fabs(Ax[i] - b[i]) > max) ? fabs(Ax[i] - b[i]) : max;
+	}
+	free(Ax);
+	return max;
+}
+
+/* One step of iterative refinement, x = x + inv(LU)*(b - A*x) */
+static int matrixRefine(matrix_ *r, cktlu_ *lu, double *x, double *b)
+{
+	double *d;
+	int i, p;
+
+	d = calloc(r->n, sizeof(double));
+	ExitFailureIf(d == NULL);
+	for(i = 0; i < r->n; i++) {
+		d[i] = b[i];
+	}
+	for(i = 0; i < r->n; i++) {
+		for(p = r->colStart[i]; p < r->colStart[i+1]; p++) {
+			d[r->row[p]] -= r->value[p] * x[i];
+		}
+	}
+	ExitFailureIf(cktluSolve(lu, d));
+	for(i = 0; i < r->n; i++) {
+		x[i] += d[i];
+	}
+	free(d);
+	return 0;
+}
+
+static int ladder(matrix_ *r, double *dense, int *pattern, int sections,
+		double g)
+{
+	int n = r->n, k, vs = sections + 1, i;
+
+	memset(dense, 0x0, n*n*sizeof(double));
+	for(k = 0; k < sections; k++) {
+		/* Series conductance between k and k+1, shunt from k+1 to gnd */
+		matrixAdd(dense, n, k, k, g);
+		matrixAdd(dense, n, k, k+1, -g);
+		matrixAdd(dense, n, k+1, k, -g);
+		matrixAdd(dense, n, k+1, k+1, g + g*(k+1)/sections);
+	}
+	/* Voltage source at node 0, it has a zero on the diagonal */
+	matrixAdd(dense, n, 0, vs, 1.0);
+	matrixAdd(dense, n, vs, 0, 1.0);
+	/* One way coupling from the last node back to the middle */
+	matrixAdd(dense, n, sections/2, sections, 0.1*g);
+	for(i = 0; i < n*n; i++) {
+		pattern[i] = pattern[i] || (dense[i] != 0.0);
+	}
+	return 0;
+}
+
+/* A size x size resistor grid with a shunt to ground at every node, built
+ * straight into compressed columns since it is too big to go through a
+ * dense matrix. Each column has its neighbours above, left, itself, right
+ * and below, in row order.
+ */
+static int grid(matrix_ *r, int size, double g)
+{
+	int i, j, k;
+
+	r->n = size*size;
+	r->nz = 0;
+	for(k = 0; k < r->n; k++) {
+		i = k / size;
+		j = k % size;
+		r->colStart[k] = r->nz;
+		if(i > 0) {
+			r->row[r->nz] = k - size;
+			r->value[r->nz++] = -g;
+		}
+		if(j > 0) {
+			r->row[r->nz] = k - 1;
+			r->value[r->nz++] = -g;
+		}
+		r->row[r->nz] = k;
+		r->value[r->nz++] = g*((i > 0) + (j > 0) + (j < size - 1) +
+				(i < size - 1)) + 0.01*g*(1 + (k % 7));
+		if(j < size - 1) {
+			r->row[r->nz] = k + 1;
+			r->value[r->nz++] = -g;
+		}
+		if(i < size - 1) {
+			r->row[r->nz] = k + size;
+			r->value[r->nz++] = -g;
+		}
+	}
+	r->colStart[r->n] = r->nz;
+	return 0;
+}
+
+static double seconds(void)
+{
+	struct timeval t;
+	gettimeofday(&t, NULL);
+	return t.tv_sec + 1e-6*t.tv_usec;
+}
+
+/* Times cktluRefactor on a size x size grid for 1, 2 and 4 threads */
+static int bench(int size)
+{
+	int threads[] = {1, 2, 4}, repeat = 20, t, k, i;
+	double *x, *b, start, elapsed, base = 0.0, residual;
+	matrix_ matrix;
+	cktlu_ *lu = NULL;
+
+	matrix.colStart = calloc(size*size + 1, sizeof(int));
+	ExitFailureIf(matrix.colStart == NULL);
+	matrix.row = calloc(5*size*size, sizeof(int));
+	ExitFailureIf(matrix.row == NULL);
+	matrix.value = calloc(5*size*size, sizeof(double));
+	ExitFailureIf(matrix.value == NULL);
+	x = calloc(size*size, sizeof(double));
+	ExitFailureIf(x == NULL);
+	b = calloc(size*size, sizeof(double));
+	ExitFailureIf(b == NULL);
+
+	ExitFailureIf(grid(&matrix, size, 1.0));
+	lu = cktluNew(lu, matrix.n, matrix.colStart, matrix.row);
+	ExitFailureIf(lu == NULL);
+	ExitFailureIf(cktluFactor(lu, matrix.value, 1e-3));
+	ExitFailureIf(grid(&matrix, size, 2.5));
+	for(i = 0; i < matrix.n; i++) {
+		b[i] = 1e-3*(i % 13);
+	}
+
+	for(t = 0; t < sizeof(threads)/sizeof(int); t++) {
+		ExitFailureIf(cktluSetThreads(lu, threads[t]));
+		start = seconds();
+		for(k = 0; k < repeat; k++) {
+			ExitFailureIf(cktluRefactor(lu, matrix.value, 1e-3));
+		}
+		elapsed = (seconds() - start) / repeat;
+		base = (t == 0) ? elapsed : base;
+		for(i = 0; i < matrix.n; i++) {
+			x[i] = b[i];
+		}
+		ExitFailureIf(cktluSolve(lu, x));
+		residual = matrixResidual(&matrix, x, b);
+		Info("%ix%i grid, %i threads: %.3f ms per refactor, speedup %.2f, "
+				"residual %e", size, size, threads[t], 1e3*elapsed,
+				base / elapsed, residual);
+		ExitFailureIf(residual > 1e-10);
+	}
+
+	ExitFailureIf(cktluDestroy(&lu));
+	free(matrix.colStart);
+	free(matrix.row);
+	free(matrix.value);
+	free(x);
+	free(b);
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	int opt;
+	struct option longopts[] = {
+			{"version", 0, NULL, 'v'},
+			{"error", 1, NULL, 'e'},
+			{"log", 1, NULL, 'l'},
+			{"bench", 1, NULL, 'b'},
+			{0, 0, 0, 0}
+    };
+	cktlu_ *lu = NULL, *ordered = NULL;
+	matrix_ matrix;
+	double *dense, *x, *b, residual;
+	int *pattern, *blocks, *Ps, *Q, sections = 40, numBlocks, maxBlock, lnz, unz, i, k;
+
+	/* Process the command line options */
+	while((opt = getopt_long(argc, argv, "ve:l:b:", longopts, NULL)) != -1) {
+		switch(opt) {
+		case 'v': cktluInfo(); ExitSuccess;
+		case 'e': OpenErrorFile(optarg); break;
+		case 'l': OpenLogFile(optarg); break;
+		case 'b': ExitFailureIf(bench(atoi(optarg))); ExitSuccess;
+		case '?': ExitFailure("Unkown option");
+        case ':': ExitFailure("Option needs a value");
+		default:  ExitFailure("Invalid option");
+		}
+	}
+
+	matrix.n = sections + 2;
+	dense = calloc(matrix.n*matrix.n, sizeof(double));
+	ExitFailureIf(dense == NULL);
+	pattern = calloc(matrix.n*matrix.n, sizeof(int));
+	ExitFailureIf(pattern == NULL);
+	matrix.colStart = calloc(matrix.n + 1, sizeof(int));
+	ExitFailureIf(matrix.colStart == NULL);
+	matrix.row = calloc(matrix.n*matrix.n, sizeof(int));
+	ExitFailureIf(matrix.row == NULL);
+	matrix.value = calloc(matrix.n*matrix.n, sizeof(double));
+	ExitFailureIf(matrix.value == NULL);
+	x = calloc(matrix.n, sizeof(double));
+	ExitFailureIf(x == NULL);
+	b = calloc(matrix.n, sizeof(double));
+	ExitFailureIf(b == NULL);
+	blocks = calloc(matrix.n + 1, sizeof(int));
+	ExitFailureIf(blocks == NULL);
+	Ps = calloc(matrix.n, sizeof(int));
+	ExitFailureIf(Ps == NULL);
+	Q = calloc(matrix.n, sizeof(int));
+	ExitFailureIf(Q == NULL);
+
+	/* Full factorization */
+	ExitFailureIf(ladder(&matrix, dense, pattern, sections, 1.0));
+	ExitFailureIf(matrixCompress(&matrix, dense, pattern));
+	lu = cktluNew(lu, matrix.n, matrix.colStart, matrix.row);
+	ExitFailureIf(lu == NULL);
+	ExitFailureIf(cktluGetInfo(lu, &numBlocks, &maxBlock, &lnz, &unz));
+	Info("blocks: %i, largest: %i", numBlocks, maxBlock);
+	ExitFailureIf(cktluBlocks(matrix.n, matrix.colStart, matrix.row,
+			blocks) != numBlocks);
+
+	ExitFailureIf(cktluFactor(lu, matrix.value, 1e-3));
+	ExitFailureIf(cktluGetInfo(lu, &numBlocks, &maxBlock, &lnz, &unz));
+	Info("L: %i, U: %i", lnz, unz);
+	for(i = 0; i < matrix.n; i++) {
+		b[i] = x[i] = (i == matrix.n - 1) ? 5.0 : 0.01*i;
+	}
+	ExitFailureIf(cktluSolve(lu, x));
+	residual = matrixResidual(&matrix, x, b);
+	Info("factor residual: %e", residual);
+	ExitFailureIf(residual > 1e-12);
+
+	/* Same pattern new values */
+	ExitFailureIf(ladder(&matrix, dense, pattern, sections, 3.7));
+	ExitFailureIf(matrixCompress(&matrix, dense, pattern));
+	ExitFailureIf(cktluRefactor(lu, matrix.value, 1e-3));
+	for(i = 0; i < matrix.n; i++) {
+		x[i] = b[i];
+	}
+	ExitFailureIf(cktluSolve(lu, x));
+	residual = matrixResidual(&matrix, x, b);
+	Info("refactor residual: %e", residual);
+	ExitFailureIf(residual > 1e-12);
+
+	/* Same pattern new values, refactored on more than one thread */
+	ExitFailureIf(cktluSetThreads(lu, 4));
+	ExitFailureIf(ladder(&matrix, dense, pattern, sections, 0.6));
+	ExitFailureIf(matrixCompress(&matrix, dense, pattern));
+	ExitFailureIf(cktluRefactor(lu, matrix.value, 1e-3));
+	for(i = 0; i < matrix.n; i++) {
+		x[i] = b[i];
+	}
+	ExitFailureIf(cktluSolve(lu, x));
+	residual = matrixResidual(&matrix, x, b);
+	Info("threaded refactor residual: %e", residual);
+	ExitFailureIf(residual > 1e-12);
+
+	/* Single precision factors, refined against A in double */
+	ExitFailureIf(cktluSetSingle(lu, 1));
+	ExitFailureIf(cktluFactor(lu, matrix.value, 1e-3));
+	for(i = 0; i < matrix.n; i++) {
+		x[i] = b[i];
+	}
+	ExitFailureIf(cktluSolve(lu, x));
+	residual = matrixResidual(&matrix, x, b);
+	Info("single residual: %e", residual);
+	ExitFailureIf(residual > 1e-4);
+	for(k = 0; k < 3; k++) {
+		ExitFailureIf(matrixRefine(&matrix, lu, x, b));
+	}
+	residual = matrixResidual(&matrix, x, b);
+	Info("refined residual: %e", residual);
+	ExitFailureIf(residual > 1e-12);
+
+	/* Same pattern, ordering copied from the first object */
+	ExitFailureIf(cktluGetOrder(lu, Ps, Q, blocks) != numBlocks);
+	ordered = cktluNewOrdered(ordered, matrix.n, matrix.colStart, matrix.row,
+			numBlocks, Ps, Q, blocks);
+	ExitFailureIf(ordered == NULL);
+	ExitFailureIf(cktluFactor(ordered, matrix.value, 1e-3));
+	for(i = 0; i < matrix.n; i++) {
+		x[i] = b[i];
+	}
+	ExitFailureIf(cktluSolve(ordered, x));
+	residual = matrixResidual(&matrix, x, b);
+	Info("ordered residual: %e", residual);
+	ExitFailureIf(residual > 1e-12);
+
+	ExitFailureIf(cktluDestroy(&ordered));
+	ExitFailureIf(cktluDestroy(&lu));
+	free(dense);
+	free(pattern);
+	free(matrix.colStart);
+	free(matrix.row);
+	free(matrix.value);
+	free(x);
+	free(b);
+	free(blocks);
+	free(Ps);
+	free(Q);
+
+	ExitSuccess;
+}
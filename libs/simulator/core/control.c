@@ -60,18 +60,35 @@ control_ * controlNew(control_ *r)
 	r->trtol = 1;
 	r->minstep = -1.0;
 	r->gmin = 1e-15;
+	r->pivrel = 1e-3;
 	r->maxorder = 2;
 
 	/*-- New eispice Options --*/
-	r->luLibrary = CONTROL_LU_SUPERLU;
+	r->luLibrary = CONTROL_LU_AUTO;
+	r->luDenseSize = 32;
+	r->luOrdering = CONTROL_ORDER_COLAMD;
+	r->niMethod = CONTROL_NIMETHOD_TRAP;
+	r->chord = 0;
+	r->chordRate = 0.5;
+	r->woodburyRank = 0;
+	r->luCache = 0;
+	r->luThreads = 1;
+	r->luSingle = 0;
+	r->bypass = 0;
+	r->predictor = 0;
+	r->stepLadder = 0.0;
 	r->maxAngleA = M_PI/3;
 	r->maxAngleV = M_PI/3;
 
+	/*-- Statistics --*/
+	r->bypasses = 0;
+
 	/*-- Transient Analysis State --*/
 	r->tstop = 0.0;
 	r->tstep = 0.0;
 	r->integratorOrder = 1;
 	r->time = 0.0;
+	r->step = 0.0;
 
 	return r;
 }
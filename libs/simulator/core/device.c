@@ -40,140 +40,14 @@ int devicePrint(device_ *r, void *data)
 	return 0;
 }
 
-/*---------------------------------------------------------------------------*/
-
-int deviceLoad(device_ *r, void *data)
-{
-	ReturnErrIf(r == NULL);
-	ReturnErrIf(data != NULL);
-	ReturnErrIf(r->class == NULL);
-	if(r->class->load != NULL) {
-		ReturnErrIf(r->class->load(r));
-	}
-
-	return 0;
-}
-
-/*---------------------------------------------------------------------------*/
-
-int deviceLinearize(device_ *r, int *linear)
-{
-	int localLinear = 1;
-
-	ReturnErrIf(r == NULL);
-	ReturnErrIf(linear == NULL);
-	ReturnErrIf(r->class == NULL);
-
-	if(r->class->linearize != NULL) {
-			ReturnErrIf(r->class->linearize(r, &localLinear));
-			*linear = (*linear) && (localLinear);
-	}
-
-	return 0;
-}
-
-/*---------------------------------------------------------------------------*/
-
-int deviceInitStep(device_ *r, void *data)
-{
-	ReturnErrIf(r == NULL);
-	ReturnErrIf(data != NULL);
-	ReturnErrIf(r->class == NULL);
-	if(r->class->initStep != NULL) {
-		ReturnErrIf(r->class->initStep(r));
-	}
-
-	return 0;
-}
-
-/*---------------------------------------------------------------------------*/
-
-int deviceStep(device_ *r, int *breakPoint)
-{
-	int localBreakPoint = 0;
-
-	ReturnErrIf(r == NULL);
-	ReturnErrIf(breakPoint == NULL);
-	ReturnErrIf(r->class == NULL);
-
-	if(r->class->step != NULL) {
-		ReturnErrIf(r->class->step(r, &localBreakPoint));
-		*breakPoint = (*breakPoint) || (localBreakPoint);
-	}
-
-	return 0;
-}
-
-/*---------------------------------------------------------------------------*/
-
-int deviceMinStep(device_ *r, double *minStep)
-{
-	double localMinStep = 0.0;
-
-	ReturnErrIf(r == NULL);
-	ReturnErrIf(minStep == NULL);
-	ReturnErrIf(r->class == NULL);
-
-	if(r->class->minStep != NULL) {
-			ReturnErrIf(r->class->minStep(r, &localMinStep));
-			if((localMinStep > 0.0) && (localMinStep < *minStep)) {
-				*minStep = localMinStep;
-			}
-	}
-
-	return 0;
-}
-
-/*---------------------------------------------------------------------------*/
-
-int deviceNextStep(device_ *r, double *nextStep)
-{
-	double localNextStep = 0.0;
-
-	ReturnErrIf(r == NULL);
-	ReturnErrIf(nextStep == NULL);
-	ReturnErrIf(r->class == NULL);
-
-	if(r->class->nextStep != NULL) {
-			ReturnErrIf(r->class->nextStep(r, &localNextStep));
-			if((localNextStep > r->control->minstep) &&
-					(localNextStep < *nextStep)) {
-				*nextStep = localNextStep;
-			}
-	}
-
-	return 0;
-}
-
-/*---------------------------------------------------------------------------*/
-
-int deviceIntegrate(device_ *r, void *data)
-{
-	ReturnErrIf(r == NULL);
-	ReturnErrIf(data != NULL);
-	ReturnErrIf(r->class == NULL);
-	if(r->class->integrate != NULL) {
-		ReturnErrIf(r->class->integrate(r));
-	}
-
-	return 0;
-}
-
 /*===========================================================================
  |                               Device Utilities                            |
   ===========================================================================*/
 
-listAddReturn_ deviceCheckDuplicate(device_ *old, device_ *new)
+char * deviceGetRefdes(device_ *r)
 {
-	ReturnErrIf(old == NULL);
-	ReturnErrIf(new == NULL);
-
-	if(!strcmp(old->refdes, new->refdes)) {
-		Error("%s is listed twice", new->refdes);
-		return LIST_ADD_NOWHERE;
-	}
-
-	return LIST_ADD_NOTHERE;
+	ReturnNULLIf(r == NULL);
+	return r->refdes;
 }
 
 /*===========================================================================
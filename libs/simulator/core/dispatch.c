@@ -0,0 +1,593 @@
+/*
+ * Copyright (C) 2006 Cooper Street Innovations Inc.
+ *	Charles Eidsness    <charles@cooper-street.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ */
+
+#include <math.h>
+#include <log.h>
+#include <data.h>
+
+#include "dispatch.h"
+#include "breakqueue.h"
+#include "device_internal.h"
+
+/*===========================================================================
+ |                            Private Structure                              |
+  ===========================================================================*/
+
+/* Devices start to end-1 all share class */
+typedef struct {
+	deviceClass_ *class;
+	int start;
+	int end;
+} dispatchGroup_;
+
+typedef struct {
+	device_ **devices;
+	dispatchGroup_ *groups;
+	int numGroups;
+} dispatchPhase_;
+
+typedef struct {
+	deviceClass_ *class;
+	deviceBatch_ *batch;
+} dispatchBatch_;
+
+typedef enum {
+	DISPATCH_LOAD,
+	DISPATCH_LINEARIZE,
+	DISPATCH_INIT_STEP,
+	DISPATCH_STEP,
+	DISPATCH_MIN_STEP,
+	DISPATCH_NEXT_BREAK,
+	DISPATCH_DELAY,
+	DISPATCH_INTEGRATE,
+} dispatchHook_;
+
+struct _dispatch {
+	dispatchPhase_ load;
+	dispatchPhase_ linearize;
+	dispatchPhase_ initStep;
+	dispatchPhase_ step;
+	dispatchPhase_ minStep;
+	dispatchPhase_ nextBreak;
+	dispatchPhase_ delay;
+	dispatchPhase_ integrate;
+	dispatchBatch_ *batches; /* classes that handle all devices at once */
+	int numBatches;
+	breakqueue_ *breaks; /* next break-point of each device, and delayed ones */
+	control_ *control;
+};
+
+/*===========================================================================
+ |                               Operating Point                             |
+  ===========================================================================*/
+
+int dispatchLoad(dispatch_ *r)
+{
+	dispatchGroup_ *g;
+	deviceLoad_ load;
+	int i;
+
+	ReturnErrIf(r == NULL);
+
+	for(g = r->load.groups; g < r->load.groups + r->load.numGroups; g++) {
+		load = g->class->load;
+		for(i = g->start; i < g->end; i++) {
+			ReturnErrIf(load(r->load.devices[i]));
+		}
+	}
+
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+int dispatchLinearize(dispatch_ *r, int *linear)
+{
+	dispatchGroup_ *g;
+	deviceLinearize_ linearize;
+	int i, localLinear;
+
+	ReturnErrIf(r == NULL);
+	ReturnErrIf(linear == NULL);
+
+	for(g = r->linearize.groups;
+			g < r->linearize.groups + r->linearize.numGroups; g++) {
+		linearize = g->class->linearize;
+		for(i = g->start; i < g->end; i++) {
+			localLinear = 1;
+			ReturnErrIf(linearize(r->linearize.devices[i], &localLinear));
+			*linear = (*linear) && (localLinear);
+		}
+	}
+
+	return 0;
+}
+
+/*===========================================================================
+ |                            Transient Analysis                             |
+  ===========================================================================*/
+
+int dispatchInitStep(dispatch_ *r)
+{
+	dispatchBatch_ *b;
+	dispatchGroup_ *g;
+	deviceInitStep_ initStep;
+	int i;
+
+	ReturnErrIf(r == NULL);
+
+	for(g = r->initStep.groups;
+			g < r->initStep.groups + r->initStep.numGroups; g++) {
+		initStep = g->class->initStep;
+		for(i = g->start; i < g->end; i++) {
+			ReturnErrIf(initStep(r->initStep.devices[i]));
+		}
+	}
+
+	for(b = r->batches; b < r->batches + r->numBatches; b++) {
+		if(b->class->batchInitStep != NULL) {
+			ReturnErrIf(b->class->batchInitStep(b->batch));
+		}
+	}
+
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+int dispatchStep(dispatch_ *r, int *breakPoint)
+{
+	dispatchGroup_ *g;
+	deviceStep_ step;
+	int i, localBreakPoint;
+
+	ReturnErrIf(r == NULL);
+	ReturnErrIf(breakPoint == NULL);
+
+	for(g = r->step.groups; g < r->step.groups + r->step.numGroups; g++) {
+		step = g->class->step;
+		for(i = g->start; i < g->end; i++) {
+			localBreakPoint = 0;
+			ReturnErrIf(step(r->step.devices[i], &localBreakPoint));
+			*breakPoint = (*breakPoint) || (localBreakPoint);
+		}
+	}
+
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+int dispatchMinStep(dispatch_ *r, double *minStep)
+{
+	dispatchBatch_ *b;
+	dispatchGroup_ *g;
+	deviceMinStep_ min;
+	double localMinStep;
+	int i;
+
+	ReturnErrIf(r == NULL);
+	ReturnErrIf(minStep == NULL);
+
+	for(g = r->minStep.groups;
+			g < r->minStep.groups + r->minStep.numGroups; g++) {
+		min = g->class->minStep;
+		for(i = g->start; i < g->end; i++) {
+			localMinStep = 0.0;
+			ReturnErrIf(min(r->minStep.devices[i], &localMinStep));
+			if((localMinStep > 0.0) && (localMinStep < *minStep)) {
+				*minStep = localMinStep;
+			}
+		}
+	}
+
+	for(b = r->batches; b < r->batches + r->numBatches; b++) {
+		if(b->class->batchMinStep != NULL) {
+			ReturnErrIf(b->class->batchMinStep(b->batch, minStep));
+		}
+	}
+
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+int dispatchInitBreak(dispatch_ *r)
+{
+	dispatchGroup_ *g;
+	deviceNextBreak_ next;
+	device_ *device;
+	double nextBreak;
+	int i;
+
+	ReturnErrIf(r == NULL);
+
+	ReturnErrIf(breakqueueClear(r->breaks));
+
+	for(g = r->nextBreak.groups;
+			g < r->nextBreak.groups + r->nextBreak.numGroups; g++) {
+		next = g->class->nextBreak;
+		for(i = g->start; i < g->end; i++) {
+			device = r->nextBreak.devices[i];
+			nextBreak = HUGE_VAL;
+			ReturnErrIf(next(device, r->control->time, &nextBreak));
+			if(nextBreak != HUGE_VAL) {
+				ReturnErrIf(breakqueueAdd(r->breaks, nextBreak, device));
+			}
+		}
+	}
+
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Only the earliest break-point is looked at, the ones that have been
+ * reached, or are within minstep of the present time, are replaced by
+ * their device's next one.
+ */
+int dispatchNextStep(dispatch_ *r, double *nextStep)
+{
+	device_ *device;
+	double time, nextBreak;
+
+	ReturnErrIf(r == NULL);
+	ReturnErrIf(nextStep == NULL);
+
+	while(1) {
+		ReturnErrIf(breakqueuePeek(r->breaks, &time, (void**)&device));
+		if((time - r->control->time) > r->control->minstep) {
+			break;
+		}
+		ReturnErrIf(breakqueuePop(r->breaks));
+
+		/* Delayed break-points don't have an owner */
+		if(device != NULL) {
+			time = (time > r->control->time) ? time : r->control->time;
+			nextBreak = HUGE_VAL;
+			ReturnErrIf(device->class->nextBreak(device, time, &nextBreak));
+			ReturnErrIf(nextBreak <= time, "%s %s break-point %es is in the past",
+					device->class->type, device->refdes, nextBreak);
+			if(nextBreak != HUGE_VAL) {
+				ReturnErrIf(breakqueueAdd(r->breaks, nextBreak, device));
+			}
+		}
+	}
+
+	if((time - r->control->time) < *nextStep) {
+		*nextStep = time - r->control->time;
+	}
+
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+int dispatchBreak(dispatch_ *r, double time)
+{
+	dispatchGroup_ *g;
+	deviceDelay_ delay;
+	double localDelay;
+	int i;
+
+	ReturnErrIf(r == NULL);
+
+	for(g = r->delay.groups; g < r->delay.groups + r->delay.numGroups; g++) {
+		delay = g->class->delay;
+		for(i = g->start; i < g->end; i++) {
+			localDelay = 0.0;
+			ReturnErrIf(delay(r->delay.devices[i], &localDelay));
+			if(localDelay > r->control->minstep) {
+				ReturnErrIf(breakqueueAdd(r->breaks, time + localDelay, NULL));
+			}
+		}
+	}
+
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+int dispatchIntegrate(dispatch_ *r)
+{
+	dispatchBatch_ *b;
+	dispatchGroup_ *g;
+	deviceIntegrate_ integrate;
+	int i;
+
+	ReturnErrIf(r == NULL);
+
+	for(g = r->integrate.groups;
+			g < r->integrate.groups + r->integrate.numGroups; g++) {
+		integrate = g->class->integrate;
+		for(i = g->start; i < g->end; i++) {
+			ReturnErrIf(integrate(r->integrate.devices[i]));
+		}
+	}
+
+	for(b = r->batches; b < r->batches + r->numBatches; b++) {
+		if(b->class->batchIntegrate != NULL) {
+			ReturnErrIf(b->class->batchIntegrate(b->batch));
+		}
+	}
+
+	return 0;
+}
+
+/*===========================================================================
+ |                                  Build                                    |
+  ===========================================================================*/
+
+static int dispatchGetDevices(device_ *device, device_ ***next)
+{
+	ReturnErrIf(device == NULL);
+	ReturnErrIf(device->class == NULL);
+	**next = device;
+	(*next)++;
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Does the class implement the hook a phase calls */
+static int dispatchImplements(deviceClass_ *class, dispatchHook_ hook)
+{
+	switch(hook) {
+	case DISPATCH_LOAD:			return (class->load != NULL);
+	case DISPATCH_LINEARIZE:	return (class->linearize != NULL);
+	case DISPATCH_INIT_STEP:	return (class->initStep != NULL);
+	case DISPATCH_STEP:			return (class->step != NULL);
+	case DISPATCH_MIN_STEP:		return (class->minStep != NULL);
+	case DISPATCH_NEXT_BREAK:	return (class->nextBreak != NULL);
+	case DISPATCH_DELAY:		return (class->delay != NULL);
+	case DISPATCH_INTEGRATE:	return (class->integrate != NULL);
+	}
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Collects the devices whose class implements hook. When grouped every
+ * device of a class goes in one group, in the order the classes first
+ * appear, otherwise the original order is kept and only neighbours of the
+ * same class share a group.
+ */
+static int dispatchPhaseBuild(dispatchPhase_ *r, device_ **devices,
+		int numDevices, dispatchHook_ hook, int grouped)
+{
+	dispatchGroup_ *g;
+	deviceClass_ *class;
+	char *placed;
+	int i, j, length;
+
+	r->devices = malloc((numDevices + 1) * sizeof(device_*));
+	ReturnErrIf(r->devices == NULL);
+	r->groups = malloc((numDevices + 1) * sizeof(dispatchGroup_));
+	ReturnErrIf(r->groups == NULL);
+	placed = calloc(numDevices + 1, sizeof(char));
+	ReturnErrIf(placed == NULL);
+
+	length = 0;
+	r->numGroups = 0;
+	for(i = 0; i < numDevices; i++) {
+		class = devices[i]->class;
+		if(placed[i] || !dispatchImplements(class, hook)) {
+			continue;
+		}
+
+		if(grouped || (r->numGroups == 0) ||
+				(r->groups[r->numGroups - 1].class != class)) {
+			g = &r->groups[r->numGroups++];
+			g->class = class;
+			g->start = length;
+		} else {
+			g = &r->groups[r->numGroups - 1];
+		}
+
+		if(grouped) {
+			for(j = i; j < numDevices; j++) {
+				if(devices[j]->class == class) {
+					r->devices[length++] = devices[j];
+					placed[j] = 1;
+				}
+			}
+		} else {
+			r->devices[length++] = devices[i];
+			placed[i] = 1;
+		}
+		g->end = length;
+	}
+
+	free(placed);
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* One batch for each class that has batched hooks, the devices are passed
+ * in the order they were added.
+ */
+static int dispatchBatchBuild(dispatch_ *r, device_ **devices,
+		int numDevices)
+{
+	dispatchBatch_ *b;
+	deviceClass_ *class;
+	device_ **members;
+	int i, j, k, length;
+
+	r->batches = calloc(numDevices + 1, sizeof(dispatchBatch_));
+	ReturnErrIf(r->batches == NULL);
+	members = malloc((numDevices + 1) * sizeof(device_*));
+	ReturnErrIf(members == NULL);
+
+	r->numBatches = 0;
+	for(i = 0; i < numDevices; i++) {
+		class = devices[i]->class;
+		if(class->batchNew == NULL) {
+			continue;
+		}
+		for(k = 0; k < r->numBatches; k++) {
+			if(r->batches[k].class == class) {
+				break;
+			}
+		}
+		if(k < r->numBatches) {
+			continue;
+		}
+
+		length = 0;
+		for(j = i; j < numDevices; j++) {
+			if(devices[j]->class == class) {
+				members[length++] = devices[j];
+			}
+		}
+
+		b = &r->batches[r->numBatches];
+		b->class = class;
+		b->batch = class->batchNew(members, length);
+		if(b->batch == NULL) {
+			free(members);
+			ReturnErr("Failed to batch %s devices", class->type);
+		}
+		r->numBatches++;
+	}
+
+	free(members);
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void dispatchPhaseDestroy(dispatchPhase_ *r)
+{
+	if(r->devices != NULL)
+		free(r->devices);
+	if(r->groups != NULL)
+		free(r->groups);
+}
+
+/*===========================================================================
+ |                          Constructor / Destructor                         |
+  ===========================================================================*/
+
+int dispatchDestroy(dispatch_ **r)
+{
+	int i;
+	ReturnErrIf(r == NULL);
+	ReturnErrIf(*r == NULL);
+
+	Debug("Destroying dispatch %p", *r);
+
+	dispatchPhaseDestroy(&(*r)->load);
+	dispatchPhaseDestroy(&(*r)->linearize);
+	dispatchPhaseDestroy(&(*r)->initStep);
+	dispatchPhaseDestroy(&(*r)->step);
+	dispatchPhaseDestroy(&(*r)->minStep);
+	dispatchPhaseDestroy(&(*r)->nextBreak);
+	dispatchPhaseDestroy(&(*r)->delay);
+	dispatchPhaseDestroy(&(*r)->integrate);
+
+	if((*r)->batches != NULL) {
+		for(i = 0; i < (*r)->numBatches; i++) {
+			if((*r)->batches[i].class->batchDestroy(
+					&(*r)->batches[i].batch)) {
+				Warn("Error destroying %s batch",
+						(*r)->batches[i].class->type);
+			}
+		}
+		free((*r)->batches);
+	}
+
+	if((*r)->breaks != NULL) {
+		if(breakqueueDestroy(&(*r)->breaks)) {
+			Warn("Error destroying break queue");
+		}
+	}
+
+	free(*r);
+	*r = NULL;
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+dispatch_ * dispatchNew(dispatch_ *r, control_ *control, list_ *devices)
+{
+	device_ **all = NULL, **next;
+	int length;
+
+	ReturnNULLIf(r != NULL);
+	ReturnNULLIf(control == NULL);
+	ReturnNULLIf(devices == NULL);
+
+	r = calloc(1, sizeof(dispatch_));
+	ReturnNULLIf(r == NULL);
+
+	Debug("Creating dispatch %p", r);
+
+	r->control = control;
+	r->breaks = breakqueueNew(r->breaks);
+	GotoFailedIf(r->breaks == NULL);
+
+	length = listLength(devices);
+	GotoFailedIf(length < 0);
+	all = malloc((length + 1) * sizeof(device_*));
+	GotoFailedIf(all == NULL);
+	next = all;
+	GotoFailedIf(listExecute(devices, (listExecute_)dispatchGetDevices,
+			(void*)&next));
+
+	/* Load adds into shared entries of A and B so it keeps the order the
+	 * devices were added in, the sum has to come out the same every run.
+	 */
+	GotoFailedIf(dispatchPhaseBuild(&r->load, all, length,
+			DISPATCH_LOAD, 0));
+	GotoFailedIf(dispatchPhaseBuild(&r->linearize, all, length,
+			DISPATCH_LINEARIZE, 1));
+	GotoFailedIf(dispatchPhaseBuild(&r->initStep, all, length,
+			DISPATCH_INIT_STEP, 1));
+	GotoFailedIf(dispatchPhaseBuild(&r->step, all, length,
+			DISPATCH_STEP, 1));
+	GotoFailedIf(dispatchPhaseBuild(&r->minStep, all, length,
+			DISPATCH_MIN_STEP, 1));
+	GotoFailedIf(dispatchPhaseBuild(&r->nextBreak, all, length,
+			DISPATCH_NEXT_BREAK, 1));
+	GotoFailedIf(dispatchPhaseBuild(&r->delay, all, length,
+			DISPATCH_DELAY, 1));
+	GotoFailedIf(dispatchPhaseBuild(&r->integrate, all, length,
+			DISPATCH_INTEGRATE, 1));
+	GotoFailedIf(dispatchBatchBuild(r, all, length));
+
+	Debug("%i devices, %i step groups, %i integrate groups and %i batches",
+			length, r->step.numGroups, r->integrate.numGroups, r->numBatches);
+
+	free(all);
+	return r;
+
+failed:
+	if(all != NULL)
+		free(all);
+	dispatchDestroy(&r);
+	return NULL;
+}
+
+/*===========================================================================*/
+
@@ -19,92 +19,186 @@
  *
  */
 
+#include <string.h>
+#include <math.h>
 #include <log.h>
-#include <data.h>
 
 #include "history.h"
 
+#define HISTORY_START	64	/* Initial number of time-points */
+
 struct _history {
-	double time;
-	double *data;
-	int length;
-	unsigned int flag;
+	double *time;	/* time of each point, dense for searching */
+	double *data;	/* rows of time then the solution */
+	unsigned int *flag;
+	int *pick;		/* solution entries that are kept, NULL for all */
+	int *map;		/* row index to column, -1 if it isn't kept */
+	double window;	/* how far back points are kept, HUGE_VAL for all */
+	int width;		/* length of a row, the number kept plus one */
+	int rows;		/* length of the solution */
+	int length;		/* number of points */
+	int size;		/* number of points allocated */
 };
 
 /*===========================================================================*/
 
-listSearchReturn_ historySearch(history_ *r, history_ *next, double *time)
+/* The arrays double in size when they fill up */
+static int historyGrow(history_ *r)
 {
-	ReturnErrIf(r == NULL);
-	ReturnErrIf(time == NULL);
+	double *time, *data;
+	unsigned int *flag;
+	int size;
 
-	/* At end of list */
-	if((r->time <= *time) && (next == NULL)) {
-		return LIST_SEARCH_MATCH;
-	}
+	size = (r->size < HISTORY_START) ? HISTORY_START : 2 * r->size;
+
+	time = realloc(r->time, size * sizeof(double));
+	ReturnErrIf(time == NULL, "Malloc Failed");
+	r->time = time;
+
+	flag = realloc(r->flag, size * sizeof(unsigned int));
+	ReturnErrIf(flag == NULL, "Malloc Failed");
+	r->flag = flag;
+
+	data = realloc(r->data, size * r->width * sizeof(double));
+	ReturnErrIf(data == NULL, "Malloc Failed");
+	r->data = data;
+
+	r->size = size;
+
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
 
-	/* between points */
-	if((r->time <= *time) && (next->time > *time)) {
-		return LIST_SEARCH_MATCH;
+/* Drops the points that are older than the window before time, except for
+ * the last one before it which is still needed to interpolate at the
+ * start of the window. The rest are moved down to the start of the arrays
+ * so the space is reused rather than grown.
+ */
+static int historyForget(history_ *r, double time)
+{
+	int old;
+
+	if((r->window == HUGE_VAL) || (r->length < 3)) {
+		return 0;
 	}
 
-	/* If not a match return which way we have to move to find a match */
-	if(r->time > *time) {
-		return LIST_SEARCH_PREVIOUS;
-	} else if(r->time < *time) {
-		return LIST_SEARCH_NEXT;
+	old = r->length - 1;
+	ReturnErrIf(historySearch(r, time - r->window, &old));
+
+	/* Always keep the last two for extrapolating past the end */
+	if(old > r->length - 2) {
+		old = r->length - 2;
+	}
+	if(old <= 0) {
+		return 0;
 	}
 
-	return LIST_SEARCH_ERR;
+	Debug("Forgetting %i points of history", old);
+
+	r->length -= old;
+	memmove(r->time, &r->time[old], r->length * sizeof(double));
+	memmove(r->flag, &r->flag[old], r->length * sizeof(unsigned int));
+	memmove(r->data, &r->data[old * r->width],
+			r->length * r->width * sizeof(double));
+
+	return 0;
 }
 
 /*---------------------------------------------------------------------------*/
 
-listSearchReturn_ historySearchBreak(history_ *r, history_ *next, double *time)
+int historyRecord(history_ *r, double time, double *data, unsigned int flag)
 {
+	double *row;
+	int i;
+
 	ReturnErrIf(r == NULL);
+	ReturnErrIf(data == NULL);
 
-	if(r->flag & HISTORY_FLAG_BRKPOINT) {
-		return LIST_SEARCH_MATCH;
+	if(r->length >= r->size) {
+		/* Only grow if forgetting didn't free up at least half */
+		ReturnErrIf(historyForget(r, time));
+		if(r->length > r->size / 2) {
+			ReturnErrIf(historyGrow(r));
+		}
 	}
 
-	if(next == NULL) {
-		return LIST_SEARCH_NOTONLIST;
+	r->time[r->length] = time;
+	r->flag[r->length] = flag;
+	row = &r->data[r->length * r->width];
+	row[0] = time;
+	if(r->pick == NULL) {
+		memcpy(&row[1], data, (r->width - 1) * sizeof(double));
+	} else {
+		for(i = 1; i < r->width; i++) {
+			row[i] = data[r->pick[i-1]];
+		}
 	}
+	r->length++;
 
-	return LIST_SEARCH_NEXT;
+	return 0;
 }
 
 /*---------------------------------------------------------------------------*/
 
-int historyRecall(history_ *r, double *data, int length)
+/* Finds the last point at or before time, or the first point if time is
+ * before all of them. index is used as a starting guess, searches tend to
+ * land close to the last one.
+ */
+int historySearch(history_ *r, double time, int *index)
 {
+	int lo, hi, mid;
+
 	ReturnErrIf(r == NULL);
-	ReturnErrIf(data == NULL);
-	ReturnErrIf(length != r->length);
-	memcpy(data, r->data, length*sizeof(double));
+	ReturnErrIf(index == NULL);
+	ReturnErrIf(r->length == 0);
+
+	lo = *index;
+	if((lo >= 0) && (lo < r->length) && (r->time[lo] <= time) &&
+			((lo == r->length - 1) || (r->time[lo + 1] > time))) {
+		return 0;
+	}
+
+	/* Binary search for the last time <= time */
+	lo = 0;
+	hi = r->length - 1;
+	while(lo < hi) {
+		mid = (lo + hi + 1) / 2;
+		if(r->time[mid] <= time) {
+			lo = mid;
+		} else {
+			hi = mid - 1;
+		}
+	}
+	*index = lo;
+
 	return 0;
 }
 
 /*---------------------------------------------------------------------------*/
 
-int historyGetTime(history_ *r, double *time)
+int historyGetTime(history_ *r, int index, double *time)
 {
 	ReturnErrIf(r == NULL);
 	ReturnErrIf(time == NULL);
-	*time = r->time;
+	ReturnErrIf((index < 0) || (index >= r->length));
+	*time = r->time[index];
 	return 0;
 }
 
 /*---------------------------------------------------------------------------*/
 
-int historyGetData(history_ *r, double *data, int index)
+int historyGetData(history_ *r, int index, int row, double *data)
 {
+	int column;
+
 	ReturnErrIf(r == NULL);
 	ReturnErrIf(data == NULL);
-	ReturnErrIf(index < 0);
-	ReturnErrIf(index >= r->length);
-	*data = r->data[index];
+	ReturnErrIf((index < 0) || (index >= r->length));
+	ReturnErrIf((row < 1) || (row > r->rows));
+	column = (r->map == NULL) ? row : r->map[row];
+	ReturnErrIf(column < 1, "Row %i isn't kept in the history", row);
+	*data = r->data[index * r->width + column];
 	return 0;
 }
 
@@ -118,55 +212,167 @@ int historyGetLength(history_ *r)
 
 /*---------------------------------------------------------------------------*/
 
-int historyGetAllData(history_ *r, double *data, int length)
+/* Hands the rows over to the caller, who has to free them, without copying
+ * them. The history starts again empty, a run that's continued only adds
+ * the points from there on.
+ */
+int historyTakeData(history_ *r, double **data, int *numPoints)
 {
+	double *shrunk, *empty, *time;
+	unsigned int *flag;
+	int size = HISTORY_START;
+
 	ReturnErrIf(r == NULL);
 	ReturnErrIf(data == NULL);
-	ReturnErrIf(length != (r->length + 1));
-	data[0] = r->time;
-	memcpy(&data[1], r->data, r->length*sizeof(double));
+	ReturnErrIf(numPoints == NULL);
+
+	empty = malloc(size * r->width * sizeof(double));
+	ReturnErrIf(empty == NULL, "Malloc Failed");
+
+	/* Trim off the unused end, this shouldn't move the data */
+	shrunk = realloc(r->data, (r->length ? r->length : 1) *
+			r->width * sizeof(double));
+	*data = (shrunk != NULL) ? shrunk : r->data;
+	*numPoints = r->length;
+
+	/* The rest of the arrays go back to the starting size as well */
+	r->data = empty;
+	time = realloc(r->time, size * sizeof(double));
+	ReturnErrIf(time == NULL, "Malloc Failed");
+	r->time = time;
+	flag = realloc(r->flag, size * sizeof(unsigned int));
+	ReturnErrIf(flag == NULL, "Malloc Failed");
+	r->flag = flag;
+	r->size = size;
+	r->length = 0;
+
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+int historyClear(history_ *r)
+{
+	ReturnErrIf(r == NULL);
+	r->length = 0;
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Points more than window before the last one recorded can be dropped,
+ * HUGE_VAL keeps all of them.
+ */
+int historyRetain(history_ *r, double window)
+{
+	ReturnErrIf(r == NULL);
+	ReturnErrIf(isnan(window) || (window < 0));
+	r->window = window;
 	return 0;
 }
 
+/*---------------------------------------------------------------------------*/
+
+/* Only the solution rows listed in rows (by row index, 1 to length) are
+ * kept, or all of them if rows is NULL.
+ */
+int historyInitialize(history_ *r, int length, int *rows, int numRows)
+{
+	int i;
+
+	ReturnErrIf(r == NULL);
+	ReturnErrIf(length < 0);
+
+	ReturnErrIf(historyClear(r));
+	if(r->data != NULL) {
+		free(r->data);
+		r->data = NULL;
+	}
+	if(r->pick != NULL) {
+		free(r->pick);
+		r->pick = NULL;
+	}
+	if(r->map != NULL) {
+		free(r->map);
+		r->map = NULL;
+	}
+
+	r->rows = length;
+	r->width = length + 1;
+	if(rows != NULL) {
+		r->pick = malloc((numRows + 1) * sizeof(int));
+		ReturnErrIf(r->pick == NULL, "Malloc Failed");
+		r->map = malloc((length + 1) * sizeof(int));
+		ReturnErrIf(r->map == NULL, "Malloc Failed");
+		for(i = 0; i <= length; i++) {
+			r->map[i] = -1;
+		}
+		r->width = 1;
+		for(i = 0; i < numRows; i++) {
+			ReturnErrIf((rows[i] < 1) || (rows[i] > length));
+			if(r->map[rows[i]] < 0) {
+				r->map[rows[i]] = r->width;
+				r->pick[r->width - 1] = rows[i] - 1;
+				r->width++;
+			}
+		}
+	}
+	r->size = 0;
+
+	return historyGrow(r);
+}
+
 /*===========================================================================
  |                          Constructor / Destructor                         |
   ===========================================================================*/
 
-int historyDestroy(history_ *r)
+int historyDestroy(history_ **r)
 {
 	ReturnErrIf(r == NULL);
+	ReturnErrIf((*r) == NULL);
+	Debug("Destroying History %p", *r);
 
-	if(r->data != NULL) {
-		free(r->data);
+	if((*r)->time != NULL) {
+		free((*r)->time);
 	}
 
-	free(r);
+	if((*r)->flag != NULL) {
+		free((*r)->flag);
+	}
+
+	if((*r)->data != NULL) {
+		free((*r)->data);
+	}
+
+	if((*r)->pick != NULL) {
+		free((*r)->pick);
+	}
+
+	if((*r)->map != NULL) {
+		free((*r)->map);
+	}
+
+	free(*r);
+	*r = NULL;
 
 	return 0;
 }
 
 /*---------------------------------------------------------------------------*/
 
-history_ * historyNew(double time, double *data, int length,
-		unsigned int flag)
+history_ * historyNew(history_ *r)
 {
-	history_ *r;
+	ReturnNULLIf(r != NULL);
 
-	ReturnNULLIf(data == NULL);
-	ReturnNULLIf(length < 0);
+	r = calloc(1, sizeof(history_));
+	ReturnNULLIf(r == NULL, "Malloc Failed");
 
-	r = malloc(sizeof(history_));
-	ReturnNULLIf(r == NULL);
+	Debug("Creating History %p", r);
 
-	r->time = time;
-	r->length = length;
-	r->flag = flag;
-	r->data = malloc(length*sizeof(double));
-	ReturnNULLIf(r->data == NULL);
-	memcpy(r->data, data, length*sizeof(double));
+	r->width = 1;
+	r->window = HUGE_VAL;
 
 	return r;
 }
 
 /*===========================================================================*/
-
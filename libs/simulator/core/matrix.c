@@ -19,131 +19,217 @@
  *
  */
 
+#include <math.h>
+#include <ctype.h>
+#include <pthread.h>
 #include <log.h>
-#include <superlu.h>
+#include <cktlu.h>
 
-#include "matrix.h"
+#include "matrix_internal.h"
+#include "netlib.h"
 #include "history.h"
+#include "integrator.h"
 
-typedef int (*matrixLibraryFunction)(matrix_ *r);
-typedef struct _matrixLibrary matrixLibrary_;
-struct _matrix {
-	list_ *nodes;
-	list_ *rows;
-	list_ *history;
-	/* Data */
-	double *A;
-	int *aRow;
-	int *aColStart;
-	double *X;
-	double *B;
-	int lenA;
-	int lenXB;
-	int index;
-	/* LU Library */
-	char *name;
-	matrixLibraryFunction unconfig;
-	matrixLibraryFunction solve;
-	matrixLibraryFunction solveAgain;
-	matrixLibrary_ *library;
-};
+/* Number of patterns kept in the symbolic analysis cache */
+#define MATRIX_SYMBOLIC_MAX		32
+
+#define MaxAbs(x,y) ((fabs(x) > fabs(y)) ? fabs(x) : fabs(y))
+
+/* Shared by every simulator in the process, see matrixSymbolicLock */
+static matrixSymbolic_ matrixSymbolic[MATRIX_SYMBOLIC_MAX];
+static unsigned int matrixSymbolicClock = 0;
+static int matrixSymbolicHits = 0;
+static int matrixSymbolicMisses = 0;
+static pthread_mutex_t matrixSymbolicMutex = PTHREAD_MUTEX_INITIALIZER;
 
 /*===========================================================================
- |                       SuperLU Library Interface                           |
+ |                            Solve Ab=x for b                               |
   ===========================================================================*/
 
-static char *matrixNameSuperLU = "SuperLU";
-
-struct _matrixLibrary {
-	SuperMatrix A;
-	SuperMatrix B;
-	SuperMatrix X;
-	SuperMatrix L;
-	SuperMatrix U;
-	int *perm_r;
-    int *perm_c;
-	int *etree;
-	char equed;
-	int info;
-	double *R;
-	double *C;
-	double rpg;
-	double rcond;
-	double *ferr;
-	double *berr;
-	mem_usage_t mem_usage;
-	superlu_options_t control;
-    SuperLUStat_t stat;
-	int firstPass;
-};
-
-/*---------------------------------------------------------------------------*/
-
-static int matrixSolveSuperLU(matrix_ *r)
-{
-	matrixLibrary_ *p;
+static int matrixWoodburyReset(matrix_ *r, double *A)
+{
+	int i;
 
-	ReturnErrIf(r == NULL);
-	p = r->library;
-	ReturnErrIf(p == NULL);
+	if(r->woodburyRank > 0) {
+		memcpy(r->woodburyA, A, r->lenA*sizeof(double));
+		for(i = 0; i < r->woodburyUsed; i++) {
+			r->woodburySlot[r->woodburyIndex[i]] = -1;
+		}
+		r->woodburyUsed = 0;
+		r->woodburySolved = 0;
+	}
 
-	/* Set the control back to full factorization (if it was changed) */
-	p->control.Fact = DOFACT;
+	return 0;
+}
 
-	if(p->firstPass) {
-		p->firstPass = 0;
-	} else {
-		/* Free the LU Matrices so we can use them */
-		Destroy_SuperNode_Matrix(&p->L);
-		Destroy_CompCol_Matrix(&p->U);
+/*---------------------------------------------------------------------------*/
+
+static int matrixFactor(matrix_ *r)
+{
+	r->factored = 0;
+	ReturnErrIf(r->class->factor(r));
+	r->factored = 1;
+	r->factorCount++;
+	ReturnErrIf(matrixWoodburyReset(r, r->A));
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Forward/back substitution with the current factors. Returns 1 if the
+ * library dropped its factors as not accurate enough, A has to be factored
+ * again before the next substitution.
+ */
+static int matrixSubstitute(matrix_ *r)
+{
+	int stale;
+
+	stale = r->class->solve(r);
+	ReturnErrIf(stale < 0);
+	if(stale) {
+		r->factored = 0;
 	}
 
-	/* Check out the SuperLU Header files and the SuperLU User's manual
-	 * to make sense of this mess...
-	 */
-	dgssvx(&p->control, &p->A, p->perm_c, p->perm_r, p->etree, &p->equed,
-			p->R, p->C, &p->L, &p->U, NULL, 0, &p->B, &p->X, &p->rpg,
-			&p->rcond, p->ferr, p->berr, &p->mem_usage, &p->stat, &p->info);
+	return stale;
+}
+
+/*---------------------------------------------------------------------------*/
 
-	ReturnErrIf(p->info < 0, "SuperLU: %ith arg had illegal value", -p->info);
-	if(p->info > 0) {
-		ReturnErrIf((p->info <= p->A.ncol), "SuperLU: U is singular");
-		ReturnErrIf((p->info == (p->A.ncol + 1)),
-				"SuperLU: RCOND is singular to working precision");
-		ReturnErrIf((p->info > (p->A.ncol + 1)),
-				"SuperLU: memory allocation error");
+static int matrixWoodburyAdd(matrix_ *r, int index)
+{
+	if(r->woodburySlot[index] >= 0) {
+		return 0;
+	} else if(r->woodburyUsed >= r->woodburyRank) {
+		return 1;
 	}
 
+	r->woodburySlot[index] = r->woodburyUsed;
+	r->woodburyIndex[r->woodburyUsed] = index;
+	r->woodburyUsed++;
+
 	return 0;
 }
 
 /*---------------------------------------------------------------------------*/
 
-static int matrixSolveAgainSuperLU(matrix_ *r)
+static int matrixSolveWoodbury(matrix_ *r)
 {
-	matrixLibrary_ *p;
+	double *Z, *M, *G, *T, *E, *B;
+	int n, k, i, j, a, b, c, full;
+
+	n = r->lenXB;
+	Z = r->woodburyZ;
+	M = r->woodburyM;
+	G = r->woodburyG;
+	T = r->woodburyT;
+	E = r->woodburyE;
+
+	/* If A = Afactored + S'*M*S where S selects the rows and columns that
+	 * have changed then
+	 *	X = Y - Z*M*inv(I + S*Z*M)*S*Y
+	 * where Y = inv(Afactored)*B and Z = inv(Afactored)*S'
+	 */
+	for(j = 0; j < n; j++) {
+		for(i = r->aColStart[j]; i < r->aColStart[j+1]; i++) {
+			if(r->A[i] != r->woodburyA[i]) {
+				full = matrixWoodburyAdd(r, r->aRow[i]) ||
+						matrixWoodburyAdd(r, j);
+				if(full) {
+					Debug("Update rank is too high, refactoring");
+					return 1;
+				}
+			}
+		}
+	}
+	k = r->woodburyUsed;
 
-	ReturnErrIf(r == NULL);
-	p = r->library;
-	ReturnErrIf(p == NULL);
+	/* The columns of inv(Afactored) only depend on the factors so they're
+	 * kept until the next factorization.
+	 */
+	for(; r->woodburySolved < k; r->woodburySolved++) {
+		memset(E, 0x0, n*sizeof(double));
+		E[r->woodburyIndex[r->woodburySolved]] = 1.0;
+		B = r->B;
+		r->B = E;
+		full = matrixSubstitute(r);
+		r->B = B;
+		ReturnErrIf(full < 0);
+		if(full) {
+			return 1;
+		}
+		memcpy(&Z[r->woodburySolved*n], r->X, n*sizeof(double));
+	}
 
-	/* Set the SuperLU control to use the same pattern and row permitations */
-	p->control.Fact = SamePattern_SameRowPerm;
+	memset(M, 0x0, k*k*sizeof(double));
+	for(j = 0; j < n; j++) {
+		for(i = r->aColStart[j]; i < r->aColStart[j+1]; i++) {
+			if(r->A[i] != r->woodburyA[i]) {
+				M[r->woodburySlot[r->aRow[i]] + k*r->woodburySlot[j]] +=
+						r->A[i] - r->woodburyA[i];
+			}
+		}
+	}
+
+	full = matrixSubstitute(r);
+	ReturnErrIf(full < 0);
+	if(full) {
+		return 1;
+	}
+	if(k == 0) {
+		return 0;
+	}
+
+	/* G = I + S*Z*M, T = S*Y */
+	for(a = 0; a < k; a++) {
+		for(c = 0; c < k; c++) {
+			G[a + k*c] = (a == c) ? 1.0 : 0.0;
+			for(b = 0; b < k; b++) {
+				G[a + k*c] += Z[b*n + r->woodburyIndex[a]]*M[b + k*c];
+			}
+		}
+		T[a] = r->X[r->woodburyIndex[a]];
+	}
+
+	if(netlibDGETRF(k, k, G, k, r->woodburyPiv)) {
+		Warn("Singular low rank update, refactoring");
+		return 1;
+	}
+	ReturnErrIf(netlibDGETRS('N', k, 1, G, k, r->woodburyPiv, T, k));
+
+	/* X = Y - Z*(M*T) */
+	for(b = 0; b < k; b++) {
+		E[b] = 0.0;
+		for(c = 0; c < k; c++) {
+			E[b] += M[b + k*c]*T[c];
+		}
+	}
+	for(b = 0; b < k; b++) {
+		for(i = 0; i < n; i++) {
+			r->X[i] -= Z[b*n + i]*E[b];
+		}
+	}
+
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static int matrixAssemble(matrix_ *r)
+{
+	int i;
 
-	/* Check out the SuperLU Header files and the SuperLU User's manual
-	 * to make sense of this mess...
+	/* The base holds everything that doesn't change from step to step, and
+	 * whatever the older devices have added to it, the dynamic stamps hold
+	 * full values rather than updates so nothing drifts over a long run.
+	 * Only B needs to be rebuilt if none of the values in A have changed.
 	 */
-	dgssvx(&p->control, &p->A, p->perm_c, p->perm_r, p->etree, &p->equed,
-			p->R, p->C, &p->L, &p->U, NULL, 0, &p->B, &p->X, &p->rpg,
-			&p->rcond, p->ferr, p->berr, &p->mem_usage, &p->stat, &p->info);
+	if(r->changed) {
+		memcpy(r->A, r->aBase, r->lenA*sizeof(double));
+	}
+	memcpy(r->B, r->bBase, r->lenXB*sizeof(double));
 
-	ReturnErrIf(p->info < 0, "SuperLU: %ith arg had illegal value", -p->info);
-	if(p->info > 0) {
-		ReturnErrIf((p->info <= p->A.ncol), "SuperLU: U is singular");
-		ReturnErrIf((p->info == (p->A.ncol + 1)),
-				"SuperLU: RCOND is singular to wokring precision");
-		ReturnErrIf((p->info > (p->A.ncol + 1)),
-				"SuperLU: memory allocation error");
+	for(i = 0; i < r->numDynamic; i++) {
+		stampAssemble(r->dynamic[i], r->A, r->B, r->changed);
 	}
 
 	return 0;
@@ -151,137 +237,243 @@ static int matrixSolveAgainSuperLU(matrix_ *r)
 
 /*---------------------------------------------------------------------------*/
 
-static int matrixUnconfigSuperLU(matrix_ *r)
+static int matrixCacheSwitch(matrix_ *r, int index)
 {
-	matrixLibrary_ *p;
+	matrixCacheEntry_ *entry = &r->cache[index];
 
-	ReturnErrIf(r == NULL);
-	p = r->library;
-	ReturnErrIf(p == NULL);
-
-	Debug("Unconfiguring Solution %p", r);
-
-	SUPERLU_FREE(p->perm_r);
-	SUPERLU_FREE(p->perm_c);
-	SUPERLU_FREE(p->etree);
-	SUPERLU_FREE(p->R);
-    SUPERLU_FREE(p->C);
-	SUPERLU_FREE(p->ferr);
-    SUPERLU_FREE(p->berr);
-	Destroy_CompCol_Matrix(&p->A);
-	/* Setting these to NULL keeps the matrix object from trying to free
-	 * them, as they were already freed by SuperLU.
+	r->cacheCurrent = index;
+	r->library = entry->library;
+	r->factored = entry->valid;
+	if(entry->valid) {
+		ReturnErrIf(matrixWoodburyReset(r, entry->A));
+	}
+
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static int matrixCacheFind(matrix_ *r)
+{
+	matrixCacheEntry_ *entry;
+	int i, lru;
+
+	/* For a linear circuit A only depends on the step size and integration
+	 * order so those are enough to find the factors, A is compared as well
+	 * so a nonlinear circuit can't pick up the wrong ones.
 	 */
-	r->A = NULL;
-	r->aRow = NULL;
-	r->aColStart = NULL;
-	Destroy_SuperMatrix_Store(&p->B);
-	r->B = NULL;
-	Destroy_SuperMatrix_Store(&p->X);
-	r->X = NULL;
-	StatFree(&p->stat);
-	if(!p->firstPass) {
-		Destroy_SuperNode_Matrix(&p->L);
-		Destroy_CompCol_Matrix(&p->U);
+	for(i = 0; i < r->cacheSize; i++) {
+		entry = &r->cache[i];
+		if(entry->valid && (entry->step == r->cacheStep) &&
+				(entry->order == r->cacheOrder) &&
+				!memcmp(entry->A, r->A, r->lenA*sizeof(double))) {
+			ReturnErrIf(matrixCacheSwitch(r, i));
+			entry->used = ++r->cacheClock;
+			r->changed = 0;
+			return 0;
+		}
+	}
+
+	/* Keep refactoring the same entry while iterating on one step */
+	entry = &r->cache[r->cacheCurrent];
+	if(!entry->valid || ((entry->step == r->cacheStep) &&
+			(entry->order == r->cacheOrder))) {
+		return 0;
 	}
+
+	lru = 0;
+	for(i = 1; i < r->cacheSize; i++) {
+		if(!r->cache[lru].valid) {
+			break;
+		} else if(!r->cache[i].valid ||
+				(r->cache[i].used < r->cache[lru].used)) {
+			lru = i;
+		}
+	}
+	ReturnErrIf(matrixCacheSwitch(r, lru));
+
 	return 0;
 }
 
 /*---------------------------------------------------------------------------*/
 
-static int matrixInitializeSuperLU(matrix_ *r, control_ *control)
+static int matrixCacheStore(matrix_ *r)
 {
-	matrixLibrary_ *p;
+	matrixCacheEntry_ *entry = &r->cache[r->cacheCurrent];
 
-	ReturnErrIf(r == NULL);
-	ReturnErrIf(r->library != NULL);
+	memcpy(entry->A, r->A, r->lenA*sizeof(double));
+	entry->step = r->cacheStep;
+	entry->order = r->cacheOrder;
+	entry->valid = 1;
+	entry->used = ++r->cacheClock;
 
-	Debug("Configuring Solution %p", r);
+	return 0;
+}
 
-	r->name = matrixNameSuperLU;
-	r->unconfig = matrixUnconfigSuperLU;
-	r->solve = matrixSolveSuperLU;
-	r->solveAgain = matrixSolveAgainSuperLU;
+/*---------------------------------------------------------------------------*/
 
-	r->library = calloc(1, sizeof(matrixLibrary_));
-	ReturnErrIf(r->library == NULL);
+static int matrixSolveAssembled(matrix_ *r)
+{
+	int unstable;
+
+	if((r->cacheSize > 0) && r->changed) {
+		ReturnErrIf(matrixCacheFind(r));
+	}
 
-	p = r->library;
-
-	/* Create solution A in the format expected by SuperLU. */
-	dCreate_CompCol_Matrix(&p->A, r->lenXB, r->lenXB, r->lenA, r->A,
-			r->aRow, r->aColStart, SLU_NC, SLU_D, SLU_GE);
-
-	/* Create right-hand solution matrix X. */
-	dCreate_Dense_Matrix(&p->B, r->lenXB, 1, r->B, r->lenXB,
-			SLU_DN, SLU_D, SLU_GE);
-
-	dCreate_Dense_Matrix(&p->X, r->lenXB, 1, r->X, r->lenXB,
-			SLU_DN, SLU_D, SLU_GE);
-
-	/* Create permitation matrices. */
-	p->perm_r = intMalloc(r->lenXB);
-	ReturnErrIf(p->perm_r == NULL);
-	p->perm_c = intMalloc(r->lenXB);
-	ReturnErrIf(p->perm_r == NULL);
-	p->etree = intMalloc(r->lenXB);
-	ReturnErrIf(p->etree == NULL);
-	p->R = (double *) SUPERLU_MALLOC(p->A.nrow * sizeof(double));
-	ReturnErrIf(p->R == NULL);
-	p->C = (double *) SUPERLU_MALLOC(p->A.ncol * sizeof(double));
-	ReturnErrIf(p->C == NULL);
-	p->ferr = (double *) SUPERLU_MALLOC(1 * sizeof(double));
-	ReturnErrIf(p->ferr == NULL);
-	p->berr = (double *) SUPERLU_MALLOC(1 * sizeof(double));
-	ReturnErrIf(p->berr == NULL);
-
-	/* Set the default input control. */
-	/* TODO: Make these configurable with an control command */
-	p->control.Fact = DOFACT;
-	p->control.Equil = NO;
-	p->control.ColPerm = COLAMD;
-	p->control.Trans = NOTRANS;
-	p->control.IterRefine = NOREFINE;
-	p->control.PrintStat = NO;
-	p->control.SymmetricMode = NO;
-	p->control.DiagPivotThresh = 1.0;
-	p->control.PivotGrowth = NO;
-	p->control.ConditionNumber = NO;
-
-	/* Initialize the statistics variables. */
-    StatInit(&p->stat);
-
-	/* Ready for first pass (used to know when to free the LU Matrices) */
-	p->firstPass = -1;
+	/* The pattern of A never changes once it's been built so after the
+	 * first factorization only the numeric values need to be updated,
+	 * unless the old pivot order is no longer stable. If A hasn't changed
+	 * at all the old factors can be used as is, if only a few rows and
+	 * columns have changed the old factors can be updated.
+	 */
+	if(r->factored && r->changed && (r->woodburyRank > 0)) {
+		unstable = matrixSolveWoodbury(r);
+		ReturnErrIf(unstable < 0);
+		if(!unstable) {
+			r->substituteCount++;
+			r->chordDelta = 0.0;
+			return 0;
+		}
+	}
+
+	if(!r->factored || (r->changed && (r->class->refactor == NULL))) {
+		ReturnErrIf(matrixFactor(r));
+	} else if(!r->changed) {
+		r->substituteCount++;
+	} else {
+		unstable = r->class->refactor(r);
+		ReturnErrIf(unstable < 0);
+		if(unstable) {
+			ReturnErrIf(matrixFactor(r));
+		} else {
+			r->refactorCount++;
+			ReturnErrIf(matrixWoodburyReset(r, r->A));
+		}
+	}
+	if((r->cacheSize > 0) && r->changed) {
+		ReturnErrIf(matrixCacheStore(r));
+	}
+	r->changed = 0;
+	r->chordDelta = 0.0;
+
+	unstable = matrixSubstitute(r);
+	ReturnErrIf(unstable < 0);
+	if(unstable) {
+		ReturnErrIf(matrixFactor(r));
+		ReturnErrIf(matrixSubstitute(r));
+	}
 
 	return 0;
 }
 
-/*===========================================================================
- |                            Solve Ab=x for b                               |
-  ===========================================================================*/
+/*---------------------------------------------------------------------------*/
 
 int matrixSolve(matrix_ *r)
 {
 	ReturnErrIf(r == NULL);
-	ReturnErrIf(r->solve == NULL);
-	ReturnErrIf(r->solve(r));
+	ReturnErrIf(r->class == NULL);
+	ReturnErrIf(r->library == NULL);
+
+	ReturnErrIf(matrixAssemble(r));
+	ReturnErrIf(matrixSolveAssembled(r));
+
 	return 0;
 }
 
 /*---------------------------------------------------------------------------*/
 
+int matrixSetStep(matrix_ *r, double step, int order)
+{
+	ReturnErrIf(r == NULL);
+	r->cacheStep = step;
+	r->cacheOrder = order;
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static double matrixChordDelta(matrix_ *r)
+{
+	double delta = 0.0;
+	int i;
+
+	for(i = 0; i < r->lenXB; i++) {
+		if(fabs(r->X[i] - r->chordX[i]) > delta) {
+			delta = fabs(r->X[i] - r->chordX[i]);
+		}
+	}
+
+	return delta;
+}
+
+/*---------------------------------------------------------------------------*/
+
 int matrixSolveAgain(matrix_ *r)
 {
+	double *B, delta;
+	int i, j;
+
 	ReturnErrIf(r == NULL);
-	ReturnErrIf(r->solveAgain == NULL);
-	if(r->solveAgain != NULL) {
-		ReturnErrIf(r->solveAgain(r));
-	} else if(r->solve != NULL) {
-		ReturnErrIf(r->solve(r));
-	} else {
-		ReturnErr("No solve function defined");
+	ReturnErrIf(r->class == NULL);
+	ReturnErrIf(r->library == NULL);
+
+	ReturnErrIf(matrixAssemble(r));
+
+	if(!r->chord) {
+		ReturnErrIf(matrixSolveAssembled(r));
+		return 0;
+	}
+
+	memcpy(r->chordX, r->X, r->lenXB*sizeof(double));
+
+	/* Refactor when there's nothing to gain from the old factors or the
+	 * last chord iteration didn't shrink the update enough, the update from
+	 * a full Newton iteration is the reference for the chord iterations
+	 * that follow it.
+	 */
+	if(!r->factored || !r->changed || r->chordSlow) {
+		ReturnErrIf(matrixSolveAssembled(r));
+		r->chordSlow = 0;
+		r->chordDelta = matrixChordDelta(r);
+		return 0;
+	}
+
+	/* Chord Iteration, X = X + inv(Aold)*(B - A*X)
+	 * The residual is solved in place of B using the old factors, A is left
+	 * marked as changed so the next matrixSolve will refactor.
+	 */
+	memcpy(r->chordR, r->B, r->lenXB*sizeof(double));
+	for(j = 0; j < r->lenXB; j++) {
+		for(i = r->aColStart[j]; i < r->aColStart[j+1]; i++) {
+			r->chordR[r->aRow[i]] -= r->A[i]*r->chordX[j];
+		}
 	}
+
+	B = r->B;
+	r->B = r->chordR;
+	i = matrixSubstitute(r);
+	r->B = B;
+	ReturnErrIf(i < 0);
+	if(i) {
+		ReturnErrIf(matrixSolveAssembled(r));
+		r->chordSlow = 0;
+		r->chordDelta = matrixChordDelta(r);
+		return 0;
+	}
+
+	for(i = 0; i < r->lenXB; i++) {
+		r->X[i] += r->chordX[i];
+	}
+	r->substituteCount++;
+
+	delta = matrixChordDelta(r);
+	if((r->chordDelta > 0.0) && (delta > r->chordRate*r->chordDelta)) {
+		Debug("Chord iteration converging slowly, %e -> %e", r->chordDelta,
+				delta);
+		r->chordSlow = 1;
+	}
+	r->chordDelta = delta;
+
 	return 0;
 }
 
@@ -289,10 +481,62 @@ int matrixSolveAgain(matrix_ *r)
  |                             Build Matrix A                                |
   ===========================================================================*/
 
+static unsigned int matrixNodeHash(int row, int col)
+{
+	unsigned int hash;
+	hash = ((unsigned int)row*2654435761u) ^ ((unsigned int)col*40503u);
+	return hash ^ (hash >> 16);
+}
+
+/*---------------------------------------------------------------------------*/
+
+static matrixNodeEntry_ * matrixNodeFind(matrixNodeEntry_ *table,
+		unsigned int size, int row, int col)
+{
+	unsigned int i;
+
+	/* Linear probing, returns the empty entry if the node isn't there */
+	i = matrixNodeHash(row, col) & (size - 1);
+	while((table[i].node != NULL) &&
+			((table[i].row != row) || (table[i].col != col))) {
+		i = (i + 1) & (size - 1);
+	}
+
+	return &table[i];
+}
+
+/*---------------------------------------------------------------------------*/
+
+static int matrixNodeTableGrow(matrix_ *r)
+{
+	matrixNodeEntry_ *table, *entry;
+	unsigned int size, i;
+
+	size = 2*r->nodeTableSize;
+	table = calloc(size, sizeof(matrixNodeEntry_));
+	ReturnErrIf(table == NULL);
+
+	for(i = 0; i < r->nodeTableSize; i++) {
+		if(r->nodeTable[i].node != NULL) {
+			entry = matrixNodeFind(table, size, r->nodeTable[i].row,
+					r->nodeTable[i].col);
+			*entry = r->nodeTable[i];
+		}
+	}
+
+	free(r->nodeTable);
+	r->nodeTable = table;
+	r->nodeTableSize = size;
+
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
 node_ * matrixFindOrAddNode(matrix_ *r, row_ *row, row_ *col)
 {
+	matrixNodeEntry_ *entry;
 	nodeIndex_ index;
-	node_ *node;
 	ReturnNULLIf(r == NULL);
 	ReturnNULLIf(row == NULL);
 	ReturnNULLIf(col == NULL);
@@ -306,16 +550,55 @@ node_ * matrixFindOrAddNode(matrix_ *r, row_ *row, row_ *col)
 	index.col = rowGetIndex(col);
 	ReturnNULLIf(index.col < 0);
 
-	ReturnNULLIf(listFind(r->nodes, (void*)&index, (listFind_)nodeCompare,
-			(void*)&node));
+	/* Keep the table at most half full */
+	if(2*(r->nodeTableCount + 1) > r->nodeTableSize) {
+		ReturnNULLIf(matrixNodeTableGrow(r));
+	}
 
-	/* If can't find the node then create it */
-	if(node == NULL) {
-		node = nodeNew(index);
-		ReturnNULLIf(listAdd(r->nodes, node, (listAdd_)nodeAdd));
+	entry = matrixNodeFind(r->nodeTable, r->nodeTableSize, index.row,
+			index.col);
+
+	/* If can't find the node then create it, the nodes are sorted into
+	 * column order when the matrix is initialized */
+	if(entry->node == NULL) {
+		entry->node = nodeNew(index);
+		ReturnNULLIf(entry->node == NULL);
+		ReturnNULLIf(listAdd(r->nodes, entry->node, NULL));
+		entry->row = index.row;
+		entry->col = index.col;
+		r->nodeTableCount++;
 	}
 
-	return node;
+	return entry->node;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static char * matrixRowKey(matrix_ *r, rowName_ *name)
+{
+	int length;
+
+	/* The key is the full row name, i.e. v(xxx) or i(xxx) */
+	length = strlen(name->name) + 4;
+	if(length > r->rowKeyLength) {
+		free(r->rowKey);
+		r->rowKey = malloc(length);
+		ReturnNULLIf(r->rowKey == NULL);
+		r->rowKeyLength = length;
+	}
+
+	if(name->type == 0x0) {
+		strcpy(r->rowKey, name->name);
+		if(r->rowKey[0] == 'V') {
+			r->rowKey[0] = 'v';
+		} else if(r->rowKey[0] == 'I') {
+			r->rowKey[0] = 'i';
+		}
+	} else {
+		sprintf(r->rowKey, "%c(%s)", name->type, name->name);
+	}
+
+	return r->rowKey;
 }
 
 /*---------------------------------------------------------------------------*/
@@ -324,6 +607,7 @@ row_ * matrixFindOrAddRow(matrix_ *r, char rowType, char *rowName)
 {
 	rowName_ name;
 	row_ *row;
+	char *key;
 	int index;
 	ReturnNULLIf(r == NULL);
 	ReturnNULLIf(rowName == NULL);
@@ -331,26 +615,178 @@ row_ * matrixFindOrAddRow(matrix_ *r, char rowType, char *rowName)
 	name.type = rowType;
 	name.name = rowName;
 
-	ReturnNULLIf(listFind(r->rows, (void*)&name, (listFind_)rowCompare,
-			(void*)&row));
+	key = matrixRowKey(r, &name);
+	ReturnNULLIf(key == NULL);
+
+	ReturnNULLIf(hashFind(r->rowHash, key, (void*)&row));
 
 	/* If can't find the row then create it */
 	if(row == NULL) {
 		index = listLength(r->rows);
 		ReturnNULLIf(index < 0);
 		row = rowNew(name, index);
+		ReturnNULLIf(row == NULL);
 		ReturnNULLIf(listAdd(r->rows, row, NULL));
+		ReturnNULLIf(hashAdd(r->rowHash, rowGetName(row), row));
 	}
 
 	return row;
 }
 
+stamp_ * matrixAddStamp(matrix_ *r, int numNodes, node_ *nodes[],
+		int numRows, row_ *rows[], int dynamic)
+{
+	stamp_ *stamp;
+	ReturnNULLIf(r == NULL);
+	ReturnNULLIf(r->A != NULL);
+
+	stamp = stampNew(numNodes, nodes, numRows, rows, dynamic);
+	ReturnNULLIf(stamp == NULL);
+	ReturnNULLIf(listAdd(r->stamps, stamp, NULL));
+
+	return stamp;
+}
+
 /*===========================================================================
  |                          Store Data Control                               |
   ===========================================================================*/
 
+/* Looks up the saved variables and sets the results history up to keep
+ * only their rows.
+ */
+static int matrixSaveInitialize(matrix_ *r)
+{
+	int *rows, i;
+
+	if(r->saveNames == NULL) {
+		ReturnErrIf(historyInitialize(r->history, r->lenXB, NULL, 0));
+		r->saveChanged = 0;
+		return 0;
+	}
+
+	rows = malloc((r->numSaves + 1) * sizeof(int));
+	ReturnErrIf(rows == NULL, "Malloc Failed");
+
+	for(i = 0; i < r->numSaves; i++) {
+		r->saveRows[i] = NULL;
+		if(hashFind(r->rowHash, r->saveNames[i], (void*)&r->saveRows[i]) ||
+				(r->saveRows[i] == NULL) || (r->saveRows[i] == &gndRow)) {
+			free(rows);
+			ReturnErr("Can't save %s, it isn't a variable in this circuit",
+					r->saveNames[i]);
+		}
+		rows[i] = rowGetIndex(r->saveRows[i]);
+	}
+
+	if(historyInitialize(r->history, r->lenXB, rows, r->numSaves)) {
+		free(rows);
+		ReturnErr("Failed to set up the saved variables");
+	}
+
+	free(rows);
+	r->saveChanged = 0;
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Saves variable (i.e. v(1) or i(Vx)) in the results, once one has been
+ * saved only the ones that are saved are returned. NULL goes back to
+ * saving everything.
+ */
+int matrixSave(matrix_ *r, char *variable)
+{
+	char **names;
+	row_ **rows;
+	int i;
+
+	ReturnErrIf(r == NULL);
+
+	if(variable == NULL) {
+		for(i = 0; i < r->numSaves; i++) {
+			free(r->saveNames[i]);
+		}
+		if(r->saveNames != NULL) {
+			free(r->saveNames);
+			free(r->saveRows);
+		}
+		r->saveNames = NULL;
+		r->saveRows = NULL;
+		r->numSaves = 0;
+		r->saveChanged = 1;
+		return 0;
+	}
+
+	/* Saving something twice doesn't change anything */
+	for(i = 0; i < r->numSaves; i++) {
+		if(!strcmp(&r->saveNames[i][1], &variable[1]) &&
+				(r->saveNames[i][0] == tolower(variable[0]))) {
+			return 0;
+		}
+	}
+
+	names = realloc(r->saveNames, (r->numSaves + 1) * sizeof(char*));
+	ReturnErrIf(names == NULL, "Malloc Failed");
+	r->saveNames = names;
+	rows = realloc(r->saveRows, (r->numSaves + 1) * sizeof(row_*));
+	ReturnErrIf(rows == NULL, "Malloc Failed");
+	r->saveRows = rows;
+
+	r->saveNames[r->numSaves] = malloc(strlen(variable) + 1);
+	ReturnErrIf(r->saveNames[r->numSaves] == NULL, "Malloc Failed");
+	strcpy(r->saveNames[r->numSaves], variable);
+	if(r->saveNames[r->numSaves][0] == 'V') {
+		r->saveNames[r->numSaves][0] = 'v';
+	} else if(r->saveNames[r->numSaves][0] == 'I') {
+		r->saveNames[r->numSaves][0] = 'i';
+	}
+	r->saveRows[r->numSaves] = NULL;
+	r->numSaves++;
+	r->saveChanged = 1;
+
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Devices that look back in time (i.e. transmission lines) ask for the
+ * rows they need to be kept whether or not they're saved, and how far
+ * back they look (NULL if there's no limit). It's a pointer so it's read
+ * when the simulator is (re)started.
+ */
+int matrixRequireRow(matrix_ *r, row_ *row, double *lookBack)
+{
+	int *required;
+	double **lookBacks;
+
+	ReturnErrIf(r == NULL);
+	ReturnErrIf(row == NULL);
+	ReturnErrIf(r->A != NULL, "Rows have to be required before the "
+			"matrix is initialized");
+
+	if(row == &gndRow) {
+		return 0;
+	}
+
+	required = realloc(r->required, (r->numRequired + 1) * sizeof(int));
+	ReturnErrIf(required == NULL, "Malloc Failed");
+	r->required = required;
+	lookBacks = realloc(r->lookBacks, (r->numRequired + 1) * sizeof(double*));
+	ReturnErrIf(lookBacks == NULL, "Malloc Failed");
+	r->lookBacks = lookBacks;
+	r->required[r->numRequired] = rowGetIndex(row);
+	r->lookBacks[r->numRequired] = lookBack;
+	r->numRequired++;
+
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
 int matrixClear(matrix_ *r)
 {
+	double window;
+	int i;
 	ReturnErrIf(r == NULL);
 
 	Debug("Clearing Matrix");
@@ -358,10 +794,59 @@ int matrixClear(matrix_ *r)
 	memset(r->A, 0x0, sizeof(double)*r->lenA);
 	memset(r->X, 0x0, sizeof(double)*r->lenXB);
 	memset(r->B, 0x0, sizeof(double)*r->lenXB);
+	memset(r->aBase, 0x0, sizeof(double)*r->lenA);
+	memset(r->bBase, 0x0, sizeof(double)*r->lenXB);
+	for(i = 0; i < r->numDynamic; i++) {
+		ReturnErrIf(stampClear(r->dynamic[i]));
+	}
+	r->changed = 1;
+	r->cacheStep = 0.0;
+	r->cacheOrder = 0;
+	r->predictCount = 0;
+	r->predictOrder = 0;
+
+	/* Clear History */
+	if(r->saveChanged) {
+		ReturnErrIf(matrixSaveInitialize(r));
+	}
+	ReturnErrIf(historyClear(r->history));
+	ReturnErrIf(historyClear(r->internal));
+
+	/* The internal history only has to go back as far as the device that
+	 * looks back the furthest
+	 */
+	window = 0.0;
+	for(i = 0; i < r->numRequired; i++) {
+		if(r->lookBacks[i] == NULL) {
+			window = HUGE_VAL;
+		} else if(*r->lookBacks[i] > window) {
+			window = *r->lookBacks[i];
+		}
+	}
+	ReturnErrIf(historyRetain(r->internal, window));
+
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* The predictor only uses the points after the last break-point, the
+ * waveforms aren't smooth across one and the currents at the break-point
+ * itself still belong to the step before it.
+ */
+static int matrixPredictRecord(matrix_ *r, double time, unsigned int flag)
+{
+	if(flag & HISTORY_FLAG_BRKPOINT) {
+		r->predictCount = 0;
+		return 0;
+	}
 
-	/* Clear History List */
-	if(r->history != NULL) {
-		ReturnErrIf(listClear(r->history, (listDestroy_)historyDestroy));
+	r->predictHead = (r->predictHead + 1) % MATRIX_PREDICT_POINTS;
+	r->predictT[r->predictHead] = time;
+	memcpy(&r->predictPast[r->predictHead*r->lenXB], r->X,
+			r->lenXB*sizeof(double));
+	if(r->predictCount < MATRIX_PREDICT_POINTS) {
+		r->predictCount++;
 	}
 
 	return 0;
@@ -372,8 +857,14 @@ int matrixClear(matrix_ *r)
 int matrixRecord(matrix_ *r, double time, unsigned int flag)
 {
 	ReturnErrIf(r == NULL);
-	ReturnErrIf(listAdd(r->history,
-			historyNew(time, r->X, r->lenXB, flag), NULL));
+	ReturnErrIf(historyRecord(r->history, time, r->X, flag));
+	if(r->numRequired > 0) {
+		ReturnErrIf(historyRecord(r->internal, time, r->X, flag));
+	}
+	memcpy(r->XLast, r->X, r->lenXB*sizeof(double));
+	if(r->predict) {
+		ReturnErrIf(matrixPredictRecord(r, time, flag));
+	}
 	if(flag & HISTORY_FLAG_END) {
 		Debug("Last matrix record");
 	}
@@ -384,37 +875,201 @@ int matrixRecord(matrix_ *r, double time, unsigned int flag)
 
 int matrixRecall(matrix_ *r)
 {
-	history_ *history;
 	ReturnErrIf(r == NULL);
-	ReturnErrIf(listGetLast(r->history, (void*)&history));
-	ReturnErrIf(historyRecall(history, r->X, r->lenXB));
+	memcpy(r->X, r->XLast, r->lenXB*sizeof(double));
 	return 0;
 }
 
 /*---------------------------------------------------------------------------*/
 
-list_ * matrixGetHistory(matrix_ *r)
+/* Replaces X with the polynomial through the last order + 1 accepted points
+ * evaluated at time, the Newton iterations for the next step start from
+ * there instead of from the last point. Without enough points X is left
+ * at the last point.
+ */
+int matrixPredict(matrix_ *r, double time, int order)
 {
-	ReturnNULLIf(r == NULL);
-	return r->history;
+	double w[MATRIX_PREDICT_POINTS], tj;
+	int i, j, m, slot;
+
+	ReturnErrIf(r == NULL);
+	ReturnErrIf(!r->predict);
+
+	r->predictOrder = (order < r->predictCount - 1) ?
+			order : r->predictCount - 1;
+	if(r->predictOrder < 1) {
+		r->predictOrder = 0;
+		memcpy(r->predictX, r->X, r->lenXB*sizeof(double));
+		return 0;
+	}
+	r->predictTime = time;
+
+	/* Lagrange weights, point 0 is the newest */
+	for(j = 0; j <= r->predictOrder; j++) {
+		tj = r->predictT[(r->predictHead + MATRIX_PREDICT_POINTS - j) %
+				MATRIX_PREDICT_POINTS];
+		w[j] = 1.0;
+		for(m = 0; m <= r->predictOrder; m++) {
+			if(m != j) {
+				w[j] *= (time - r->predictT[(r->predictHead +
+						MATRIX_PREDICT_POINTS - m) % MATRIX_PREDICT_POINTS]) /
+						(tj - r->predictT[(r->predictHead +
+						MATRIX_PREDICT_POINTS - m) % MATRIX_PREDICT_POINTS]);
+			}
+		}
+	}
+
+	memset(r->X, 0x0, r->lenXB*sizeof(double));
+	for(j = 0; j <= r->predictOrder; j++) {
+		slot = (r->predictHead + MATRIX_PREDICT_POINTS - j) %
+				MATRIX_PREDICT_POINTS;
+		for(i = 0; i < r->lenXB; i++) {
+			r->X[i] += w[j] * r->predictPast[slot*r->lenXB + i];
+		}
+	}
+	memcpy(r->predictX, r->X, r->lenXB*sizeof(double));
+
+	return 0;
 }
 
 /*---------------------------------------------------------------------------*/
 
-static int matrixFillData(history_ *history, double *data[])
+/* The solution is within tolerance of the point the devices were
+ * linearized about, i.e. the prediction was already the answer.
+ */
+int matrixPredictConverged(matrix_ *r, control_ *control)
 {
-	int length;
+	double tol;
+	int i;
+
+	ReturnErrIf(r == NULL);
+	ReturnErrIf(control == NULL);
+	ReturnErrIf(!r->predict);
+
+	for(i = 0; i < r->lenXB; i++) {
+		tol = control->reltol * MaxAbs(r->X[i], r->predictX[i]) +
+				((r->units[i] == 'V') ? control->vntol : control->abstol);
+		if(!(fabs(r->X[i] - r->predictX[i]) <= tol)) {
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Local truncation error from the difference between the converged
+ * solution and the prediction (Milne's estimate). With a predictor and
+ * corrector of the same order k,
+ *
+ *	Xpredicted - Xtrue = -P * x^(k+1)
+ *	Xcorrected - Xtrue =  C * h^(k+1) * x^(k+1)
+ *
+ * where P = prod(t - tj)/(k+1)! comes from the extrapolation and C is the
+ * error constant of the integration method, so LTE = C*h^(k+1) *
+ * (Xcorrected - Xpredicted) / (P + C*h^(k+1)). nextStep is lowered to the
+ * step that would bring the worst entry to within trtol of its tolerance.
+ */
+int matrixPredictStep(matrix_ *r, control_ *control, double step, int order,
+		double *nextStep)
+{
+	double P, C, e, tol, lte, worst = 0.0;
+	int i, j;
+
+	ReturnErrIf(r == NULL);
+	ReturnErrIf(control == NULL);
+	ReturnErrIf(nextStep == NULL);
+	ReturnErrIf(!r->predict);
+
+	/* Only compare like with like */
+	if((r->predictOrder < 1) || (r->predictOrder != order)) {
+		return 0;
+	}
+
+	P = 1.0;
+	for(j = 0; j <= order; j++) {
+		P *= fabs(r->predictTime - r->predictT[(r->predictHead +
+				MATRIX_PREDICT_POINTS - j) % MATRIX_PREDICT_POINTS]) / (j + 1);
+	}
+
+	C = integratorErrorConstant(control, order) * pow(step, order + 1);
+
+	/* Only node voltages, branch currents are algebraic and can jump */
+	for(i = 0; i < r->lenXB; i++) {
+		if(r->units[i] != 'V') {
+			continue;
+		}
+		e = fabs(r->X[i] - r->predictX[i]);
+		tol = control->reltol * MaxAbs(r->X[i], r->predictX[i]) +
+				control->vntol;
+		lte = C * e / (P + C);
+		if(lte > worst * tol) {
+			worst = lte / tol;
+		}
+	}
+
+	if(worst > 0.0) {
+		e = step * pow(control->trtol / worst, 1.0 / (order + 1));
+		Debug("Predictor step %e (%e)", e, *nextStep);
+		if(e < *nextStep) {
+			*nextStep = e;
+		}
+	}
+
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+int matrixGetStats(matrix_ *r, int *factorizations, int *refactorizations,
+		int *substitutions)
+{
+	ReturnErrIf(r == NULL);
+	if(factorizations != NULL)
+		*factorizations = r->factorCount;
+	if(refactorizations != NULL)
+		*refactorizations = r->refactorCount;
+	if(substitutions != NULL)
+		*substitutions = r->substituteCount;
+	return 0;
+}
 
-	length = historyGetLength(history) + 1;
-	ReturnErrIf(length < 1);
-	ReturnErrIf(historyGetAllData(history, *data, length));
-	(*data) += length;
+/*---------------------------------------------------------------------------*/
 
+int matrixGetBlocks(matrix_ *r, int *numBlocks, int *maxBlock)
+{
+	ReturnErrIf(r == NULL);
+	if(numBlocks != NULL)
+		*numBlocks = r->numBlocks;
+	if(maxBlock != NULL)
+		*maxBlock = r->maxBlock;
 	return 0;
 }
 
 /*---------------------------------------------------------------------------*/
 
+int matrixGetSymbolicStats(int *hits, int *misses)
+{
+	ReturnErrIf(matrixSymbolicLock());
+	if(hits != NULL)
+		*hits = matrixSymbolicHits;
+	if(misses != NULL)
+		*misses = matrixSymbolicMisses;
+	ReturnErrIf(matrixSymbolicUnlock());
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+history_ * matrixGetHistory(matrix_ *r)
+{
+	ReturnNULLIf(r == NULL);
+	return r->internal;
+}
+
+/*---------------------------------------------------------------------------*/
+
 static int matrixGetVariables(row_ *row, char **variables[])
 {
 	if(row != &gndRow) {
@@ -427,34 +1082,24 @@ static int matrixGetVariables(row_ *row, char **variables[])
 
 /*---------------------------------------------------------------------------*/
 
+/* The caller gets the history's own buffer rather than a copy of it */
 int matrixGetSolution(matrix_ *r, double *data[], char **variables[],
 		int *numPoints, int *numVariables)
 {
-	double *dataPtr;
 	char **variablePtr;
-
-	/* TODO: This seems like a waste to processing time, especially
-		if there are a lot of variables and data points but the
-		data is a linked list, and has to be passed back to the
-		caller as an array. (though maybe that can be looked at).
-		Another option would be to guess what the number of points
-		will be and store into an array instead of a linked list.
-	*/
+	int i;
 
 	ReturnErrIf(r == NULL);
 
-	*numVariables = listLength(r->rows);
-	ReturnErrIf(numVariables < 0);
-
-	*numPoints = listLength(r->history);
-	ReturnErrIf(numPoints < 0);
-
-	*data = malloc((*numPoints) * (*numVariables) * sizeof(double));
-	ReturnErrIf(*data == NULL);
+	if(r->saveNames != NULL) {
+		*numVariables = r->numSaves + 1;
+	} else {
+		*numVariables = listLength(r->rows);
+	}
+	ReturnErrIf(*numVariables < 0);
 
-	dataPtr = *data;
-	ReturnErrIf(listExecute(r->history, (listExecute_)matrixFillData,
-					(void*)&dataPtr));
+	/* The history is already laid out the way the caller wants it */
+	ReturnErrIf(historyTakeData(r->history, data, numPoints));
 
 	*variables = malloc((*numVariables + 1) * sizeof(char*));
 	ReturnErrIf(*variables == NULL);
@@ -462,13 +1107,145 @@ int matrixGetSolution(matrix_ *r, double *data[], char **variables[],
 	variablePtr = *variables;
 	*variablePtr = "time";
 	variablePtr++;
-	ReturnErrIf(listExecute(r->rows, (listExecute_)matrixGetVariables,
-					(void*)&variablePtr));
+	if(r->saveNames != NULL) {
+		for(i = 0; i < r->numSaves; i++) {
+			*variablePtr = rowGetName(r->saveRows[i]);
+			ReturnErrIf(*variablePtr == NULL);
+			variablePtr++;
+		}
+	} else {
+		ReturnErrIf(listExecute(r->rows, (listExecute_)matrixGetVariables,
+						(void*)&variablePtr));
+	}
 	*variablePtr = NULL;
 
 	return 0;
 }
 
+/*===========================================================================
+ |                          Symbolic Analysis Cache                          |
+  ===========================================================================*/
+
+/* 64 bit FNV-1a hash of the bytes of the pattern of A */
+static unsigned long long matrixFingerprintBytes(unsigned long long hash,
+		int *data, int length)
+{
+	unsigned char *byte = (unsigned char*)data;
+	size_t i;
+
+	for(i = 0; i < length*sizeof(int); i++) {
+		hash = (hash ^ byte[i]) * 1099511628211ULL;
+	}
+
+	return hash;
+}
+
+static unsigned long long matrixFingerprint(matrix_ *r)
+{
+	unsigned long long hash = 14695981039346656037ULL;
+
+	hash = matrixFingerprintBytes(hash, r->aColStart, r->lenXB + 1);
+	hash = matrixFingerprintBytes(hash, r->aRow, r->lenA);
+
+	return hash;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* The table is shared by every simulator in the process, so it has to be
+ * locked from before an entry is found until the caller is done with it,
+ * another thread could replace the entry in the meantime.
+ */
+int matrixSymbolicLock()
+{
+	ReturnErrIf(pthread_mutex_lock(&matrixSymbolicMutex));
+	return 0;
+}
+
+int matrixSymbolicUnlock()
+{
+	ReturnErrIf(pthread_mutex_unlock(&matrixSymbolicMutex));
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* The fingerprint only narrows it down, the pattern has to match exactly */
+matrixSymbolic_ * matrixSymbolicFind(matrix_ *r)
+{
+	matrixSymbolic_ *s;
+	int i;
+	ReturnNULLIf(r == NULL);
+
+	for(i = 0; i < MATRIX_SYMBOLIC_MAX; i++) {
+		s = &matrixSymbolic[i];
+		if((s->used != 0) && (s->fingerprint == r->fingerprint) &&
+				(s->lenXB == r->lenXB) && (s->lenA == r->lenA) &&
+				!memcmp(s->aColStart, r->aColStart,
+						(r->lenXB + 1)*sizeof(int)) &&
+				!memcmp(s->aRow, r->aRow, r->lenA*sizeof(int))) {
+			s->used = ++matrixSymbolicClock;
+			return s;
+		}
+	}
+
+	return NULL;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Returns the entry for the pattern of r, replacing the least recently
+ * used entry if it's not already there. A new entry only knows the size
+ * of the pattern, the rest is filled in as it's found.
+ */
+matrixSymbolic_ * matrixSymbolicAdd(matrix_ *r)
+{
+	matrixSymbolic_ *s;
+	int i;
+	ReturnNULLIf(r == NULL);
+
+	s = matrixSymbolicFind(r);
+	if(s != NULL) {
+		return s;
+	}
+
+	s = &matrixSymbolic[0];
+	for(i = 1; i < MATRIX_SYMBOLIC_MAX; i++) {
+		if(matrixSymbolic[i].used < s->used) {
+			s = &matrixSymbolic[i];
+		}
+	}
+
+	if(s->superluPermC != NULL)
+		free(s->superluPermC);
+	if(s->cktluPs != NULL)
+		free(s->cktluPs);
+	if(s->cktluQ != NULL)
+		free(s->cktluQ);
+	if(s->cktluR != NULL)
+		free(s->cktluR);
+	if(s->aColStart != NULL)
+		free(s->aColStart);
+	if(s->aRow != NULL)
+		free(s->aRow);
+	memset(s, 0, sizeof(matrixSymbolic_));
+
+	s->aColStart = malloc((r->lenXB + 1)*sizeof(int));
+	ReturnNULLIf(s->aColStart == NULL);
+	memcpy(s->aColStart, r->aColStart, (r->lenXB + 1)*sizeof(int));
+	s->aRow = malloc((r->lenA + 1)*sizeof(int));
+	ReturnNULLIf(s->aRow == NULL);
+	memcpy(s->aRow, r->aRow, r->lenA*sizeof(int));
+
+	s->fingerprint = r->fingerprint;
+	s->lenXB = r->lenXB;
+	s->lenA = r->lenA;
+	s->superluOrdering = -1;
+	s->used = ++matrixSymbolicClock;
+
+	return s;
+}
+
 /*===========================================================================
  |                               Initialize                                  |
   ===========================================================================*/
@@ -478,9 +1255,12 @@ static int matrixInitializeRows(row_ *row, matrix_ *r)
 	ReturnErrIf(row == NULL);
 
 	/* Trying to set the gnd row will raise a flag and we can exit */
-	if(rowSetRHSPtr(row, &r->B[r->index]))
+	if(rowSetRHSPtr(row, &r->bBase[r->index]))
 		return 0;
 	ReturnErrIf(rowSetSolutionPtr(row, &r->X[r->index]));
+	if(r->units != NULL) {
+		r->units[r->index] = (rowGetName(row)[0] == 'i') ? 'A' : 'V';
+	}
 	r->index++;
 
 	return 0;
@@ -488,13 +1268,34 @@ static int matrixInitializeRows(row_ *row, matrix_ *r)
 
 /*---------------------------------------------------------------------------*/
 
+static int matrixGetNodes(node_ *node, node_ ***nodes)
+{
+	**nodes = node;
+	(*nodes)++;
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static int matrixInitializeStamps(stamp_ *stamp, matrix_ *r)
+{
+	ReturnErrIf(stampCompile(stamp, r->aBase, r->lenA, r->bBase, r->X,
+			r->lenXB, &r->changed));
+	if(stamp->value != NULL) {
+		r->dynamic[r->numDynamic++] = stamp;
+	}
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
 static int matrixInitializeNodes(node_ *node, matrix_ *r)
 {
 	int row, col;
 	ReturnErrIf(node == NULL);
 
 	/* Trying to set the gnd node will raise a flag and we can exit */
-	if(nodeSetDataPtr(node, &r->A[r->index]))
+	if(nodeSetDataPtr(node, &r->aBase[r->index], &r->changed))
 		return 0;
 	row = nodeGetRow(node);
 	ReturnErrIf(row < 0);
@@ -509,8 +1310,76 @@ static int matrixInitializeNodes(node_ *node, matrix_ *r)
 
 /*---------------------------------------------------------------------------*/
 
+static int matrixFindBlocks(matrix_ *r)
+{
+	matrixSymbolic_ *s;
+	int *R, b;
+
+	/* The same topology has been through here before */
+	s = matrixSymbolicFind(r);
+	if(s != NULL) {
+		matrixSymbolicHits++;
+		r->numBlocks = s->numBlocks;
+		r->maxBlock = s->maxBlock;
+		return 0;
+	}
+	matrixSymbolicMisses++;
+
+	/* Strongly connected components of the pattern, unrelated sub-circuits
+	 * and one way couplings show up as separate diagonal blocks.
+	 */
+	R = malloc((r->lenXB + 1)*sizeof(int));
+	ReturnErrIf(R == NULL);
+	r->numBlocks = cktluBlocks(r->lenXB, r->aColStart, r->aRow, R);
+	if(r->numBlocks < 0) {
+		free(R);
+		ReturnErr("Failed to find the block structure");
+	}
+
+	r->maxBlock = 0;
+	for(b = 0; b < r->numBlocks; b++) {
+		if((R[b+1] - R[b]) > r->maxBlock) {
+			r->maxBlock = R[b+1] - R[b];
+		}
+	}
+	free(R);
+
+	/* No block form if the pattern is structurally singular */
+	if(r->numBlocks == 0) {
+		r->numBlocks = 1;
+		r->maxBlock = r->lenXB;
+	}
+
+	Debug("%i diagonal blocks, the largest is %i x %i", r->numBlocks,
+			r->maxBlock, r->maxBlock);
+
+	s = matrixSymbolicAdd(r);
+	ReturnErrIf(s == NULL);
+	s->numBlocks = r->numBlocks;
+	s->maxBlock = r->maxBlock;
+
+	return 0;
+}
+
+static int matrixInitializeBlocks(matrix_ *r)
+{
+	int error;
+
+	ReturnErrIf(matrixSymbolicLock());
+	error = matrixFindBlocks(r);
+	ReturnErrIf(matrixSymbolicUnlock());
+	ReturnErrIf(error);
+
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
 int matrixInitialize(matrix_ *r, control_ *control)
 {
+	node_ **nodes, **node;
+	int i, length;
+
 	ReturnErrIf(r == NULL);
 	ReturnErrIf(r->A != NULL);
 
@@ -519,7 +1388,17 @@ int matrixInitialize(matrix_ *r, control_ *control)
 	r->lenXB = listLength(r->rows) - 1; /* Minus the ground row */
 	ReturnErrIf(r->lenXB < 0);
 
-	r->A = calloc(r->lenA, sizeof(double));
+	/* An empty list keeps no rows, NULL would keep all of them */
+	ReturnErrIf(historyInitialize(r->internal, r->lenXB,
+			(r->required != NULL) ? r->required : &r->numRequired,
+			r->numRequired));
+	r->saveChanged = 1;
+
+	r->XLast = calloc(r->lenXB + 1, sizeof(double));
+	ReturnErrIf(r->XLast == NULL);
+
+	/* A, X and B have a scratch entry at the end for gnd, see stamp.h */
+	r->A = calloc(r->lenA + 1, sizeof(double));
 	ReturnErrIf(r->A == NULL);
 
 	r->aRow = calloc(r->lenA, sizeof(int));
@@ -528,23 +1407,151 @@ int matrixInitialize(matrix_ *r, control_ *control)
 	r->aColStart = calloc((r->lenXB+1), sizeof(int));
 	ReturnErrIf(r->aColStart == NULL);
 
-	r->X = calloc(r->lenXB, sizeof(double));
+	r->X = calloc(r->lenXB + 1, sizeof(double));
 	ReturnErrIf(r->X == NULL);
 
-	r->B = calloc(r->lenXB, sizeof(double));
+	r->B = calloc(r->lenXB + 1, sizeof(double));
 	ReturnErrIf(r->B == NULL);
 
+	r->aBase = calloc(r->lenA + 1, sizeof(double));
+	ReturnErrIf(r->aBase == NULL);
+
+	r->bBase = calloc(r->lenXB + 1, sizeof(double));
+	ReturnErrIf(r->bBase == NULL);
+
+	length = listLength(r->stamps);
+	ReturnErrIf(length < 0);
+	r->dynamic = calloc(length + 1, sizeof(stamp_*));
+	ReturnErrIf(r->dynamic == NULL);
+
+	/* Sort the nodes into column order, once */
+	length = listLength(r->nodes);
+	ReturnErrIf(length < 0);
+	nodes = malloc(length*sizeof(node_*));
+	ReturnErrIf(nodes == NULL);
+	node = nodes;
+	ReturnErrIf(listExecute(r->nodes, (listExecute_)matrixGetNodes,
+			(void*)&node));
+	qsort(nodes, length, sizeof(node_*),
+			(int (*)(const void*, const void*))nodeCompare);
+
 	r->index = 0;
-	ReturnErrIf(listExecute(r->nodes, (listExecute_)matrixInitializeNodes, r));
+	for(i = 0; i < length; i++) {
+		if(matrixInitializeNodes(nodes[i], r)) {
+			free(nodes);
+			ReturnErr("Failed to initialize node");
+		}
+	}
+	free(nodes);
+
+	/* The predictor keeps a short history of X, the units of each entry
+	 * are filled in with the rows below
+	 */
+	r->predict = control->predictor;
+	if(r->predict) {
+		r->units = calloc(r->lenXB + 1, sizeof(char));
+		ReturnErrIf(r->units == NULL);
+		r->predictPast = calloc(MATRIX_PREDICT_POINTS*r->lenXB, sizeof(double));
+		ReturnErrIf(r->predictPast == NULL);
+		r->predictX = calloc(r->lenXB, sizeof(double));
+		ReturnErrIf(r->predictX == NULL);
+	}
+
 	r->index = 0;
 	ReturnErrIf(listExecute(r->rows, (listExecute_)matrixInitializeRows, r));
-
+	ReturnErrIf(listExecute(r->stamps, (listExecute_)matrixInitializeStamps,
+			r));
+	r->changed = 1;
+	r->fingerprint = matrixFingerprint(r);
+	ReturnErrIf(matrixInitializeBlocks(r));
+
+	/* Small circuits are faster to solve as a dense matrix, the sparse
+	 * libraries spend more time on setup and ordering than on arithmetic.
+	 * Circuits set up for threads go to CktLU, the only library that
+	 * refactors on the pool. Its block ordering alone isn't worth changing
+	 * the numerics of a single threaded run, the blocks are still factored
+	 * and solved one after another.
+	 */
 	if(control->luLibrary == CONTROL_LU_SUPERLU) {
-		ReturnErrIf(matrixInitializeSuperLU(r, control));
+		r->class = &matrixSuperLU;
+	} else if(control->luLibrary == CONTROL_LU_DENSE) {
+		r->class = &matrixDense;
+	} else if(control->luLibrary == CONTROL_LU_CKTLU) {
+		r->class = &matrixCktLU;
+	} else if(control->luLibrary == CONTROL_LU_AUTO) {
+		if(r->lenXB <= control->luDenseSize) {
+			r->class = &matrixDense;
+		} else if(control->luThreads > 1) {
+			r->class = &matrixCktLU;
+		} else {
+			r->class = &matrixSuperLU;
+		}
 	} else {
 		ReturnErr("Unsupported matrix library");
 	}
 
+	/* Chord iterations need the last solution and a residual vector */
+	r->chord = control->chord;
+	r->chordRate = control->chordRate;
+	if(r->chord) {
+		r->chordX = calloc(r->lenXB, sizeof(double));
+		ReturnErrIf(r->chordX == NULL);
+		r->chordR = calloc(r->lenXB, sizeof(double));
+		ReturnErrIf(r->chordR == NULL);
+	}
+
+	/* Low rank updates need a copy of the factored A and space for the
+	 * update, at most woodburyRank rows and columns can change
+	 */
+	r->woodburyRank = (control->woodburyRank < r->lenXB) ?
+			control->woodburyRank : r->lenXB;
+	if(r->woodburyRank > 0) {
+		r->woodburySlot = malloc(r->lenXB*sizeof(int));
+		ReturnErrIf(r->woodburySlot == NULL);
+		for(i = 0; i < r->lenXB; i++) {
+			r->woodburySlot[i] = -1;
+		}
+		r->woodburyIndex = calloc(r->woodburyRank, sizeof(int));
+		ReturnErrIf(r->woodburyIndex == NULL);
+		r->woodburyPiv = calloc(r->woodburyRank, sizeof(int));
+		ReturnErrIf(r->woodburyPiv == NULL);
+		r->woodburyA = calloc(r->lenA, sizeof(double));
+		ReturnErrIf(r->woodburyA == NULL);
+		r->woodburyZ = calloc(r->lenXB*r->woodburyRank, sizeof(double));
+		ReturnErrIf(r->woodburyZ == NULL);
+		r->woodburyM = calloc(r->woodburyRank*r->woodburyRank,
+				sizeof(double));
+		ReturnErrIf(r->woodburyM == NULL);
+		r->woodburyG = calloc(r->woodburyRank*r->woodburyRank,
+				sizeof(double));
+		ReturnErrIf(r->woodburyG == NULL);
+		r->woodburyT = calloc(r->woodburyRank, sizeof(double));
+		ReturnErrIf(r->woodburyT == NULL);
+		r->woodburyE = calloc(r->lenXB, sizeof(double));
+		ReturnErrIf(r->woodburyE == NULL);
+	}
+
+	Debug("Using the %s LU library (%i x %i)", r->class->name, r->lenXB,
+			r->lenXB);
+
+	/* Every cached factorization has its own copy of the LU library */
+	r->cacheSize = control->luCache;
+	if(r->cacheSize > 0) {
+		r->cache = calloc(r->cacheSize, sizeof(matrixCacheEntry_));
+		ReturnErrIf(r->cache == NULL);
+		for(i = 0; i < r->cacheSize; i++) {
+			r->library = NULL;
+			ReturnErrIf(r->class->config(r, control));
+			r->cache[i].library = r->library;
+			r->cache[i].A = calloc(r->lenA, sizeof(double));
+			ReturnErrIf(r->cache[i].A == NULL);
+		}
+		r->library = r->cache[0].library;
+		r->cacheCurrent = 0;
+	} else {
+		ReturnErrIf(r->class->config(r, control));
+	}
+
 	return 0;
 }
 
@@ -554,6 +1561,7 @@ int matrixInitialize(matrix_ *r, control_ *control)
 
 int matrixDestroy(matrix_ **r)
 {
+	int i;
 	ReturnErrIf(r == NULL);
 	ReturnErrIf((*r) == NULL);
 
@@ -565,6 +1573,24 @@ int matrixDestroy(matrix_ **r)
 		}
 	}
 
+	if((*r)->stamps != NULL) {
+		if(listDestroy(&(*r)->stamps, (listDestroy_)stampDestroy)) {
+			Warn("Error destroying stamp list");
+		}
+	}
+
+	if((*r)->rowHash != NULL) {
+		if(hashDestroy(&(*r)->rowHash, NULL)) {
+			Warn("Error destroying row hash");
+		}
+	}
+
+	if((*r)->rowKey != NULL)
+		free((*r)->rowKey);
+
+	if((*r)->nodeTable != NULL)
+		free((*r)->nodeTable);
+
 	if((*r)->nodes != NULL) {
 		if(listDestroy(&(*r)->nodes, (listDestroy_)nodeDestroy)) {
 			Warn("Error destroying node list");
@@ -572,13 +1598,46 @@ int matrixDestroy(matrix_ **r)
 	}
 
 	if((*r)->history != NULL) {
-		if(listDestroy(&(*r)->history, (listDestroy_)historyDestroy)) {
-			Warn("Error destroying history list");
+		if(historyDestroy(&(*r)->history)) {
+			Warn("Error destroying history");
 		}
 	}
 
-	if((*r)->unconfig != NULL) {
-		ReturnErrIf((*r)->unconfig(*r));
+	if((*r)->internal != NULL) {
+		if(historyDestroy(&(*r)->internal)) {
+			Warn("Error destroying history");
+		}
+	}
+
+	if((*r)->saveNames != NULL) {
+		ReturnErrIf(matrixSave(*r, NULL));
+	}
+
+	if((*r)->required != NULL)
+		free((*r)->required);
+
+	if((*r)->lookBacks != NULL)
+		free((*r)->lookBacks);
+
+	if((*r)->XLast != NULL)
+		free((*r)->XLast);
+
+	if((*r)->cache != NULL) {
+		for(i = 0; i < (*r)->cacheSize; i++) {
+			(*r)->library = (*r)->cache[i].library;
+			if((*r)->library != NULL) {
+				ReturnErrIf((*r)->class->unconfig(*r));
+				free((*r)->library);
+			}
+			if((*r)->cache[i].A != NULL)
+				free((*r)->cache[i].A);
+		}
+		free((*r)->cache);
+		(*r)->library = NULL;
+	}
+
+	if(((*r)->class != NULL) && ((*r)->library != NULL)) {
+		ReturnErrIf((*r)->class->unconfig(*r));
 	}
 
 	if((*r)->A != NULL)
@@ -589,8 +1648,42 @@ int matrixDestroy(matrix_ **r)
 		free((*r)->aColStart);
 	if((*r)->X != NULL)
 		free((*r)->X);
+	if((*r)->chordX != NULL)
+		free((*r)->chordX);
+	if((*r)->chordR != NULL)
+		free((*r)->chordR);
+	if((*r)->units != NULL)
+		free((*r)->units);
+	if((*r)->predictPast != NULL)
+		free((*r)->predictPast);
+	if((*r)->predictX != NULL)
+		free((*r)->predictX);
+	if((*r)->woodburySlot != NULL)
+		free((*r)->woodburySlot);
+	if((*r)->woodburyIndex != NULL)
+		free((*r)->woodburyIndex);
+	if((*r)->woodburyPiv != NULL)
+		free((*r)->woodburyPiv);
+	if((*r)->woodburyA != NULL)
+		free((*r)->woodburyA);
+	if((*r)->woodburyZ != NULL)
+		free((*r)->woodburyZ);
+	if((*r)->woodburyM != NULL)
+		free((*r)->woodburyM);
+	if((*r)->woodburyG != NULL)
+		free((*r)->woodburyG);
+	if((*r)->woodburyT != NULL)
+		free((*r)->woodburyT);
+	if((*r)->woodburyE != NULL)
+		free((*r)->woodburyE);
 	if((*r)->B != NULL)
 		free((*r)->B);
+	if((*r)->aBase != NULL)
+		free((*r)->aBase);
+	if((*r)->bBase != NULL)
+		free((*r)->bBase);
+	if((*r)->dynamic != NULL)
+		free((*r)->dynamic);
 
 	if((*r)->library != NULL)
 		free((*r)->library);
@@ -602,8 +1695,6 @@ int matrixDestroy(matrix_ **r)
 
 /*---------------------------------------------------------------------------*/
 
-static char * defaultName = "None";
-
 matrix_ * matrixNew(matrix_ *r)
 {
 	ReturnNULLIf(r != NULL);
@@ -617,18 +1708,28 @@ matrix_ * matrixNew(matrix_ *r)
 	GotoFailedIf(r->rows == NULL);
 	/* Add the ground row */
 	GotoFailedIf(listAdd(r->rows, &gndRow, NULL));
+	r->rowHash = hashNew(r->rowHash, 64);
+	GotoFailedIf(r->rowHash == NULL);
+	GotoFailedIf(hashAdd(r->rowHash, rowGetName(&gndRow), &gndRow));
 
 	/* Create Node List */
 	r->nodes = listNew(r->nodes);
 	GotoFailedIf(r->nodes == NULL);
 	/* Add the ground node */
 	GotoFailedIf(listAdd(r->nodes, &gndNode, NULL));
+	r->nodeTableSize = 64;
+	r->nodeTable = calloc(r->nodeTableSize, sizeof(matrixNodeEntry_));
+	GotoFailedIf(r->nodeTable == NULL);
 
-	/* Create Results List */
-	r->history = listNew(r->history);
-	GotoFailedIf(r->history == NULL);
+	/* Create Stamp List */
+	r->stamps = listNew(r->stamps);
+	GotoFailedIf(r->stamps == NULL);
 
-	r->name = defaultName;
+	/* Create Results Store, and one for the rows devices look back at */
+	r->history = historyNew(r->history);
+	GotoFailedIf(r->history == NULL);
+	r->internal = historyNew(r->internal);
+	GotoFailedIf(r->internal == NULL);
 
 	return r;
 
@@ -27,6 +27,7 @@ struct _node {
 	int row;
 	int col;
 	double *data;
+	int *changed;
 };
 
 /*===========================================================================*/
@@ -40,29 +41,15 @@ node_ gndNode = {
 
 /*===========================================================================*/
 
-listFindReturn_ nodeCompare(node_ *r, nodeIndex_ *index)
+int nodeCompare(node_ **a, node_ **b)
 {
-	ReturnErrIf(r == NULL);
-	ReturnErrIf(index == NULL);
-
-	if((r->col == index->col) && (r->row == index->row)) {
-		return LIST_FIND_MATCH;
-	}
-	return LIST_FIND_NOTAMATCH;
-}
-
-/*---------------------------------------------------------------------------*/
-
-listAddReturn_ nodeAdd(node_ *r, node_ *newNode)
-{
-	ReturnErrIf(r == NULL);
-	ReturnErrIf(newNode == NULL);
-
-	if((r->col > newNode->col) ||
-			((r->col == newNode->col) && (r->row > newNode->row))) {
-		return LIST_ADD_BEFORE;
+	/* Column major order, for qsort */
+	if((*a)->col != (*b)->col) {
+		return ((*a)->col < (*b)->col) ? -1 : 1;
+	} else if((*a)->row != (*b)->row) {
+		return ((*a)->row < (*b)->row) ? -1 : 1;
 	}
-	return LIST_ADD_NOTHERE;
+	return 0;
 }
 
 /*---------------------------------------------------------------------------*/
@@ -89,7 +76,10 @@ int nodeDataPlus(node_ *r, double plus)
 	ReturnErrIf(r->data == NULL);
 	if(r == &gndNode)
 		return 0;
-	*r->data += plus;
+	if((*r->data + plus) != *r->data) {
+		*r->data += plus;
+		*r->changed = 1;
+	}
 	return 0;
 }
 
@@ -101,7 +91,10 @@ int nodeDataSet(node_ *r, double value)
 	ReturnErrIf(r->data == NULL);
 	if(r == &gndNode)
 		return 0;
-	*r->data = value;
+	if(*r->data != value) {
+		*r->data = value;
+		*r->changed = 1;
+	}
 	return 0;
 }
 
@@ -113,22 +106,35 @@ int nodeDataClear(node_ *r)
 	ReturnErrIf(r->data == NULL);
 	if(r == &gndNode)
 		return 0;
-	*r->data = 0.0;
+	if(*r->data != 0.0) {
+		*r->data = 0.0;
+		*r->changed = 1;
+	}
 	return 0;
 }
 
 /*---------------------------------------------------------------------------*/
 
-int nodeSetDataPtr(node_ *r, double *data)
+int nodeSetDataPtr(node_ *r, double *data, int *changed)
 {
 	ReturnErrIf(r == NULL);
 	ReturnErrIf(data == NULL);
+	ReturnErrIf(changed == NULL);
 	if(r == &gndNode)
 		return 1;
 	r->data = data;
+	r->changed = changed;
 	return 0;
 }
 
+/*---------------------------------------------------------------------------*/
+
+double * nodeGetDataPtr(node_ *r)
+{
+	ReturnNULLIf(r == NULL);
+	return r->data;
+}
+
 /*===========================================================================*/
 
 int nodeDestroy(node_ *r)
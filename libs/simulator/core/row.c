@@ -43,29 +43,6 @@ row_ gndRow = {
 
 /*===========================================================================*/
 
-listFindReturn_ rowCompare(row_ *r, rowName_ *name)
-{
-	ReturnErrIf(r == NULL);
-	ReturnErrIf(name == NULL);
-
-	if(name->type == 0x0) {
-		if(!strcmp(r->name, name->name)) {
-			return LIST_FIND_MATCH;
-		}
-	} else {
-		if((r->name[0] == name->type) &&
-			strlen(name->name) == (strlen(r->name) - 3)) {
-				if(!strncmp(&r->name[2], name->name, strlen(name->name))) {
-					return LIST_FIND_MATCH;
-			}
-		}
-	}
-
-	return LIST_FIND_NOTAMATCH;
-}
-
-/*---------------------------------------------------------------------------*/
-
 char * rowGetName(row_ *r)
 {
 	ReturnNULLIf(r == NULL);
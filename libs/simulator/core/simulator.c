@@ -21,15 +21,21 @@
 
 #include <log.h>
 #include <ctype.h>
+#include <math.h>
+#include <stddef.h>
+#include <string.h>
 #include <data.h>
 #include <calc.h>
 
 #include "simulator.h"
 #include "device.h"
+#include "dispatch.h"
 #include "history.h"
 
 struct _simulator {
-	list_ *devices;
+	list_ *devices;	/* In the order they were added */
+	dispatch_ *dispatch; /* Devices by analysis phase, built when locked */
+	hash_ *refdes;	/* Refdes to device, to catch duplicates */
 	matrix_ *matrix;
 	control_ *control;
 	int locked;	/* Indicates that the matrix has been initialise */
@@ -42,7 +48,11 @@ struct _simulator {
  |                                  Analysis                                 |
   ===========================================================================*/
 
-static int simulatorSolve(simulator_ *r, int interationLimit)
+/* With predicted set X holds a prediction of the solution, the first pass
+ * linearizes the devices about it and if the solution lands back on it
+ * within tolerance there's nothing left for Newton to do.
+ */
+static int simulatorSolve(simulator_ *r, int interationLimit, int predicted)
 {
 	int count = 0;
 	int linear;
@@ -50,12 +60,24 @@ static int simulatorSolve(simulator_ *r, int interationLimit)
 	ReturnErrIf(r == NULL);
 	ReturnErrIf(interationLimit < 1);
 
+	if(predicted) {
+		linear = 1;
+		ReturnErrIf(dispatchLinearize(r->dispatch, &linear));
+	}
+
 	ReturnErrIf(matrixSolve(r->matrix));
 
+	if(predicted) {
+		linear = matrixPredictConverged(r->matrix, r->control);
+		ReturnErrIf(linear < 0);
+		if(linear) {
+			return 1;
+		}
+	}
+
 	while(count++ < interationLimit) {
 		linear = 1;
-		ReturnErrIf(listExecute(r->devices, (listExecute_)deviceLinearize,
-				&linear))
+		ReturnErrIf(dispatchLinearize(r->dispatch, &linear));
 		if(linear)
 			break;
 		ReturnErrIf(matrixSolveAgain(r->matrix));
@@ -72,6 +94,66 @@ static int simulatorSolve(simulator_ *r, int interationLimit)
 
 #define Min3(x,y,z) ((x < y) ? ((z < x) ? z : x) : ((z < y) ? z : y))
 
+/* Rounds a step down to one of tmax, tmax/ratio, tmax/ratio^2, ... so a
+ * linear circuit keeps coming back to the same few matrices and the LU
+ * factor cache can reuse them.
+ */
+static double simulatorStepLadder(simulator_ *r, double step, double tmax)
+{
+	double ratio = r->control->stepLadder;
+
+	if((ratio <= 1.0) || (step >= tmax) || (step <= 0.0)) {
+		return step;
+	}
+
+	return tmax*pow(ratio, -ceil(log(tmax/step)/log(ratio)));
+}
+
+/* Picks the Gear order for the next step, the present order or the one on
+ * either side of it if that lets the integrating devices take a step that
+ * is at least 20% larger. The order is only reconsidered once it has been
+ * used for order + 1 steps, so the history behind it is all at that order.
+ */
+static int simulatorGearOrder(simulator_ *r, double *lteStep, double tmax,
+		int *steps)
+{
+	int order = r->control->integratorOrder, best = order, k;
+	double step, bestStep;
+	int maxorder = (r->control->maxorder < CONTROL_GEAR_MAX_ORDER) ?
+			r->control->maxorder : CONTROL_GEAR_MAX_ORDER;
+
+	if(++(*steps) <= order) {
+		return 0;
+	}
+
+	bestStep = tmax;
+	ReturnErrIf(dispatchMinStep(r->dispatch, &bestStep));
+
+	for(k = order + 1; k >= order - 1; k -= 2) {
+		if((k < 1) || (k > maxorder)) {
+			continue;
+		}
+		r->control->integratorOrder = k;
+		step = tmax;
+		ReturnErrIf(dispatchMinStep(r->dispatch, &step));
+		if(step > 1.2 * bestStep) {
+			best = k;
+			bestStep = step;
+		}
+	}
+
+	r->control->integratorOrder = best;
+	if(best != order) {
+		Debug("Gear order %i -> %i, step %e", order, best, bestStep);
+		*lteStep = bestStep;
+		*steps = 0;
+	}
+
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
 int simulatorRunTransient(simulator_ *r,
 		double tstep, double tstop, double tmax, int restart,
 		double *data[], char **variables[], int *numPoints, int *numVariables)
@@ -83,9 +165,13 @@ int simulatorRunTransient(simulator_ *r,
 						   	from devices that use numerical integration */
 	double prevTime = 0.0; /* time at previous step */
 	int breakPoint = 0;	   /* Indicates currently servicing a break-point */
+	int gearSteps = 0;     /* steps taken at the present Gear order */
 	double oldMinstep;
 
 	ReturnErrIf(r == NULL);
+	ReturnErrIf((r->control->niMethod == CONTROL_NIMETHOD_TRAP) &&
+			(r->control->maxorder > 2),
+			"Trapezoidal integration only goes up to maxorder 2");
 
 	/* Set default tmax if it's 0.0 */
 	if(tmax == 0.0) {
@@ -113,6 +199,8 @@ int simulatorRunTransient(simulator_ *r,
 		/* Initialize the matrices if they haven't been already */
 		if(!r->locked) {
 			ReturnErrIf(matrixInitialize(r->matrix, r->control));
+			r->dispatch = dispatchNew(r->dispatch, r->control, r->devices);
+			ReturnErrIf(r->dispatch == NULL);
 			r->locked = -1;
 		}
 
@@ -120,21 +208,30 @@ int simulatorRunTransient(simulator_ *r,
 		ReturnErrIf(matrixClear(r->matrix));
 
 		/* Load Matrix A with Values from Devices */
-		ReturnErrIf(listExecute(r->devices, (listExecute_)deviceLoad, NULL));
+		ReturnErrIf(dispatchLoad(r->dispatch));
 
 		/* Solve Matrices */
-		linCount = simulatorSolve(r, r->control->itl1);
+		linCount = simulatorSolve(r, r->control->itl1, 0);
 		ReturnErrIf((linCount < 0) || (linCount > r->control->itl1));
 
 		/* Initialize the Devices for a Time Stepping */
-		ReturnErrIf(listExecute(r->devices, (listExecute_)deviceInitStep, NULL));
+		ReturnErrIf(dispatchInitStep(r->dispatch));
 
-		/* For first step set integration order to the maximum */
-		r->control->integratorOrder = r->control->maxorder;
+		/* For first step set integration order to the maximum, Gear needs
+		 * a point for each order so it starts at the bottom.
+		 */
+		if(r->control->niMethod == CONTROL_NIMETHOD_GEAR) {
+			r->control->integratorOrder = 1;
+		} else {
+			r->control->integratorOrder = r->control->maxorder;
+		}
 
 		/* Set the current time to 0 */
 		r->control->time = 0.0;
 		prevTime = 0.0;
+
+		/* Queue up the first break-point from each source */
+		ReturnErrIf(dispatchInitBreak(r->dispatch));
 	} else {
 		prevTime = r->control->time;
 	}
@@ -149,9 +246,8 @@ int simulatorRunTransient(simulator_ *r,
 		 * the results have been calculated, the DeviceMinStep function
 		 * below is a look-back function
 		 */
-		thisStep = maxStep;
-		ReturnErrIf(listExecute(r->devices, (listExecute_)deviceNextStep,
-				&thisStep));
+		thisStep = simulatorStepLadder(r, maxStep, tmax);
+		ReturnErrIf(dispatchNextStep(r->dispatch, &thisStep));
 
 		while(1) {
 			r->control->time = prevTime + thisStep;
@@ -159,42 +255,63 @@ int simulatorRunTransient(simulator_ *r,
 				thisStep = tstop - prevTime;
 				r->control->time = tstop;
 			}
+			r->control->step = thisStep;
 			Debug("time = %e", r->control->time);
 
 			/* Step all of the devices in time, and check to see if any
 			 * of them want to declare this step a break-point.
 			 */
 			breakPoint = 0;
-			ReturnErrIf(listExecute(r->devices, (listExecute_)deviceStep,
-					&breakPoint));
+			ReturnErrIf(dispatchStep(r->dispatch, &breakPoint));
 			if(breakPoint) {
 				Debug("Break");
 				r->control->integratorOrder = 1;
+				gearSteps = 0;
 			}
 			/* Devices that use integration are processed seperatally so
 			 * they can pick up the break point order change if there was
 			 * one.
 			 */
-			ReturnErrIf(listExecute(r->devices, (listExecute_)deviceIntegrate,
-					NULL));
+			ReturnErrIf(dispatchIntegrate(r->dispatch));
+
+			/* Start from a polynomial extrapolation of the last few points,
+			 * this has to come after the integrating devices have read the
+			 * last solution.
+			 */
+			if(r->control->predictor) {
+				ReturnErrIf(matrixPredict(r->matrix, r->control->time,
+						r->control->integratorOrder));
+			}
 
 			/* Solve the matrices */
-			linCount = simulatorSolve(r, r->control->itl4);
+			ReturnErrIf(matrixSetStep(r->matrix, thisStep,
+					r->control->integratorOrder));
+			linCount = simulatorSolve(r, r->control->itl4,
+					r->control->predictor);
 			ReturnErrIf(linCount < 0);
 
 			/* check to see if we reached linearization */
 			if(linCount < r->control->itl4) {
 				/* get the recomened step size from devices that have ODEs */
 				lteStep = tmax; /* need a large seed for the min check */
-				ReturnErrIf(listExecute(r->devices,
-						(listExecute_)deviceMinStep, &lteStep));
+				ReturnErrIf(dispatchMinStep(r->dispatch, &lteStep));
+				/* and from how far the solution was from the prediction */
+				if(r->control->predictor && !breakPoint) {
+					ReturnErrIf(matrixPredictStep(r->matrix, r->control,
+							thisStep, r->control->integratorOrder, &lteStep));
+				}
 				if(lteStep < (0.9 * thisStep)) {
 					Debug("lteStep = %e", lteStep);
 					ReturnErrIf(lteStep < (tstep * 1e-9),
 							"Timestep %es is too Small at %es",
 							lteStep, r->control->time);
-					r->control->integratorOrder = 1;
-					thisStep = lteStep;
+					/* Gear retries at the same order, the step was sized
+					 * for it
+					 */
+					if(r->control->niMethod != CONTROL_NIMETHOD_GEAR) {
+						r->control->integratorOrder = 1;
+					}
+					thisStep = simulatorStepLadder(r, lteStep, tmax);
 				} else {
 					break;
 				}
@@ -204,7 +321,7 @@ int simulatorRunTransient(simulator_ *r,
 				 */
 				Warn("Failed to linearize at %gs, trying smaller step-size.",
 						r->control->time);
-				thisStep = thisStep / 8;
+				thisStep = simulatorStepLadder(r, thisStep / 8, tmax);
 				ReturnErrIf(thisStep < (tstep * 1e-9),
 							"Timestep %es is too Small at %es",
 							r->control->time, thisStep);
@@ -217,9 +334,17 @@ int simulatorRunTransient(simulator_ *r,
 			ReturnErrIf(matrixRecall(r->matrix));
 		}
 
+		/* Devices with a delay queue the corners that will reach them */
+		ReturnErrIf(dispatchBreak(r->dispatch, r->control->time));
+
 		/* Get ready for the next step */
-		/* Increase integration order */
-		r->control->integratorOrder = ControlIntegratorOrderUp(r->control);
+		if(r->control->niMethod == CONTROL_NIMETHOD_GEAR) {
+			/* Change order if it allows a larger step */
+			ReturnErrIf(simulatorGearOrder(r, &lteStep, tmax, &gearSteps));
+		} else {
+			/* Increase integration order */
+			r->control->integratorOrder = ControlIntegratorOrderUp(r->control);
+		}
 		/* store the current time */
 		prevTime = r->control->time;
 		/* Set the maximum size of the next step */
@@ -240,9 +365,9 @@ int simulatorRunTransient(simulator_ *r,
 	/* reset minstep value */
 	r->control->minstep = oldMinstep;
 
-	/* Make a copy of the results to send back to the caller */
-	ReturnErrIf(matrixGetSolution(r->matrix, data, variables, numPoints,
-			numVariables));
+	/* Hand the results back to the caller */
+	ReturnErrIf(matrixGetSolution(r->matrix, data, variables,
+			numPoints, numVariables));
 
 	return 0;
 }
@@ -259,24 +384,113 @@ int simulatorRunOperatingPoint(simulator_ *r,
 	/* Initialize the matrices if they haven't been already */
 	if(!r->locked) {
 		ReturnErrIf(matrixInitialize(r->matrix, r->control));
+		r->dispatch = dispatchNew(r->dispatch, r->control, r->devices);
+		ReturnErrIf(r->dispatch == NULL);
 		r->locked = -1;
 	}
 	/* Clear out any data that may be in the matrices */
 	ReturnErrIf(matrixClear(r->matrix));
 
 	/* Load Matrix A with Values from Devices */
-	ReturnErrIf(listExecute(r->devices, (listExecute_)deviceLoad, NULL));
+	ReturnErrIf(dispatchLoad(r->dispatch));
 
 	/* Solve Matraces */
-	linCount = simulatorSolve(r, r->control->itl1);
+	linCount = simulatorSolve(r, r->control->itl1, 0);
 	ReturnErrIf((linCount < 0) || (linCount > r->control->itl1));
 
 	/* Store Data (time is 0 and no break-point) */
 	ReturnErrIf(matrixRecord(r->matrix, 0.0, HISTORY_FLAG_END));
 
-	/* Make a copy of the results to send back to the caller */
-	ReturnErrIf(matrixGetSolution(r->matrix, data, variables, numPoints,
-			numVariables));
+	/* Hand the results back to the caller */
+	ReturnErrIf(matrixGetSolution(r->matrix, data, variables,
+			numPoints, numVariables));
+
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+int simulatorSave(simulator_ *r, char *variable)
+{
+	ReturnErrIf(r == NULL);
+	ReturnErrIf(matrixSave(r->matrix, variable));
+	return 0;
+}
+
+/*===========================================================================
+ |                                  Options                                  |
+  ===========================================================================*/
+
+typedef struct {
+	char *name;
+	size_t offset;	/* of the value in control_ */
+	char type;		/* 'i' for int or 'd' for double */
+	double min;
+	double max;
+	int fixed;		/* only read when the matrices are initialized */
+} simulatorOption_;
+
+static simulatorOption_ simulatorOptions[] = {
+	{"itl1", offsetof(control_, itl1), 'i', 1, HUGE_VAL, 0},
+	{"itl4", offsetof(control_, itl4), 'i', 1, HUGE_VAL, 0},
+	{"reltol", offsetof(control_, reltol), 'd', 0, 1, 0},
+	{"vntol", offsetof(control_, vntol), 'd', 0, HUGE_VAL, 0},
+	{"abstol", offsetof(control_, abstol), 'd', 0, HUGE_VAL, 0},
+	{"captol", offsetof(control_, captol), 'd', 0, HUGE_VAL, 0},
+	{"chgtol", offsetof(control_, chgtol), 'd', 0, HUGE_VAL, 0},
+	{"trtol", offsetof(control_, trtol), 'd', 0, HUGE_VAL, 0},
+	{"minstep", offsetof(control_, minstep), 'd', 0, HUGE_VAL, 0},
+	{"gmin", offsetof(control_, gmin), 'd', 0, HUGE_VAL, 0},
+	{"pivrel", offsetof(control_, pivrel), 'd', 0, 1, 0},
+	{"maxorder", offsetof(control_, maxorder), 'i', 1,
+			CONTROL_GEAR_MAX_ORDER, 0},
+	{"method", offsetof(control_, niMethod), 'i', CONTROL_NIMETHOD_TRAP,
+			CONTROL_NIMETHOD_GEAR, 0},
+	{"lulibrary", offsetof(control_, luLibrary), 'i', CONTROL_LU_SUPERLU,
+			CONTROL_LU_AUTO, 1},
+	{"ludensesize", offsetof(control_, luDenseSize), 'i', 0, HUGE_VAL, 1},
+	{"luordering", offsetof(control_, luOrdering), 'i', CONTROL_ORDER_COLAMD,
+			CONTROL_ORDER_AUTO, 1},
+	{"luthreads", offsetof(control_, luThreads), 'i', 1, 64, 1},
+	{"lusingle", offsetof(control_, luSingle), 'i', 0, 1, 1},
+	{"lucache", offsetof(control_, luCache), 'i', 0, HUGE_VAL, 1},
+	{"chord", offsetof(control_, chord), 'i', 0, 1, 1},
+	{"chordrate", offsetof(control_, chordRate), 'd', 0, 1, 1},
+	{"woodburyrank", offsetof(control_, woodburyRank), 'i', 0, HUGE_VAL, 1},
+	{"bypass", offsetof(control_, bypass), 'i', 0, 1, 0},
+	{"predictor", offsetof(control_, predictor), 'i', 0, 1, 1},
+	{"stepladder", offsetof(control_, stepLadder), 'd', 0, HUGE_VAL, 0},
+	{NULL, 0, 0, 0, 0, 0}
+};
+
+/*---------------------------------------------------------------------------*/
+
+int simulatorSetOption(simulator_ *r, char *name, double value)
+{
+	simulatorOption_ *option;
+	char *field;
+
+	ReturnErrIf(r == NULL);
+	ReturnErrIf(name == NULL);
+
+	for(option = simulatorOptions; option->name != NULL; option++) {
+		if(!strcmp(option->name, name)) {
+			break;
+		}
+	}
+	ReturnErrIf(option->name == NULL, "Unknown option %s", name);
+	ReturnErrIf(isnan(value) || (value < option->min) ||
+			(value > option->max), "%g is out of range for %s", value, name);
+	ReturnErrIf(option->fixed && r->locked,
+			"%s has to be set before the first analysis", name);
+
+	field = (char*)r->control + option->offset;
+	if(option->type == 'i') {
+		ReturnErrIf(value != floor(value), "%s has to be an integer", name);
+		*(int*)field = (int)value;
+	} else {
+		*(double*)field = value;
+	}
 
 	return 0;
 }
@@ -285,6 +499,28 @@ int simulatorRunOperatingPoint(simulator_ *r,
  |                               Device Creation                             |
   ===========================================================================*/
 
+static int simulatorAddDevice(simulator_ *r, device_ *device)
+{
+	device_ *old;
+	char *refdes;
+
+	refdes = deviceGetRefdes(device);
+	ReturnErrIf(refdes == NULL);
+
+	ReturnErrIf(hashFind(r->refdes, refdes, (void*)&old));
+	if(old != NULL) {
+		ReturnErrIf(deviceDestroy(device));
+		ReturnErr("%s is listed twice", deviceGetRefdes(old));
+	}
+
+	ReturnErrIf(listAdd(r->devices, device, NULL));
+	ReturnErrIf(hashAdd(r->refdes, refdes, device));
+
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
 int simulatorAddResistor(simulator_ *r,
 		char *refdes,
 		char *pNode, char *nNode,
@@ -303,7 +539,7 @@ int simulatorAddResistor(simulator_ *r,
 	ReturnErrIf(deviceResistorConfig(device, resistance));
 
 	/* Add device to the device list */
-	ReturnErrIf(listAdd(r->devices, device, (listAdd_)deviceCheckDuplicate))
+	ReturnErrIf(simulatorAddDevice(r, device));
 
 	return 0;
 }
@@ -328,7 +564,7 @@ int simulatorAddCapacitor(simulator_ *r,
 	ReturnErrIf(deviceCapacitorConfig(device, capacitance));
 
 	/* Add device to the device list */
-	ReturnErrIf(listAdd(r->devices, device, (listAdd_)deviceCheckDuplicate))
+	ReturnErrIf(simulatorAddDevice(r, device));
 
 	return 0;
 }
@@ -353,7 +589,7 @@ int simulatorAddInductor(simulator_ *r,
 	ReturnErrIf(deviceInductorConfig(device, inductance));
 
 	/* Add device to the device list */
-	ReturnErrIf(listAdd(r->devices, device, (listAdd_)deviceCheckDuplicate))
+	ReturnErrIf(simulatorAddDevice(r, device));
 
 	return 0;
 }
@@ -386,7 +622,7 @@ int simulatorAddNonlinearSource(simulator_ *r,
 	}
 
 	/* Add device to the device list */
-	ReturnErrIf(listAdd(r->devices, device, (listAdd_)deviceCheckDuplicate))
+	ReturnErrIf(simulatorAddDevice(r, device));
 
 	return 0;
 }
@@ -420,7 +656,7 @@ int simulatorAddCallbackSource(simulator_ *r,
 	}
 
 	/* Add device to the device list */
-	ReturnErrIf(listAdd(r->devices, device, (listAdd_)deviceCheckDuplicate))
+	ReturnErrIf(simulatorAddDevice(r, device));
 
 	return 0;
 }
@@ -442,7 +678,7 @@ int simulatorAddSource(simulator_ *r,
 	ReturnErrIf(device == NULL);
 
 	/* Add device to the device list */
-	ReturnErrIf(listAdd(r->devices, device, (listAdd_)deviceCheckDuplicate))
+	ReturnErrIf(simulatorAddDevice(r, device));
 
 	/* Configure the Device */
 	if(tolower(type) == 'i') {
@@ -477,7 +713,7 @@ int simulatorAddTLine(simulator_ *r,
 	ReturnErrIf(deviceTLineConfig(device, Z0, Td, loss));
 
 	/* Add device to the device list */
-	ReturnErrIf(listAdd(r->devices, device, (listAdd_)deviceCheckDuplicate))
+	ReturnErrIf(simulatorAddDevice(r, device));
 
 	return 0;
 }
@@ -505,7 +741,7 @@ int simulatorAddTLineW(simulator_ *r,
 			Gd, fgd, fK));
 
 	/* Add device to the device list */
-	ReturnErrIf(listAdd(r->devices, device, (listAdd_)deviceCheckDuplicate))
+	ReturnErrIf(simulatorAddDevice(r, device));
 
 	return 0;
 }
@@ -532,7 +768,7 @@ int simulatorAddVICurve(simulator_ *r,
 			taType));
 
 	/* Add device to the device list */
-	ReturnErrIf(listAdd(r->devices, device, (listAdd_)deviceCheckDuplicate))
+	ReturnErrIf(simulatorAddDevice(r, device));
 
 	return 0;
 }
@@ -646,6 +882,37 @@ int simulatorPrintDevices(simulator_ *r)
 	return 0;
 }
 
+/*---------------------------------------------------------------------------*/
+
+int simulatorGetStats(simulator_ *r, int *factorizations,
+		int *refactorizations, int *substitutions, int *bypasses)
+{
+	ReturnErrIf(r == NULL);
+	ReturnErrIf(matrixGetStats(r->matrix, factorizations, refactorizations,
+			substitutions));
+	if(bypasses != NULL) {
+		*bypasses = r->control->bypasses;
+	}
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+int simulatorGetBlocks(simulator_ *r, int *numBlocks, int *maxBlock)
+{
+	ReturnErrIf(r == NULL);
+	ReturnErrIf(matrixGetBlocks(r->matrix, numBlocks, maxBlock));
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+int simulatorGetSymbolicStats(int *hits, int *misses)
+{
+	ReturnErrIf(matrixGetSymbolicStats(hits, misses));
+	return 0;
+}
+
 /*===========================================================================
  |                          Constructor / Destructor                         |
   ===========================================================================*/
@@ -656,6 +923,18 @@ int simulatorDestroy(simulator_ **r)
 	ReturnErrIf(*r == NULL);
 	Debug("Destroying simulator %p", *r);
 
+	if((*r)->refdes != NULL) {
+		if(hashDestroy(&(*r)->refdes, NULL)) {
+			Warn("Error destroying refdes hash");
+		}
+	}
+
+	if((*r)->dispatch != NULL) {
+		if(dispatchDestroy(&(*r)->dispatch)) {
+			Warn("Error destroying dispatch");
+		}
+	}
+
 	if((*r)->devices != NULL) {
 		if(listDestroy(&(*r)->devices, (listDestroy_)deviceDestroy)) {
 			Warn("Error destroying device list");
@@ -695,6 +974,8 @@ simulator_ * simulatorNew(simulator_ *r)
 	/* Create Device List */
 	r->devices = listNew(r->devices);
 	ReturnNULLIf(r->devices == NULL);
+	r->refdes = hashNew(r->refdes, 64);
+	ReturnNULLIf(r->refdes == NULL);
 
 	/* Create Matrix Object */
 	r->matrix = matrixNew(r->matrix);
@@ -0,0 +1,189 @@
+/*
+ * Copyright (C) 2006 Cooper Street Innovations Inc.
+ *	Charles Eidsness    <charles@cooper-street.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ */
+
+#include <data.h>
+#include <log.h>
+#include "stamp.h"
+
+/*===========================================================================*/
+
+int stampCompile(stamp_ *r, double *A, int lenA, double *B, double *X,
+		int lenXB, int *changed)
+{
+	double *data;
+	int i;
+
+	ReturnErrIf(r == NULL);
+	ReturnErrIf(r->a != NULL);
+	ReturnErrIf(A == NULL);
+	ReturnErrIf(B == NULL);
+	ReturnErrIf(X == NULL);
+	ReturnErrIf(changed == NULL);
+
+	Debug("Compiling Stamp %p", r);
+
+	r->a = malloc((r->numNodes + 1)*sizeof(int));
+	ReturnErrIf(r->a == NULL);
+	r->b = malloc((r->numRows + 1)*sizeof(int));
+	ReturnErrIf(r->b == NULL);
+
+	for(i = 0; i < r->numNodes; i++) {
+		if(r->nodes[i] == &gndNode) {
+			r->a[i] = lenA;
+		} else {
+			data = nodeGetDataPtr(r->nodes[i]);
+			ReturnErrIf(data == NULL);
+			r->a[i] = data - A;
+			ReturnErrIf((r->a[i] < 0) || (r->a[i] >= lenA));
+		}
+	}
+
+	for(i = 0; i < r->numRows; i++) {
+		if(r->rows[i] == &gndRow) {
+			r->b[i] = lenXB;
+		} else {
+			/* Minus 1 becuase ignore gnd row */
+			r->b[i] = rowGetIndex(r->rows[i]) - 1;
+			ReturnErrIf((r->b[i] < 0) || (r->b[i] >= lenXB));
+		}
+	}
+
+	r->A = A;
+	r->B = B;
+	r->X = X;
+	r->changed = changed;
+
+	/* The nodes and rows belong to the matrix, they're not needed anymore */
+	free(r->nodes);
+	r->nodes = NULL;
+	free(r->rows);
+	r->rows = NULL;
+
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+int stampAssemble(stamp_ *r, double *A, double *B, int changed)
+{
+	int i;
+
+	/* A only needs to be updated if something has changed */
+	if(changed) {
+		for(i = 0; i < r->numNodes; i++) {
+			A[r->a[i]] += r->value[i];
+		}
+	}
+
+	for(i = 0; i < r->numRows; i++) {
+		B[r->b[i]] += r->rhs[i];
+	}
+
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+int stampClear(stamp_ *r)
+{
+	ReturnErrIf(r == NULL);
+
+	if(r->value != NULL) {
+		memset(r->value, 0x0, r->numNodes*sizeof(double));
+	}
+	if(r->rhs != NULL) {
+		memset(r->rhs, 0x0, r->numRows*sizeof(double));
+	}
+
+	return 0;
+}
+
+/*===========================================================================*/
+
+int stampDestroy(stamp_ *r)
+{
+	ReturnErrIf(r == NULL);
+
+	Debug("Destroying Stamp %p", r);
+
+	if(r->nodes != NULL)
+		free(r->nodes);
+	if(r->rows != NULL)
+		free(r->rows);
+	if(r->a != NULL)
+		free(r->a);
+	if(r->b != NULL)
+		free(r->b);
+	if(r->value != NULL)
+		free(r->value);
+	if(r->rhs != NULL)
+		free(r->rhs);
+	free(r);
+
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+stamp_ * stampNew(int numNodes, node_ *nodes[], int numRows, row_ *rows[],
+		int dynamic)
+{
+	stamp_ *r;
+	int i;
+
+	ReturnNULLIf(numNodes < 0);
+	ReturnNULLIf(numRows < 0);
+	ReturnNULLIf((numNodes > 0) && (nodes == NULL));
+	ReturnNULLIf((numRows > 0) && (rows == NULL));
+
+	r = calloc(1, sizeof(stamp_));
+	ReturnNULLIf(r == NULL);
+
+	Debug("Creating Stamp %p", r);
+
+	r->numNodes = numNodes;
+	r->numRows = numRows;
+
+	r->nodes = malloc((numNodes + 1)*sizeof(node_*));
+	ReturnNULLIf(r->nodes == NULL);
+	for(i = 0; i < numNodes; i++) {
+		ReturnNULLIf(nodes[i] == NULL);
+		r->nodes[i] = nodes[i];
+	}
+
+	r->rows = malloc((numRows + 1)*sizeof(row_*));
+	ReturnNULLIf(r->rows == NULL);
+	for(i = 0; i < numRows; i++) {
+		ReturnNULLIf(rows[i] == NULL);
+		r->rows[i] = rows[i];
+	}
+
+	if(dynamic) {
+		r->value = calloc(numNodes + 1, sizeof(double));
+		ReturnNULLIf(r->value == NULL);
+		r->rhs = calloc(numRows + 1, sizeof(double));
+		ReturnNULLIf(r->rhs == NULL);
+	}
+
+	return r;
+}
+
+/*===========================================================================*/
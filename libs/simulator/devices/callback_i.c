@@ -24,6 +24,7 @@
 #include <data.h>
 
 #include "checkbreak.h"
+#include "checkbypass.h"
 #include "checklinear.h"
 #include "device_internal.h"
 
@@ -55,6 +56,7 @@ struct _devicePrivate {
 	double Ieq;		/* Equalization Value (Amps) */
 	double IeqCalc;
 	checklinear_ *checklinear;
+	checkbypass_ *checkbypass;
 	checkbreak_ *checkbreak;
 	variable_ *variables;
 	double *derivs;
@@ -184,6 +186,9 @@ static int deviceClassStep(device_ *r, int *breakPoint)
 	ReturnErrIf(p == NULL);
 
 	if(p->time != NULL) {
+		/* The value moves with time so the bypass record is stale */
+		ReturnErrIf(checkbypassInitialize(p->checkbypass));
+
 		Debug("Stepping %s %s %p", r->class->type, r->refdes, r);
 
 		ReturnErrIf(deviceCallbackCalculate(p));
@@ -202,16 +207,35 @@ static int deviceClassStep(device_ *r, int *breakPoint)
 static int deviceClassLinearize(device_ *r, int *linear)
 {
 	devicePrivate_ *p;
+	int bypass;
 	ReturnErrIf(r == NULL);
 	p = r->private;
 	ReturnErrIf(p == NULL);
 
 	Debug("Linearizing %s %s %p", r->class->type, r->refdes, r);
+
+	/* Keep the last stamp if neither the inputs nor the value they
+	 * predict have moved
+	 */
+	bypass = checkbypassIsBypass(p->checkbypass);
+	ReturnErrIf(bypass < 0);
+	if(bypass) {
+		p->In = rowGetSolution(p->rowR);
+		ReturnErrIf(isnan(p->In));
+		*linear = checklinearIsLinear(p->checklinear, p->In, p->Ic);
+		ReturnErrIf(*linear < 0);
+		ReturnErrIf(checkbypassConverged(p->checkbypass,
+				checklinearPassed(p->checklinear)));
+		return 0;
+	}
+
 	ReturnErrIf(deviceCallbackCalculate(p));
 
 	/* Check convergence */
 	*linear = checklinearIsLinear(p->checklinear, p->In, p->Ic);
 	ReturnErrIf(*linear < 0);
+	ReturnErrIf(checkbypassRecord(p->checkbypass, p->Ic,
+			checklinearPassed(p->checklinear)));
 
 	/* If not linear update conductances to try again */
 	if(!(*linear)) {
@@ -234,6 +258,7 @@ static int deviceClassLoad(device_ *r)
 
 	/* Initialise / Reset State Data */
 	ReturnErrIf(checklinearInitialize(p->checklinear, 0.0));
+	ReturnErrIf(checkbypassInitialize(p->checkbypass));
 	ReturnErrIf(checkbreakInitialize(p->checkbreak, 0.0));
 	p->time = &r->control->time;
 	p->Ic = 0.0;
@@ -294,6 +319,12 @@ static int deviceClassUnconfig(device_ *r)
 		}
 	}
 
+	if(p->checkbypass != NULL) {
+		if(checkbypassDestroy(&p->checkbypass)) {
+			Warn("Error destroying bypass check");
+		}
+	}
+
 	return 0;
 }
 
@@ -326,7 +357,8 @@ deviceClass_ deviceCallbackCurrent = {
 	.initStep = NULL,
 	.step = deviceClassStep,
 	.minStep = NULL,
-	.nextStep = NULL,
+	.nextBreak = NULL,
+	.delay = NULL,
 	.integrate = NULL,
 	.print = deviceClassPrint,
 };
@@ -408,6 +440,19 @@ int deviceCallbackCurrentConfig(device_ *r, char *vars[], double values[],
 		ReturnErrIf(deviceCallbackSetVariable(r, &p->variables[i], vars[i]));
 	}
 
+	/* Setup the bypass checking object, the inputs are the present value
+	 * followed by every variable that isn't time, time only moves between
+	 * steps where bypass is reset anyway */
+	p->checkbypass = checkbypassNew(p->checkbypass, r->control, 'A');
+	ReturnErrIf(p->checkbypass == NULL);
+	ReturnErrIf(checkbypassAddInput(p->checkbypass, p->rowR, NULL, 'A', NULL));
+	for(i = 0; i < numVars; i++) {
+		if(strcmp(vars[i], "time")) {
+			ReturnErrIf(checkbypassAddInput(p->checkbypass,
+					p->variables[i].row, NULL, 0x0, &p->derivs[i]));
+		}
+	}
+
 	return 0;
 }
 
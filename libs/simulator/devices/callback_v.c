@@ -24,6 +24,7 @@
 #include <data.h>
 
 #include "checkbreak.h"
+#include "checkbypass.h"
 #include "checklinear.h"
 #include "device_internal.h"
 
@@ -54,6 +55,7 @@ struct _devicePrivate {
 	double Veq;		/* Equalization Value (Volts) */
 	double VeqCalc;
 	checklinear_ *checklinear;
+	checkbypass_ *checkbypass;
 	checkbreak_ *checkbreak;
 	variable_ *variables;
 	double *derivs;
@@ -177,6 +179,9 @@ static int deviceClassStep(device_ *r, int *breakPoint)
 	ReturnErrIf(p == NULL);
 
 	if(p->time != NULL) {
+		/* The value moves with time so the bypass record is stale */
+		ReturnErrIf(checkbypassInitialize(p->checkbypass));
+
 		Debug("Stepping %s %s %p", r->class->type, r->refdes, r);
 
 		ReturnErrIf(deviceCallbackCalculate(p));
@@ -195,16 +200,35 @@ static int deviceClassStep(device_ *r, int *breakPoint)
 static int deviceClassLinearize(device_ *r, int *linear)
 {
 	devicePrivate_ *p;
+	int bypass;
 	ReturnErrIf(r == NULL);
 	p = r->private;
 	ReturnErrIf(p == NULL);
 
 	Debug("Linearizing %s %s %p", r->class->type, r->refdes, r);
+
+	/* Keep the last stamp if neither the inputs nor the value they
+	 * predict have moved
+	 */
+	bypass = checkbypassIsBypass(p->checkbypass);
+	ReturnErrIf(bypass < 0);
+	if(bypass) {
+		p->Vn = rowGetSolution(p->rowK) - rowGetSolution(p->rowJ);
+		ReturnErrIf(isnan(p->Vn));
+		*linear = checklinearIsLinear(p->checklinear, p->Vn, p->Vc);
+		ReturnErrIf(*linear < 0);
+		ReturnErrIf(checkbypassConverged(p->checkbypass,
+				checklinearPassed(p->checklinear)));
+		return 0;
+	}
+
 	ReturnErrIf(deviceCallbackCalculate(p));
 
 	/* Check convergence */
 	*linear = checklinearIsLinear(p->checklinear, p->Vn, p->Vc);
 	ReturnErrIf(*linear < 0);
+	ReturnErrIf(checkbypassRecord(p->checkbypass, p->Vc,
+			checklinearPassed(p->checklinear)));
 
 	/* If not linear update conductances to try again */
 	if(!(*linear)) {
@@ -227,6 +251,7 @@ static int deviceClassLoad(device_ *r)
 
 	/* Initialise / Reset State Data */
 	ReturnErrIf(checklinearInitialize(p->checklinear, 0.0));
+	ReturnErrIf(checkbypassInitialize(p->checkbypass));
 	ReturnErrIf(checkbreakInitialize(p->checkbreak, 0.0));
 	p->time = &r->control->time;
 	p->Vc = 0.0;
@@ -285,6 +310,12 @@ static int deviceClassUnconfig(device_ *r)
 		}
 	}
 
+	if(p->checkbypass != NULL) {
+		if(checkbypassDestroy(&p->checkbypass)) {
+			Warn("Error destroying bypass check");
+		}
+	}
+
 	return 0;
 }
 
@@ -317,7 +348,8 @@ deviceClass_ deviceCallbackVoltage = {
 	.initStep = NULL,
 	.step = deviceClassStep,
 	.minStep = NULL,
-	.nextStep = NULL,
+	.nextBreak = NULL,
+	.delay = NULL,
 	.integrate = NULL,
 	.print = deviceClassPrint,
 };
@@ -397,6 +429,20 @@ int deviceCallbackVoltageConfig(device_ *r, char *vars[], double values[],
 		ReturnErrIf(deviceCallbackSetVariable(r, &p->variables[i], vars[i]));
 	}
 
+	/* Setup the bypass checking object, the inputs are the present value
+	 * followed by every variable that isn't time, time only moves between
+	 * steps where bypass is reset anyway */
+	p->checkbypass = checkbypassNew(p->checkbypass, r->control, 'V');
+	ReturnErrIf(p->checkbypass == NULL);
+	ReturnErrIf(checkbypassAddInput(p->checkbypass, p->rowK, p->rowJ, 'V',
+			NULL));
+	for(i = 0; i < numVars; i++) {
+		if(strcmp(vars[i], "time")) {
+			ReturnErrIf(checkbypassAddInput(p->checkbypass,
+					p->variables[i].row, NULL, 0x0, &p->derivs[i]));
+		}
+	}
+
 	return 0;
 }
 
@@ -30,169 +30,225 @@
 #define J			1
 #define NP			2
 
+/* Stamp Entries */
+#define KK			0
+#define KJ			1
+#define JK			2
+#define JJ			3
+
 /*===========================================================================
  |                            Private Structure                              |
   ===========================================================================*/
 
 struct _devicePrivate {
 	double *C;		/* Capacitance (Farad) */
-	double G;		/* Conductance (siemen) */
-	double Ieq;		/* Equalization Current (Amp) */
-	integrator_ *integrator;
-	row_ *rowK;
-	row_ *rowJ;
-	node_ *nodeKK;
-	node_ *nodeJK;
-	node_ *nodeKJ;
-	node_ *nodeJJ;
+	stamp_ *stamp;
+};
+
+/* Every capacitor in the circuit, integrated together */
+struct _deviceBatch {
+	int length;
+	stamp_ **stamp;
+	double *v0;
+	double *G;
+	double *Ieq;
+	integratorBank_ *integrator;
 };
 
 /*===========================================================================
  |                             Class Functions                               |
   ===========================================================================*/
 
-static int deviceClassMinStep(device_ *r, double *minStep)
+static int deviceClassLoad(device_ *r)
 {
 	devicePrivate_ *p;
-	double v0;
-
 	ReturnErrIf(r == NULL);
 	p = r->private;
 	ReturnErrIf(p == NULL);
 
-	Debug("Calc Min Step %s %s %p", r->class->type, r->refdes, r);
-
-	v0 = rowGetSolution(p->rowK) - rowGetSolution(p->rowJ);
-	ReturnErrIf(isnan(v0));
+	Debug("Loading %s %s %p", r->class->type, r->refdes, r);
 
-	ReturnErrIf(integratorNextStep(p->integrator, v0, minStep));
+	/* Modified Nodal Analysis Stamp (Open)
+	 *	                  	+      -
+	 *	  |_Vk_Vj_|_rhs_|	--o  o--
+	 *	k | -- -- | --  |	k      j
+	 *	j | -- -- | --  |
+	 */
 
 	return 0;
 }
 
 /*---------------------------------------------------------------------------*/
 
-static int deviceClassIntegrate(device_ *r)
+static int deviceClassPrint(device_ *r)
 {
 	devicePrivate_ *p;
-	double Ieq, G, v0;
-
 	ReturnErrIf(r == NULL);
 	p = r->private;
 	ReturnErrIf(p == NULL);
 
-	Debug("Integrating %s %s %p", r->class->type, r->refdes, r);
+	Debug("Printing %s %s %p", r->class->type, r->refdes, r);
 
-	/* Modified Nodal Analysis Stamp
-	 *				          +    Gn    -
-	 *	  |_Vk__Vj_|_rhs_|	  +--/\/\/\--+
-	 *	k | Gn -Gn | Ieq |	k_|    __    |_j
-	 *	j | -Gn Gn |-Ieq |	  |__ /  \___|
-	 *	   					      \__/
-	 *	        				   Ieq
-	 */
+	Info("%s -- %s %s -> %s; C = %gF", r->class->type, r->refdes,
+			rowGetName(r->pin[K]), rowGetName(r->pin[J]),
+			*p->C);
+
+	return 0;
+}
 
-	v0 = rowGetSolution(p->rowK) - rowGetSolution(p->rowJ);
-	ReturnErrIf(isnan(v0));
+/*===========================================================================
+ |                              Batch Functions                              |
+  ===========================================================================*/
 
-	ReturnErrIf(integratorIntegrate(p->integrator, v0, &G, &Ieq));
+static int deviceBatchVoltage(deviceBatch_ *r)
+{
+	int i;
 
-	/* Set-up Matrices based on MNA Stamp Above*/
-	ReturnErrIf(nodeDataPlus(p->nodeKK, G - p->G));
-	ReturnErrIf(nodeDataPlus(p->nodeKJ, -(G - p->G)));
-	ReturnErrIf(nodeDataPlus(p->nodeJK, -(G - p->G)));
-	ReturnErrIf(nodeDataPlus(p->nodeJJ, G - p->G));
-	p->G = G;
-	ReturnErrIf(rowRHSPlus(p->rowK, Ieq - p->Ieq));
-	ReturnErrIf(rowRHSPlus(p->rowJ, -(Ieq - p->Ieq)));
-	p->Ieq = Ieq;
+	for(i = 0; i < r->length; i++) {
+		r->v0[i] = StampSolution(r->stamp[i], K) -
+				StampSolution(r->stamp[i], J);
+	}
 
 	return 0;
 }
 
 /*---------------------------------------------------------------------------*/
 
-static int deviceClassInitStep(device_ *r)
+static int deviceBatchMinStep(deviceBatch_ *r, double *minStep)
 {
-	devicePrivate_ *p;
-	double v0;
-
 	ReturnErrIf(r == NULL);
-	p = r->private;
-	ReturnErrIf(p == NULL);
-
-	Debug("Initializing Stepping %s %s %p", r->class->type, r->refdes, r);
 
-	/* Set Initial Conditions (based on Opertaing Point results) */
-	v0 = rowGetSolution(p->rowK) - rowGetSolution(p->rowJ);
-	ReturnErrIf(isnan(v0));
+	Debug("Calc Min Step %i Capacitors", r->length);
 
-	ReturnErrIf(integratorInitialize(p->integrator, v0, p->C));
+	ReturnErrIf(deviceBatchVoltage(r));
+	ReturnErrIf(integratorBankNextStep(r->integrator, r->v0, minStep));
 
 	return 0;
 }
 
 /*---------------------------------------------------------------------------*/
 
-static int deviceClassLoad(device_ *r)
+static int deviceBatchIntegrate(deviceBatch_ *r)
 {
-	devicePrivate_ *p;
-	ReturnErrIf(r == NULL);
-	p = r->private;
-	ReturnErrIf(p == NULL);
+	stamp_ *stamp;
+	int i;
 
-	Debug("Loading %s %s %p", r->class->type, r->refdes, r);
+	ReturnErrIf(r == NULL);
 
-	/* Initialise / Reset State Data */
-	p->G = 0;
-	p->Ieq = 0;
+	Debug("Integrating %i Capacitors", r->length);
 
-	/* Modified Nodal Analysis Stamp (Open)
-	 *	                  	+      -
-	 *	  |_Vk_Vj_|_rhs_|	--o  o--
-	 *	k | -- -- | --  |	k      j
-	 *	j | -- -- | --  |
+	/* Modified Nodal Analysis Stamp
+	 *				          +    Gn    -
+	 *	  |_Vk__Vj_|_rhs_|	  +--/\/\/\--+
+	 *	k | Gn -Gn | Ieq |	k_|    __    |_j
+	 *	j | -Gn Gn |-Ieq |	  |__ /  \___|
+	 *	   					      \__/
+	 *	        				   Ieq
 	 */
 
+	ReturnErrIf(deviceBatchVoltage(r));
+	ReturnErrIf(integratorBankIntegrate(r->integrator, r->v0, r->G, r->Ieq));
+
+	/* Set-up Matrices based on MNA Stamp Above*/
+	for(i = 0; i < r->length; i++) {
+		stamp = r->stamp[i];
+		StampValue(stamp, KK, r->G[i]);
+		StampValue(stamp, KJ, -r->G[i]);
+		StampValue(stamp, JK, -r->G[i]);
+		StampValue(stamp, JJ, r->G[i]);
+		StampRHSValue(stamp, K, r->Ieq[i]);
+		StampRHSValue(stamp, J, -r->Ieq[i]);
+	}
+
 	return 0;
 }
 
 /*---------------------------------------------------------------------------*/
 
-static int deviceClassUnconfig(device_ *r)
+static int deviceBatchInitStep(deviceBatch_ *r)
 {
-	devicePrivate_ *p;
 	ReturnErrIf(r == NULL);
-	p = r->private;
-	ReturnErrIf(p == NULL);
 
-	Debug("Unconfiging %s %s %p", r->class->type, r->refdes, r);
+	Debug("Initializing Stepping %i Capacitors", r->length);
 
-	if(p->integrator != NULL) {
-		if(integratorDestroy(&p->integrator)) {
-			Warn("Error destroying integrator");
-		}
-	}
+	/* Set Initial Conditions (based on Opertaing Point results) */
+	ReturnErrIf(deviceBatchVoltage(r));
+	ReturnErrIf(integratorBankInitialize(r->integrator, r->v0));
 
 	return 0;
 }
 
 /*---------------------------------------------------------------------------*/
 
-static int deviceClassPrint(device_ *r)
+static int deviceBatchDestroy(deviceBatch_ **r)
 {
-	devicePrivate_ *p;
 	ReturnErrIf(r == NULL);
-	p = r->private;
-	ReturnErrIf(p == NULL);
+	ReturnErrIf(*r == NULL);
 
-	Debug("Printing %s %s %p", r->class->type, r->refdes, r);
+	if((*r)->integrator != NULL) {
+		if(integratorBankDestroy(&(*r)->integrator)) {
+			Warn("Error destroying integrator");
+		}
+	}
+	if((*r)->stamp != NULL)
+		free((*r)->stamp);
+	if((*r)->v0 != NULL)
+		free((*r)->v0);
+	if((*r)->G != NULL)
+		free((*r)->G);
+	if((*r)->Ieq != NULL)
+		free((*r)->Ieq);
+
+	free(*r);
+	*r = NULL;
+	return 0;
+}
 
-	Info("%s -- %s %s -> %s; C = %gF", r->class->type, r->refdes,
-			rowGetName(r->pin[K]), rowGetName(r->pin[J]),
-			*p->C);
+/*---------------------------------------------------------------------------*/
 
-	return 0;
+static deviceBatch_ * deviceBatchNew(device_ **devices, int numDevices)
+{
+	deviceBatch_ *r;
+	double **C = NULL;
+	int i;
+
+	ReturnNULLIf(devices == NULL);
+	ReturnNULLIf(numDevices < 1);
+
+	r = calloc(1, sizeof(deviceBatch_));
+	ReturnNULLIf(r == NULL);
+
+	r->length = numDevices;
+	r->stamp = malloc(numDevices * sizeof(stamp_*));
+	GotoFailedIf(r->stamp == NULL);
+	r->v0 = calloc(numDevices, sizeof(double));
+	GotoFailedIf(r->v0 == NULL);
+	r->G = calloc(numDevices, sizeof(double));
+	GotoFailedIf(r->G == NULL);
+	r->Ieq = calloc(numDevices, sizeof(double));
+	GotoFailedIf(r->Ieq == NULL);
+	C = malloc(numDevices * sizeof(double*));
+	GotoFailedIf(C == NULL);
+
+	for(i = 0; i < numDevices; i++) {
+		GotoFailedIf(devices[i]->private == NULL);
+		r->stamp[i] = devices[i]->private->stamp;
+		C[i] = devices[i]->private->C;
+	}
+
+	/* Create numerical integration object */
+	r->integrator = integratorBankNew(r->integrator, devices[0]->control,
+			numDevices, C, 'V');
+	GotoFailedIf(r->integrator == NULL);
+
+	free(C);
+	return r;
+
+failed:
+	if(C != NULL)
+		free(C);
+	deviceBatchDestroy(&r);
+	return NULL;
 }
 
 /*===========================================================================
@@ -201,15 +257,21 @@ static int deviceClassPrint(device_ *r)
 
 deviceClass_ deviceCapacitor = {
 	.type = "Capacitor",
-	.unconfig = deviceClassUnconfig,
+	.unconfig = NULL,
 	.load = deviceClassLoad,
 	.linearize = NULL,
-	.initStep = deviceClassInitStep,
+	.initStep = NULL,
 	.step = NULL,
-	.minStep = deviceClassMinStep,
-	.nextStep = NULL,
-	.integrate = deviceClassIntegrate,
+	.minStep = NULL,
+	.nextBreak = NULL,
+	.delay = NULL,
+	.integrate = NULL,
 	.print = deviceClassPrint,
+	.batchNew = deviceBatchNew,
+	.batchDestroy = deviceBatchDestroy,
+	.batchInitStep = deviceBatchInitStep,
+	.batchMinStep = deviceBatchMinStep,
+	.batchIntegrate = deviceBatchIntegrate,
 };
 
 /*===========================================================================
@@ -219,6 +281,7 @@ deviceClass_ deviceCapacitor = {
 int deviceCapacitorConfig(device_ *r, double *capacitance)
 {
 	devicePrivate_ *p;
+	node_ *nodes[4];
 
 	ReturnErrIf(r == NULL);
 	ReturnErrIf(r->class != NULL);
@@ -238,23 +301,17 @@ int deviceCapacitorConfig(device_ *r, double *capacitance)
 	p->C = capacitance;
 	ReturnErrIf(p->C == NULL);
 
-	/* Create numerical integration object */
-	p->integrator = integratorNew(p->integrator, r->control, p->C, 'V');
-	ReturnErrIf(p->integrator == NULL);
-
 	/* Create required nodes and rows (see MNA stamp above) */
-	p->rowK = r->pin[K];
-	ReturnErrIf(p->rowK == NULL);
-	p->rowJ = r->pin[J];
-	ReturnErrIf(p->rowJ == NULL);
-	p->nodeKK = matrixFindOrAddNode(r->matrix, p->rowK, p->rowK);
-	ReturnErrIf(p->nodeKK == NULL);
-	p->nodeJK = matrixFindOrAddNode(r->matrix, p->rowJ, p->rowK);
-	ReturnErrIf(p->nodeJK == NULL);
-	p->nodeKJ = matrixFindOrAddNode(r->matrix, p->rowK, p->rowJ);
-	ReturnErrIf(p->nodeKJ == NULL);
-	p->nodeJJ = matrixFindOrAddNode(r->matrix, p->rowJ, p->rowJ);
-	ReturnErrIf(p->nodeJJ == NULL);
+	nodes[KK] = matrixFindOrAddNode(r->matrix, r->pin[K], r->pin[K]);
+	ReturnErrIf(nodes[KK] == NULL);
+	nodes[JK] = matrixFindOrAddNode(r->matrix, r->pin[J], r->pin[K]);
+	ReturnErrIf(nodes[JK] == NULL);
+	nodes[KJ] = matrixFindOrAddNode(r->matrix, r->pin[K], r->pin[J]);
+	ReturnErrIf(nodes[KJ] == NULL);
+	nodes[JJ] = matrixFindOrAddNode(r->matrix, r->pin[J], r->pin[J]);
+	ReturnErrIf(nodes[JJ] == NULL);
+	p->stamp = matrixAddStamp(r->matrix, 4, nodes, NP, r->pin, 1);
+	ReturnErrIf(p->stamp == NULL);
 
 	return 0;
 }
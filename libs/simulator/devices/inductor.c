@@ -30,174 +30,229 @@
 #define J			1
 #define NP			2
 
+/* Stamp Rows (pins first) */
+#define IR			2
+
+/* Stamp Entries */
+#define RK			0
+#define RJ			1
+#define KR			2
+#define JR			3
+#define RR			4
+
 /*===========================================================================
  |                            Private Structure                              |
   ===========================================================================*/
 
 struct _devicePrivate {
 	double *L;		/* Inductance (Henry) */
-	double R;		/* Resistance (Ohm) */
-	double Veq;		/* Equalization Voltage (Volt) */
-	integrator_ *integrator;
-	row_ *rowK;
-	row_ *rowJ;
-	row_ *rowR;
-	node_ *nodeRK;
-	node_ *nodeRJ;
-	node_ *nodeKR;
-	node_ *nodeJR;
-	node_ *nodeRR;
+	stamp_ *stamp;
+};
+
+/* Every inductor in the circuit, integrated together */
+struct _deviceBatch {
+	int length;
+	stamp_ **stamp;
+	double *i0;
+	double *R;
+	double *Veq;
+	integratorBank_ *integrator;
 };
 
 /*===========================================================================
  |                             Class Functions                               |
   ===========================================================================*/
 
-static int deviceClassMinStep(device_ *r, double *minStep)
+static int deviceClassLoad(device_ *r)
 {
 	devicePrivate_ *p;
-	double i0;
-
 	ReturnErrIf(r == NULL);
 	p = r->private;
 	ReturnErrIf(p == NULL);
 
-	Debug("Calc Min Step %s %s %p", r->class->type, r->refdes, r);
+	Debug("Loading %s %s %p", r->class->type, r->refdes, r);
 
-	i0 = rowGetSolution(p->rowR);
-	ReturnErrIf(isnan(i0));
+	/* Modified Nodal Analysis Stamp (Short)
+	 *	                     	+      -
+	 *	  |_Vk_Vj_Ir_|_rhs_|	________
+	 *	k | -- --  1 | --  |	k      j
+	 *	j | -- -- -1 | --  |
+	 *	r |  1 -1 -- | --  |	------->
+	 *	                    	   Ir
+	 */
 
-	ReturnErrIf(integratorNextStep(p->integrator, i0, minStep));
+	StampSet(p->stamp, RK, 1.0);
+	StampSet(p->stamp, RJ, -1.0);
+	StampSet(p->stamp, KR, 1.0);
+	StampSet(p->stamp, JR, -1.0);
 
 	return 0;
 }
 
 /*---------------------------------------------------------------------------*/
 
-static int deviceClassIntegrate(device_ *r)
+static int deviceClassPrint(device_ *r)
 {
 	devicePrivate_ *p;
-	double Veq, R, i0;
-
 	ReturnErrIf(r == NULL);
 	p = r->private;
 	ReturnErrIf(p == NULL);
 
-	Debug("Integrating %s %s %p", r->class->type, r->refdes, r);
+	Debug("Printing %s %s %p", r->class->type, r->refdes, r);
 
-	/* Modified Nodal Analysis Stamp
-	 *
-	 *	  |_Vk_Vj_Ir_|_rhs_|
-	 *	k | -- --  1 | --  |	 +    /\     Rn    -
-	 *	j | -- -- -1 | --  |	 k__ /  \__/\/\/\__j
-	 *	r | 1  -1 -Rn|-Veq |	     \  /
-	 *	        				      \/ Veq
-	 */
+	Info("%s -- %s %s -> %s; L = %gH", r->class->type, r->refdes,
+			rowGetName(r->pin[K]), rowGetName(r->pin[J]),
+			*p->L);
+
+	return 0;
+}
 
-	i0 = rowGetSolution(p->rowR);
-	ReturnErrIf(isnan(i0));
+/*===========================================================================
+ |                              Batch Functions                              |
+  ===========================================================================*/
 
-	ReturnErrIf(integratorIntegrate(p->integrator, i0, &R, &Veq));
+static int deviceBatchCurrent(deviceBatch_ *r)
+{
+	int i;
 
-	/* Set-up Matrices based on MNA Stamp Above*/
-	ReturnErrIf(nodeDataPlus(p->nodeRR, -(R - p->R)));
-	p->R = R;
-	ReturnErrIf(rowRHSPlus(p->rowR, -(Veq - p->Veq)));
-	p->Veq = Veq;
+	for(i = 0; i < r->length; i++) {
+		r->i0[i] = StampSolution(r->stamp[i], IR);
+	}
 
 	return 0;
 }
 
 /*---------------------------------------------------------------------------*/
 
-static int deviceClassInitStep(device_ *r)
+static int deviceBatchMinStep(deviceBatch_ *r, double *minStep)
 {
-	devicePrivate_ *p;
-	double i0;
-
 	ReturnErrIf(r == NULL);
-	p = r->private;
-	ReturnErrIf(p == NULL);
-
-	Debug("Initializing Stepping %s %s %p", r->class->type, r->refdes, r);
 
-	/* Set Initial Conditions (based on Opertaing Point results) */
-	i0 = rowGetSolution(p->rowR);
-	ReturnErrIf(isnan(i0));
+	Debug("Calc Min Step %i Inductors", r->length);
 
-	ReturnErrIf(integratorInitialize(p->integrator, i0, p->L));
+	ReturnErrIf(deviceBatchCurrent(r));
+	ReturnErrIf(integratorBankNextStep(r->integrator, r->i0, minStep));
 
 	return 0;
 }
 
 /*---------------------------------------------------------------------------*/
 
-static int deviceClassLoad(device_ *r)
+static int deviceBatchIntegrate(deviceBatch_ *r)
 {
-	devicePrivate_ *p;
-	ReturnErrIf(r == NULL);
-	p = r->private;
-	ReturnErrIf(p == NULL);
+	int i;
 
-	Debug("Loading %s %s %p", r->class->type, r->refdes, r);
+	ReturnErrIf(r == NULL);
 
-	/* Initialise / Reset State Data */
-	p->R = 0;
-	p->Veq = 0;
+	Debug("Integrating %i Inductors", r->length);
 
-	/* Modified Nodal Analysis Stamp (Short)
-	 *	                     	+      -
-	 *	  |_Vk_Vj_Ir_|_rhs_|	________
-	 *	k | -- --  1 | --  |	k      j
-	 *	j | -- -- -1 | --  |
-	 *	r |  1 -1 -- | --  |	------->
-	 *	                    	   Ir
+	/* Modified Nodal Analysis Stamp
+	 *
+	 *	  |_Vk_Vj_Ir_|_rhs_|
+	 *	k | -- --  1 | --  |	 +    /\     Rn    -
+	 *	j | -- -- -1 | --  |	 k__ /  \__/\/\/\__j
+	 *	r | 1  -1 -Rn|-Veq |	     \  /
+	 *	        				      \/ Veq
 	 */
 
-	ReturnErrIf(nodeDataSet(p->nodeRK, 1.0));
-	ReturnErrIf(nodeDataSet(p->nodeRJ, -1.0));
-	ReturnErrIf(nodeDataSet(p->nodeKR, 1.0));
-	ReturnErrIf(nodeDataSet(p->nodeJR, -1.0));
+	ReturnErrIf(deviceBatchCurrent(r));
+	ReturnErrIf(integratorBankIntegrate(r->integrator, r->i0, r->R, r->Veq));
+
+	/* Set-up Matrices based on MNA Stamp Above*/
+	for(i = 0; i < r->length; i++) {
+		StampValue(r->stamp[i], RR, -r->R[i]);
+		StampRHSValue(r->stamp[i], IR, -r->Veq[i]);
+	}
 
 	return 0;
 }
 
 /*---------------------------------------------------------------------------*/
 
-static int deviceClassUnconfig(device_ *r)
+static int deviceBatchInitStep(deviceBatch_ *r)
 {
-	devicePrivate_ *p;
 	ReturnErrIf(r == NULL);
-	p = r->private;
-	ReturnErrIf(p == NULL);
 
-	Debug("Unconfiging %s %s %p", r->class->type, r->refdes, r);
+	Debug("Initializing Stepping %i Inductors", r->length);
 
-	if(p->integrator != NULL) {
-		if(integratorDestroy(&p->integrator)) {
-			Warn("Error destroying integrator");
-		}
-	}
+	/* Set Initial Conditions (based on Opertaing Point results) */
+	ReturnErrIf(deviceBatchCurrent(r));
+	ReturnErrIf(integratorBankInitialize(r->integrator, r->i0));
 
 	return 0;
 }
 
 /*---------------------------------------------------------------------------*/
 
-static int deviceClassPrint(device_ *r)
+static int deviceBatchDestroy(deviceBatch_ **r)
 {
-	devicePrivate_ *p;
 	ReturnErrIf(r == NULL);
-	p = r->private;
-	ReturnErrIf(p == NULL);
+	ReturnErrIf(*r == NULL);
 
-	Debug("Printing %s %s %p", r->class->type, r->refdes, r);
+	if((*r)->integrator != NULL) {
+		if(integratorBankDestroy(&(*r)->integrator)) {
+			Warn("Error destroying integrator");
+		}
+	}
+	if((*r)->stamp != NULL)
+		free((*r)->stamp);
+	if((*r)->i0 != NULL)
+		free((*r)->i0);
+	if((*r)->R != NULL)
+		free((*r)->R);
+	if((*r)->Veq != NULL)
+		free((*r)->Veq);
+
+	free(*r);
+	*r = NULL;
+	return 0;
+}
 
-	Info("%s -- %s %s -> %s; L = %gH", r->class->type, r->refdes,
-			rowGetName(r->pin[K]), rowGetName(r->pin[J]),
-			*p->L);
+/*---------------------------------------------------------------------------*/
 
-	return 0;
+static deviceBatch_ * deviceBatchNew(device_ **devices, int numDevices)
+{
+	deviceBatch_ *r;
+	double **L = NULL;
+	int i;
+
+	ReturnNULLIf(devices == NULL);
+	ReturnNULLIf(numDevices < 1);
+
+	r = calloc(1, sizeof(deviceBatch_));
+	ReturnNULLIf(r == NULL);
+
+	r->length = numDevices;
+	r->stamp = malloc(numDevices * sizeof(stamp_*));
+	GotoFailedIf(r->stamp == NULL);
+	r->i0 = calloc(numDevices, sizeof(double));
+	GotoFailedIf(r->i0 == NULL);
+	r->R = calloc(numDevices, sizeof(double));
+	GotoFailedIf(r->R == NULL);
+	r->Veq = calloc(numDevices, sizeof(double));
+	GotoFailedIf(r->Veq == NULL);
+	L = malloc(numDevices * sizeof(double*));
+	GotoFailedIf(L == NULL);
+
+	for(i = 0; i < numDevices; i++) {
+		GotoFailedIf(devices[i]->private == NULL);
+		r->stamp[i] = devices[i]->private->stamp;
+		L[i] = devices[i]->private->L;
+	}
+
+	/* Create numerical integration object */
+	r->integrator = integratorBankNew(r->integrator, devices[0]->control,
+			numDevices, L, 'A');
+	GotoFailedIf(r->integrator == NULL);
+
+	free(L);
+	return r;
+
+failed:
+	if(L != NULL)
+		free(L);
+	deviceBatchDestroy(&r);
+	return NULL;
 }
 
 /*===========================================================================
@@ -206,15 +261,21 @@ static int deviceClassPrint(device_ *r)
 
 deviceClass_ deviceInductor = {
 	.type = "Inductor",
-	.unconfig = deviceClassUnconfig,
+	.unconfig = NULL,
 	.load = deviceClassLoad,
 	.linearize = NULL,
-	.initStep = deviceClassInitStep,
+	.initStep = NULL,
 	.step = NULL,
-	.minStep = deviceClassMinStep,
-	.nextStep = NULL,
-	.integrate = deviceClassIntegrate,
+	.minStep = NULL,
+	.nextBreak = NULL,
+	.delay = NULL,
+	.integrate = NULL,
 	.print = deviceClassPrint,
+	.batchNew = deviceBatchNew,
+	.batchDestroy = deviceBatchDestroy,
+	.batchInitStep = deviceBatchInitStep,
+	.batchMinStep = deviceBatchMinStep,
+	.batchIntegrate = deviceBatchIntegrate,
 };
 
 /*===========================================================================
@@ -224,6 +285,8 @@ deviceClass_ deviceInductor = {
 int deviceInductorConfig(device_ *r, double *inductance)
 {
 	devicePrivate_ *p;
+	node_ *nodes[5];
+	row_ *rows[3];
 
 	ReturnErrIf(r == NULL);
 	ReturnErrIf(r->class != NULL);
@@ -243,27 +306,23 @@ int deviceInductorConfig(device_ *r, double *inductance)
 	p->L = inductance;
 	ReturnErrIf(p->L == NULL);
 
-	/* Create numerical integration object */
-	p->integrator = integratorNew(p->integrator, r->control, p->L, 'A');
-	ReturnErrIf(p->integrator == NULL);
-
 	/* Create required nodes and rows (see MNA stamp above) */
-	p->rowR = matrixFindOrAddRow(r->matrix, 'i', r->refdes);
-	ReturnErrIf(p->rowR == NULL);
-	p->rowK = r->pin[K];
-	ReturnErrIf(p->rowK == NULL);
-	p->rowJ = r->pin[J];
-	ReturnErrIf(p->rowJ == NULL);
-	p->nodeRK = matrixFindOrAddNode(r->matrix, p->rowR, p->rowK);
-	ReturnErrIf(p->nodeRK == NULL);
-	p->nodeRJ = matrixFindOrAddNode(r->matrix, p->rowR, p->rowJ);
-	ReturnErrIf(p->nodeRJ == NULL);
-	p->nodeKR = matrixFindOrAddNode(r->matrix, p->rowK, p->rowR);
-	ReturnErrIf(p->nodeKR == NULL);
-	p->nodeJR = matrixFindOrAddNode(r->matrix, p->rowJ, p->rowR);
-	ReturnErrIf(p->nodeJR == NULL);
-	p->nodeRR = matrixFindOrAddNode(r->matrix, p->rowR, p->rowR);
-	ReturnErrIf(p->nodeJR == NULL);
+	rows[K] = r->pin[K];
+	rows[J] = r->pin[J];
+	rows[IR] = matrixFindOrAddRow(r->matrix, 'i', r->refdes);
+	ReturnErrIf(rows[IR] == NULL);
+	nodes[RK] = matrixFindOrAddNode(r->matrix, rows[IR], rows[K]);
+	ReturnErrIf(nodes[RK] == NULL);
+	nodes[RJ] = matrixFindOrAddNode(r->matrix, rows[IR], rows[J]);
+	ReturnErrIf(nodes[RJ] == NULL);
+	nodes[KR] = matrixFindOrAddNode(r->matrix, rows[K], rows[IR]);
+	ReturnErrIf(nodes[KR] == NULL);
+	nodes[JR] = matrixFindOrAddNode(r->matrix, rows[J], rows[IR]);
+	ReturnErrIf(nodes[JR] == NULL);
+	nodes[RR] = matrixFindOrAddNode(r->matrix, rows[IR], rows[IR]);
+	ReturnErrIf(nodes[RR] == NULL);
+	p->stamp = matrixAddStamp(r->matrix, 5, nodes, 3, rows, 1);
+	ReturnErrIf(p->stamp == NULL);
 
 	return 0;
 }
@@ -25,6 +25,7 @@
 #include <log.h>
 
 #include "integrator.h"
+#include "checkbypass.h"
 #include "checklinear.h"
 #include "device_internal.h"
 
@@ -64,6 +65,7 @@ struct _devicePrivate {
 	double Ceq;		/* Equalization Value (Farads) */
 	double CeqCalc;
 	checklinear_ *checklinear;
+	checkbypass_ *checkbypass;
 	calc_ *calc;
 	list_ *variables;
 	row_ *rowR;
@@ -120,6 +122,15 @@ static int deviceNonlinearLoad(devicePrivate_ *p)
 
 /*---------------------------------------------------------------------------*/
 
+static int deviceNonlinearAddBypassInput(variable_ *r,
+		checkbypass_ *checkbypass)
+{
+	ReturnErrIf(checkbypassAddInput(checkbypass, r->row, NULL, 0x0, &r->R));
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
 /* -------------------------------------------------------------------------
  * Call-Back sent to Calc Library, called during equation parsing,
  * Calc is asking for pointers to pointers to the values of variables
@@ -182,6 +193,9 @@ static int deviceClassStep(device_ *r, int *breakPoint)
 	ReturnErrIf(p == NULL);
 
 	if(p->time != NULL) {
+		/* The value moves with time so the bypass record is stale */
+		ReturnErrIf(checkbypassInitialize(p->checkbypass));
+
 		Debug("Stepping %s %s %p", r->class->type, r->refdes, r);
 
 		ReturnErrIf(deviceNonlinearCalculate(p));
@@ -197,16 +211,35 @@ static int deviceClassStep(device_ *r, int *breakPoint)
 static int deviceClassLinearize(device_ *r, int *linear)
 {
 	devicePrivate_ *p;
+	int bypass;
 	ReturnErrIf(r == NULL);
 	p = r->private;
 	ReturnErrIf(p == NULL);
 
 	Debug("Linearizing %s %s %p", r->class->type, r->refdes, r);
+
+	/* Keep the last stamp if neither the inputs nor the value they
+	 * predict have moved
+	 */
+	bypass = checkbypassIsBypass(p->checkbypass);
+	ReturnErrIf(bypass < 0);
+	if(bypass) {
+		p->Cn = rowGetSolution(p->rowC);
+		ReturnErrIf(isnan(p->Cn));
+		*linear = checklinearIsLinear(p->checklinear, p->Cn, p->Cc);
+		ReturnErrIf(*linear < 0);
+		ReturnErrIf(checkbypassConverged(p->checkbypass,
+				checklinearPassed(p->checklinear)));
+		return 0;
+	}
+
 	ReturnErrIf(deviceNonlinearCalculate(p));
 
 	/* Check convergence */
 	*linear = checklinearIsLinear(p->checklinear, p->Cn, p->Cc);
 	ReturnErrIf(*linear < 0);
+	ReturnErrIf(checkbypassRecord(p->checkbypass, p->Cc,
+			checklinearPassed(p->checklinear)));
 
 	/* If not linear update conductances to try again */
 	if(!(*linear)) {
@@ -313,6 +346,7 @@ static int deviceClassLoad(device_ *r)
 
 	/* Initialise / Reset State Data */
 	ReturnErrIf(checklinearInitialize(p->checklinear, 0.0));
+	ReturnErrIf(checkbypassInitialize(p->checkbypass));
 	p->Cc = 0.0;
 	p->Cn = 0.0;
 	p->Ceq = 0.0;
@@ -375,6 +409,13 @@ static int deviceClassUnconfig(device_ *r)
 		}
 	}
 
+	if(p->checkbypass != NULL) {
+		if(checkbypassDestroy(&p->checkbypass)) {
+			Warn("Error destroying bypass check");
+		}
+	}
+
+
 	if(p->integrator != NULL) {
 		if(integratorDestroy(&p->integrator)) {
 			Warn("Error destroying integrator");
@@ -414,7 +455,8 @@ deviceClass_ deviceVoltageControlledCap = {
 	.initStep = deviceClassInitStep,
 	.step = deviceClassStep,
 	.minStep = deviceClassMinStep,
-	.nextStep = NULL,
+	.nextBreak = NULL,
+	.delay = NULL,
 	.integrate = deviceClassIntegrate,
 	.print = deviceClassPrint,
 };
@@ -489,6 +531,14 @@ int deviceNonlinearCapacitorConfig(device_ *r, char *equation)
 			(calcGetVarPtr_)deviceNonlinearGetVariable, r, &r->control->gmin);
 	ReturnErrIf(p->calc == NULL, "Bad B equation: \n%s", equation);
 
+	/* Setup the bypass checking object, the inputs are the present value
+	 * followed by the variables found while parsing the equation */
+	p->checkbypass = checkbypassNew(p->checkbypass, r->control, 'F');
+	ReturnErrIf(p->checkbypass == NULL);
+	ReturnErrIf(checkbypassAddInput(p->checkbypass, p->rowC, NULL, 'F', NULL));
+	ReturnErrIf(listExecute(p->variables,
+			(listExecute_)deviceNonlinearAddBypassInput, p->checkbypass));
+
 	return 0;
 }
 
@@ -25,6 +25,7 @@
 #include <data.h>
 
 #include "checkbreak.h"
+#include "checkbypass.h"
 #include "checklinear.h"
 #include "device_internal.h"
 
@@ -53,6 +54,7 @@ struct _devicePrivate {
 	double Ieq;		/* Equalization Value (Amps) */
 	double IeqCalc;
 	checklinear_ *checklinear;
+	checkbypass_ *checkbypass;
 	checkbreak_ *checkbreak;
 	calc_ *calc;
 	list_ *variables;
@@ -141,6 +143,15 @@ static int deviceNonlinearLoad(devicePrivate_ *p)
 
 /*---------------------------------------------------------------------------*/
 
+static int deviceNonlinearAddBypassInput(variable_ *r,
+		checkbypass_ *checkbypass)
+{
+	ReturnErrIf(checkbypassAddInput(checkbypass, r->row, NULL, 0x0, &r->G));
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
 /* -------------------------------------------------------------------------
  * Call-Back sent to Calc Library, called during equation parsing,
  * Calc is asking for pointers to pointers to the values of variables
@@ -206,6 +217,9 @@ static int deviceClassStep(device_ *r, int *breakPoint)
 	ReturnErrIf(p == NULL);
 
 	if(p->time != NULL) {
+		/* The value moves with time so the bypass record is stale */
+		ReturnErrIf(checkbypassInitialize(p->checkbypass));
+
 		Debug("Stepping %s %s %p", r->class->type, r->refdes, r);
 
 		ReturnErrIf(deviceNonlinearCalculateInitial(p));
@@ -224,16 +238,35 @@ static int deviceClassStep(device_ *r, int *breakPoint)
 static int deviceClassLinearize(device_ *r, int *linear)
 {
 	devicePrivate_ *p;
+	int bypass;
 	ReturnErrIf(r == NULL);
 	p = r->private;
 	ReturnErrIf(p == NULL);
 
 	Debug("Linearizing %s %s %p", r->class->type, r->refdes, r);
+
+	/* Keep the last stamp if neither the inputs nor the value they
+	 * predict have moved
+	 */
+	bypass = checkbypassIsBypass(p->checkbypass);
+	ReturnErrIf(bypass < 0);
+	if(bypass) {
+		p->In = rowGetSolution(p->rowR);
+		ReturnErrIf(isnan(p->In));
+		*linear = checklinearIsLinear(p->checklinear, p->In, p->Ic);
+		ReturnErrIf(*linear < 0);
+		ReturnErrIf(checkbypassConverged(p->checkbypass,
+				checklinearPassed(p->checklinear)));
+		return 0;
+	}
+
 	ReturnErrIf(deviceNonlinearCalculate(p));
 
 	/* Check convergence */
 	*linear = checklinearIsLinear(p->checklinear, p->In, p->Ic);
 	ReturnErrIf(*linear < 0);
+	ReturnErrIf(checkbypassRecord(p->checkbypass, p->Ic,
+			checklinearPassed(p->checklinear)));
 
 	/* If not linear update conductances to try again */
 	if(!(*linear)) {
@@ -256,6 +289,7 @@ static int deviceClassLoad(device_ *r)
 
 	/* Initialise / Reset State Data */
 	ReturnErrIf(checklinearInitialize(p->checklinear, 0.0));
+	ReturnErrIf(checkbypassInitialize(p->checkbypass));
 	ReturnErrIf(checkbreakInitialize(p->checkbreak, 0.0));
 	p->Ic = 0.0;
 	p->In = 0.0;
@@ -321,6 +355,12 @@ static int deviceClassUnconfig(device_ *r)
 		}
 	}
 
+	if(p->checkbypass != NULL) {
+		if(checkbypassDestroy(&p->checkbypass)) {
+			Warn("Error destroying bypass check");
+		}
+	}
+
 	return 0;
 }
 
@@ -354,7 +394,8 @@ deviceClass_ deviceNonlinearCurrent = {
 	.initStep = NULL,
 	.step = deviceClassStep,
 	.minStep = NULL,
-	.nextStep = NULL,
+	.nextBreak = NULL,
+	.delay = NULL,
 	.integrate = NULL,
 	.print = deviceClassPrint,
 };
@@ -421,6 +462,14 @@ int deviceNonlinearCurrentConfig(device_ *r, char *equation)
 			(calcGetVarPtr_)deviceNonlinearGetVariable, r, &r->control->gmin);
 	ReturnErrIf(p->calc == NULL, "Bad B equation: \n%s", equation);
 
+	/* Setup the bypass checking object, the inputs are the present value
+	 * followed by the variables found while parsing the equation */
+	p->checkbypass = checkbypassNew(p->checkbypass, r->control, 'A');
+	ReturnErrIf(p->checkbypass == NULL);
+	ReturnErrIf(checkbypassAddInput(p->checkbypass, p->rowR, NULL, 'A', NULL));
+	ReturnErrIf(listExecute(p->variables,
+			(listExecute_)deviceNonlinearAddBypassInput, p->checkbypass));
+
 	return 0;
 }
 
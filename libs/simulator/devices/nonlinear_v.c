@@ -25,6 +25,7 @@
 #include <data.h>
 
 #include "checkbreak.h"
+#include "checkbypass.h"
 #include "checklinear.h"
 #include "device_internal.h"
 
@@ -52,6 +53,7 @@ struct _devicePrivate {
 	double Veq;		/* Equalization Value (Volts) */
 	double VeqCalc;
 	checklinear_ *checklinear;
+	checkbypass_ *checkbypass;
 	checkbreak_ *checkbreak;
 	calc_ *calc;
 	list_ *variables;
@@ -112,6 +114,15 @@ static int deviceNonlinearLoad(devicePrivate_ *p)
 
 /*---------------------------------------------------------------------------*/
 
+static int deviceNonlinearAddBypassInput(variable_ *r,
+		checkbypass_ *checkbypass)
+{
+	ReturnErrIf(checkbypassAddInput(checkbypass, r->row, NULL, 0x0, &r->R));
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
 /* -------------------------------------------------------------------------
  * Call-Back sent to Calc Library, called during equation parsing,
  * Calc is asking for pointers to pointers to the values of variables
@@ -174,6 +185,9 @@ static int deviceClassStep(device_ *r, int *breakPoint)
 	ReturnErrIf(p == NULL);
 
 	if(p->time != NULL) {
+		/* The value moves with time so the bypass record is stale */
+		ReturnErrIf(checkbypassInitialize(p->checkbypass));
+
 		Debug("Stepping %s %s %p", r->class->type, r->refdes, r);
 
 		ReturnErrIf(deviceNonlinearCalculate(p));
@@ -192,16 +206,35 @@ static int deviceClassStep(device_ *r, int *breakPoint)
 static int deviceClassLinearize(device_ *r, int *linear)
 {
 	devicePrivate_ *p;
+	int bypass;
 	ReturnErrIf(r == NULL);
 	p = r->private;
 	ReturnErrIf(p == NULL);
 
 	Debug("Linearizing %s %s %p", r->class->type, r->refdes, r);
+
+	/* Keep the last stamp if neither the inputs nor the value they
+	 * predict have moved
+	 */
+	bypass = checkbypassIsBypass(p->checkbypass);
+	ReturnErrIf(bypass < 0);
+	if(bypass) {
+		p->Vn = rowGetSolution(p->rowK) - rowGetSolution(p->rowJ);
+		ReturnErrIf(isnan(p->Vn));
+		*linear = checklinearIsLinear(p->checklinear, p->Vn, p->Vc);
+		ReturnErrIf(*linear < 0);
+		ReturnErrIf(checkbypassConverged(p->checkbypass,
+				checklinearPassed(p->checklinear)));
+		return 0;
+	}
+
 	ReturnErrIf(deviceNonlinearCalculate(p));
 
 	/* Check convergence */
 	*linear = checklinearIsLinear(p->checklinear, p->Vn, p->Vc);
 	ReturnErrIf(*linear < 0);
+	ReturnErrIf(checkbypassRecord(p->checkbypass, p->Vc,
+			checklinearPassed(p->checklinear)));
 
 	/* If not linear update conductances to try again */
 	if(!(*linear)) {
@@ -224,6 +257,7 @@ static int deviceClassLoad(device_ *r)
 
 	/* Initialise / Reset State Data */
 	ReturnErrIf(checklinearInitialize(p->checklinear, 0.0));
+	ReturnErrIf(checkbypassInitialize(p->checkbypass));
 	ReturnErrIf(checkbreakInitialize(p->checkbreak, 0.0));
 	p->Vc = 0.0;
 	p->Vn = 0.0;
@@ -287,6 +321,12 @@ static int deviceClassUnconfig(device_ *r)
 		}
 	}
 
+	if(p->checkbypass != NULL) {
+		if(checkbypassDestroy(&p->checkbypass)) {
+			Warn("Error destroying bypass check");
+		}
+	}
+
 	return 0;
 }
 
@@ -320,7 +360,8 @@ deviceClass_ deviceNonlinearVoltage = {
 	.initStep = NULL,
 	.step = deviceClassStep,
 	.minStep = NULL,
-	.nextStep = NULL,
+	.nextBreak = NULL,
+	.delay = NULL,
 	.integrate = NULL,
 	.print = deviceClassPrint,
 };
@@ -388,6 +429,15 @@ int deviceNonlinearVoltageConfig(device_ *r, char *equation)
 			(calcGetVarPtr_)deviceNonlinearGetVariable, r, &r->control->gmin);
 	ReturnErrIf(p->calc == NULL, "Bad B equation: \n%s", equation);
 
+	/* Setup the bypass checking object, the inputs are the present value
+	 * followed by the variables found while parsing the equation */
+	p->checkbypass = checkbypassNew(p->checkbypass, r->control, 'V');
+	ReturnErrIf(p->checkbypass == NULL);
+	ReturnErrIf(checkbypassAddInput(p->checkbypass, p->rowK, p->rowJ, 'V',
+			NULL));
+	ReturnErrIf(listExecute(p->variables,
+			(listExecute_)deviceNonlinearAddBypassInput, p->checkbypass));
+
 	return 0;
 }
 
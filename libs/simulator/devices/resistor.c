@@ -28,16 +28,19 @@
 #define J			1
 #define NP			2
 
+/* Stamp Entries */
+#define KK			0
+#define KJ			1
+#define JK			2
+#define JJ			3
+
 /*===========================================================================
  |                            Private Structure                              |
   ===========================================================================*/
 
 struct _devicePrivate {
 	double *R;		/* Resistance (Ohms) */
-	node_ *nodeKK;
-	node_ *nodeKJ;
-	node_ *nodeJK;
-	node_ *nodeJJ;
+	stamp_ *stamp;
 };
 
 /*===========================================================================
@@ -61,10 +64,10 @@ static int deviceClassLoad(device_ *r)
 	 */
 
 	g = 1/(*p->R); /* maybe this can be moved to an init fuction someday */
-	ReturnErrIf(nodeDataPlus(p->nodeKK, g));
-	ReturnErrIf(nodeDataPlus(p->nodeKJ, -g));
-	ReturnErrIf(nodeDataPlus(p->nodeJK, -g));
-	ReturnErrIf(nodeDataPlus(p->nodeJJ, g));
+	StampPlus(p->stamp, KK, g);
+	StampPlus(p->stamp, KJ, -g);
+	StampPlus(p->stamp, JK, -g);
+	StampPlus(p->stamp, JJ, g);
 
 	return 0;
 }
@@ -99,7 +102,8 @@ deviceClass_ deviceResistor = {
 	.initStep = NULL,
 	.step = NULL,
 	.minStep = NULL,
-	.nextStep = NULL,
+	.nextBreak = NULL,
+	.delay = NULL,
 	.integrate = NULL,
 	.print = deviceClassPrint,
 };
@@ -111,6 +115,7 @@ deviceClass_ deviceResistor = {
 int deviceResistorConfig(device_ *r, double *resistance)
 {
 	devicePrivate_ *p;
+	node_ *nodes[4];
 
 	ReturnErrIf(r == NULL);
 	ReturnErrIf(r->class != NULL);
@@ -131,14 +136,16 @@ int deviceResistorConfig(device_ *r, double *resistance)
 	ReturnErrIf(p->R == NULL);
 
 	/* Create required nodes and rows (see MNA stamp above) */
-	p->nodeKK = matrixFindOrAddNode(r->matrix, r->pin[K], r->pin[K]);
-	ReturnErrIf(p->nodeKK == NULL);
-	p->nodeKJ = matrixFindOrAddNode(r->matrix, r->pin[K], r->pin[J]);
-	ReturnErrIf(p->nodeKJ == NULL);
-	p->nodeJK = matrixFindOrAddNode(r->matrix, r->pin[J], r->pin[K]);
-	ReturnErrIf(p->nodeJK == NULL);
-	p->nodeJJ = matrixFindOrAddNode(r->matrix, r->pin[J], r->pin[J]);
-	ReturnErrIf(p->nodeJJ == NULL);
+	nodes[KK] = matrixFindOrAddNode(r->matrix, r->pin[K], r->pin[K]);
+	ReturnErrIf(nodes[KK] == NULL);
+	nodes[KJ] = matrixFindOrAddNode(r->matrix, r->pin[K], r->pin[J]);
+	ReturnErrIf(nodes[KJ] == NULL);
+	nodes[JK] = matrixFindOrAddNode(r->matrix, r->pin[J], r->pin[K]);
+	ReturnErrIf(nodes[JK] == NULL);
+	nodes[JJ] = matrixFindOrAddNode(r->matrix, r->pin[J], r->pin[J]);
+	ReturnErrIf(nodes[JJ] == NULL);
+	p->stamp = matrixAddStamp(r->matrix, 4, nodes, 0, NULL, 0);
+	ReturnErrIf(p->stamp == NULL);
 
 	return 0;
 }
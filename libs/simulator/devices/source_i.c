@@ -40,15 +40,15 @@ struct _devicePrivate {
 	double *dcParam;
 	waveform_ *waveform;
 	checkbreak_ *checkbreak;
-	row_ *rowK;
-	row_ *rowJ;
+	stamp_ *stamp;
 };
 
 /*===========================================================================
  |                             Class Functions                               |
   ===========================================================================*/
 
-static int deviceClassNextStep(device_ *r, double *nextStep)
+static int deviceClassNextBreak(device_ *r, double time,
+		double *nextBreak)
 {
 	devicePrivate_ *p;
 	ReturnErrIf(r == NULL);
@@ -59,7 +59,7 @@ static int deviceClassNextStep(device_ *r, double *nextStep)
 
 		Debug("Next Breaking %s %s %p", r->class->type, r->refdes, r);
 
-		ReturnErrIf(waveformNextStep(p->waveform, nextStep));
+		ReturnErrIf(waveformNextBreak(p->waveform, time, nextBreak));
 	}
 
 	return 0;
@@ -81,8 +81,8 @@ static int deviceClassStep(device_ *r, int *breakPoint)
 
 		ReturnErrIf(waveformCalcValue(p->waveform, &dc));
 
-		ReturnErrIf(rowRHSPlus(p->rowK, -(dc - p->dc)));
-		ReturnErrIf(rowRHSPlus(p->rowJ, dc - p->dc));
+		StampRHSValue(p->stamp, K, -dc);
+		StampRHSValue(p->stamp, J, dc);
 		p->dc = dc;
 
 		/* Check to see if we changed the voltage enough to warrant a break */
@@ -121,8 +121,8 @@ static int deviceClassLoad(device_ *r)
 	 *	                  	   Ir
 	 */
 
-	ReturnErrIf(rowRHSPlus(p->rowK, -p->dc));
-	ReturnErrIf(rowRHSPlus(p->rowJ, p->dc));
+	StampRHSValue(p->stamp, K, -p->dc);
+	StampRHSValue(p->stamp, J, p->dc);
 
 	return 0;
 }
@@ -183,7 +183,8 @@ deviceClass_ deviceCurrentSource = {
 	.initStep = NULL,
 	.step = deviceClassStep,
 	.minStep = NULL,
-	.nextStep = deviceClassNextStep,
+	.nextBreak = deviceClassNextBreak,
+	.delay = NULL,
 	.integrate = NULL,
 	.print = deviceClassPrint,
 };
@@ -228,10 +229,8 @@ int deviceCurrentSourceConfig(device_ *r, double *dc, char type,
 	ReturnErrIf(p->checkbreak == NULL);
 
 	/* Create required nodes and rows (see MNA stamp above) */
-	p->rowK = r->pin[K];
-	ReturnErrIf(p->rowK == NULL);
-	p->rowJ = r->pin[J];
-	ReturnErrIf(p->rowJ == NULL);
+	p->stamp = matrixAddStamp(r->matrix, 0, NULL, NP, r->pin, 1);
+	ReturnErrIf(p->stamp == NULL);
 
 	return 0;
 }
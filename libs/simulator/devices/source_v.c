@@ -31,6 +31,15 @@
 #define J			1
 #define NP			2
 
+/* Stamp Rows (pins first) */
+#define IR			2
+
+/* Stamp Entries */
+#define RK			0
+#define RJ			1
+#define KR			2
+#define JR			3
+
 /*===========================================================================
  |                            Private Structure                              |
   ===========================================================================*/
@@ -40,18 +49,15 @@ struct _devicePrivate {
 	double *dcParam;
 	waveform_ *waveform;
 	checkbreak_ *checkbreak;
-	node_ *nodeRK;
-	node_ *nodeRJ;
-	node_ *nodeKR;
-	node_ *nodeJR;
-	row_ *rowR;
+	stamp_ *stamp;
 };
 
 /*===========================================================================
  |                             Class Functions                               |
   ===========================================================================*/
 
-static int deviceClassNextStep(device_ *r, double *nextStep)
+static int deviceClassNextBreak(device_ *r, double time,
+		double *nextBreak)
 {
 	devicePrivate_ *p;
 	ReturnErrIf(r == NULL);
@@ -62,7 +68,7 @@ static int deviceClassNextStep(device_ *r, double *nextStep)
 
 		Debug("Next Breaking %s %s %p", r->class->type, r->refdes, r);
 
-		ReturnErrIf(waveformNextStep(p->waveform, nextStep));
+		ReturnErrIf(waveformNextBreak(p->waveform, time, nextBreak));
 	}
 
 	return 0;
@@ -84,7 +90,7 @@ static int deviceClassStep(device_ *r, int *breakPoint)
 
 		ReturnErrIf(waveformCalcValue(p->waveform, &dc));
 
-		ReturnErrIf(rowRHSPlus(p->rowR, dc - p->dc));
+		StampRHSValue(p->stamp, IR, dc);
 		p->dc = dc;
 
 		/* Check to see if we changed the voltage enough to warrant a break */
@@ -124,12 +130,12 @@ static int deviceClassLoad(device_ *r)
 	 *	                    	   Ir
 	 */
 
-	ReturnErrIf(rowRHSPlus(p->rowR, p->dc));
+	StampRHSValue(p->stamp, IR, p->dc);
 
-	ReturnErrIf(nodeDataSet(p->nodeRK, 1.0));
-	ReturnErrIf(nodeDataSet(p->nodeRJ, -1.0));
-	ReturnErrIf(nodeDataSet(p->nodeKR, 1.0));
-	ReturnErrIf(nodeDataSet(p->nodeJR, -1.0));
+	StampSet(p->stamp, RK, 1.0);
+	StampSet(p->stamp, RJ, -1.0);
+	StampSet(p->stamp, KR, 1.0);
+	StampSet(p->stamp, JR, -1.0);
 
 	return 0;
 }
@@ -190,7 +196,8 @@ deviceClass_ deviceVoltageSource = {
 	.initStep = NULL,
 	.step = deviceClassStep,
 	.minStep = NULL,
-	.nextStep = deviceClassNextStep,
+	.nextBreak = deviceClassNextBreak,
+	.delay = NULL,
 	.integrate = NULL,
 	.print = deviceClassPrint,
 };
@@ -203,6 +210,8 @@ int deviceVoltageSourceConfig(device_ *r, double *dc, char type,
 		double *args[7])
 {
 	devicePrivate_ *p;
+	node_ *nodes[4];
+	row_ *rows[3];
 
 	ReturnErrIf(r == NULL);
 	ReturnErrIf(r->private != NULL);
@@ -237,16 +246,20 @@ int deviceVoltageSourceConfig(device_ *r, double *dc, char type,
 	ReturnErrIf(p->checkbreak == NULL);
 
 	/* Create required nodes and rows (see MNA stamp above) */
-	p->rowR = matrixFindOrAddRow(r->matrix, 'i', r->refdes);
-	ReturnErrIf(p->rowR == NULL);
-	p->nodeRK = matrixFindOrAddNode(r->matrix, p->rowR, r->pin[K]);
-	ReturnErrIf(p->nodeRK == NULL);
-	p->nodeRJ = matrixFindOrAddNode(r->matrix, p->rowR, r->pin[J]);
-	ReturnErrIf(p->nodeRJ == NULL);
-	p->nodeKR = matrixFindOrAddNode(r->matrix, r->pin[K], p->rowR);
-	ReturnErrIf(p->nodeKR == NULL);
-	p->nodeJR = matrixFindOrAddNode(r->matrix, r->pin[J], p->rowR);
-	ReturnErrIf(p->nodeJR == NULL);
+	rows[K] = r->pin[K];
+	rows[J] = r->pin[J];
+	rows[IR] = matrixFindOrAddRow(r->matrix, 'i', r->refdes);
+	ReturnErrIf(rows[IR] == NULL);
+	nodes[RK] = matrixFindOrAddNode(r->matrix, rows[IR], rows[K]);
+	ReturnErrIf(nodes[RK] == NULL);
+	nodes[RJ] = matrixFindOrAddNode(r->matrix, rows[IR], rows[J]);
+	ReturnErrIf(nodes[RJ] == NULL);
+	nodes[KR] = matrixFindOrAddNode(r->matrix, rows[K], rows[IR]);
+	ReturnErrIf(nodes[KR] == NULL);
+	nodes[JR] = matrixFindOrAddNode(r->matrix, rows[J], rows[IR]);
+	ReturnErrIf(nodes[JR] == NULL);
+	p->stamp = matrixAddStamp(r->matrix, 4, nodes, 3, rows, 1);
+	ReturnErrIf(p->stamp == NULL);
 
 	return 0;
 }
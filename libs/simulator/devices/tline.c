@@ -35,6 +35,37 @@
 #define M			3
 #define NP			4
 
+#define MaxAbs(x,y) ((fabs(x) > fabs(y)) ? fabs(x) : fabs(y))
+
+/* Stamp Rows (pins first) */
+#define IR			4
+#define IS			5
+
+/* An entering wave has a corner if it misses the straight line through the
+ * last two steps by this many times the tolerance
+ */
+#define TLINE_CORNER	10
+
+/* Stamp Entries */
+#define RK			0
+#define RJ			1
+#define KR			2
+#define JR			3
+#define RL			4
+#define RM			5
+#define SL			6
+#define SM			7
+#define LS			8
+#define MS			9
+#define SK			10
+#define SJ			11
+#define RR			12
+#define SS			13
+#define KS			14
+#define JS			15
+#define LR			16
+#define MR			17
+
 /*===========================================================================
  |                            Private Structure                              |
   ===========================================================================*/
@@ -43,10 +74,11 @@ struct _devicePrivate {
 	double *Z0;		/* Characteristic Impedance (Ohms) */
 	double *Td;		/* Delay (seconds) */
 	double *loss;	/* Loss = (loss tangent) * (length) (unit-less) */
-	double Vr;		/* Input Equalization Voltage (Volts) */
-	double Vs;		/* Output Equalization Voltage (Volts) */
 	checkbreak_ *checkbreakR;
 	checkbreak_ *checkbreakS;
+	double waveTime[2];	/* last two steps the entering waves were seen at */
+	double waveK[2];	/* wave entering at k-j */
+	double waveL[2];	/* wave entering at l-m */
 	historyInterp_ *historyInterp;
 	double IrIC;		/* Initial Conditions */
 	double IsIC;		/* Initial Conditions */
@@ -62,31 +94,66 @@ struct _devicePrivate {
 	row_ *rowR;
 	char *rowSName;
 	row_ *rowS;
-	node_ *nodeRK;
-	node_ *nodeRJ;
-	node_ *nodeKR;
-	node_ *nodeJR;
-	node_ *nodeRL;
-	node_ *nodeRM;
-	node_ *nodeSL;
-	node_ *nodeSM;
-	node_ *nodeLS;
-	node_ *nodeMS;
-	node_ *nodeSK;
-	node_ *nodeSJ;
-	node_ *nodeRR;
-	node_ *nodeSS;
-	node_ *nodeKS;
-	node_ *nodeJS;
-	node_ *nodeLR;
-	node_ *nodeMR;
+	stamp_ *stamp;
 };
 
 /*===========================================================================
  |                             Class Functions                               |
   ===========================================================================*/
 
-/* TODO: Take a look at adding a next step object to this class. */
+/* Does x miss the line through the last two points, w at times t */
+static int deviceTLineCorner(control_ *control, double *t, double *w,
+		double x)
+{
+	double line, tol;
+
+	line = w[1] + (w[1] - w[0])*(control->time - t[1])/(t[1] - t[0]);
+	tol = control->reltol*MaxAbs(x, w[1]) + control->vntol;
+
+	return (fabs(x - line) > TLINE_CORNER*tol);
+}
+
+/*---------------------------------------------------------------------------*/
+
+static int deviceClassDelay(device_ *r, double *delay)
+{
+	devicePrivate_ *p;
+	double Wk, Wl; /* Waves entering the line (V) */
+	int corner;
+	ReturnErrIf(r == NULL);
+	p = r->private;
+	ReturnErrIf(p == NULL);
+
+	/* The waves entering at each end come out of the other end Td later.
+	 * If one bends away from the line through the last two steps the corner
+	 * was at the last step, so that's the time that's delayed. Corners that
+	 * never reach the line aren't copied.
+	 */
+	Wk = StampSolution(p->stamp, K) - StampSolution(p->stamp, J) +
+			(*p->Z0)*StampSolution(p->stamp, IR);
+	Wl = StampSolution(p->stamp, L) - StampSolution(p->stamp, M) +
+			(*p->Z0)*StampSolution(p->stamp, IS);
+
+	*delay = 0.0;
+	if(r->control->time <= p->waveTime[1]) {
+		return 0;
+	}
+
+	corner = deviceTLineCorner(r->control, p->waveTime, p->waveK, Wk) ||
+			deviceTLineCorner(r->control, p->waveTime, p->waveL, Wl);
+	if(corner) {
+		*delay = p->waveTime[1] + *p->Td - r->control->time;
+	}
+
+	p->waveTime[0] = p->waveTime[1];
+	p->waveK[0] = p->waveK[1];
+	p->waveL[0] = p->waveL[1];
+	p->waveTime[1] = r->control->time;
+	p->waveK[1] = Wk;
+	p->waveL[1] = Wl;
+
+	return 0;
+}
 
 /*---------------------------------------------------------------------------*/
 
@@ -101,22 +168,28 @@ static int deviceClassInitStep(device_ *r)
 	Debug("Initializing Stepping %s %s %p", r->class->type, r->refdes, r);
 
 	/* Remove explict km -> lm link */
-	ReturnErrIf(nodeDataClear(p->nodeRL));
-	ReturnErrIf(nodeDataClear(p->nodeRM));
-	ReturnErrIf(nodeDataClear(p->nodeSK));
-	ReturnErrIf(nodeDataClear(p->nodeSJ));
-	ReturnErrIf(nodeDataClear(p->nodeKS));
-	ReturnErrIf(nodeDataClear(p->nodeJS));
-	ReturnErrIf(nodeDataClear(p->nodeLR));
-	ReturnErrIf(nodeDataClear(p->nodeMR));
+	StampSet(p->stamp, RL, 0.0);
+	StampSet(p->stamp, RM, 0.0);
+	StampSet(p->stamp, SK, 0.0);
+	StampSet(p->stamp, SJ, 0.0);
+	StampSet(p->stamp, KS, 0.0);
+	StampSet(p->stamp, JS, 0.0);
+	StampSet(p->stamp, LR, 0.0);
+	StampSet(p->stamp, MR, 0.0);
 
 	/* set initial conditions */
 	p->IrIC = 0.0;
 	p->IsIC = 0.0;
-	p->VkIC = rowGetSolution(p->rowK);
-	p->VjIC = rowGetSolution(p->rowJ);
-	p->VlIC = rowGetSolution(p->rowL);
-	p->VmIC = rowGetSolution(p->rowM);
+	p->VkIC = StampSolution(p->stamp, K);
+	p->VjIC = StampSolution(p->stamp, J);
+	p->VlIC = StampSolution(p->stamp, L);
+	p->VmIC = StampSolution(p->stamp, M);
+
+	/* The entering waves start out flat at their operating point */
+	p->waveTime[0] = -(*p->Td);
+	p->waveTime[1] = 0.0;
+	p->waveK[0] = p->waveK[1] = p->VkIC - p->VjIC;
+	p->waveL[0] = p->waveL[1] = p->VlIC - p->VmIC;
 
 	return 0;
 }
@@ -189,11 +262,8 @@ static int deviceClassStep(device_ *r, int *breakPoint)
 		Vs = exp(-(*p->loss)/2)*((Vk - Vj) + (*p->Z0)*Ir);
 	}
 
-	ReturnErrIf(rowRHSPlus(p->rowR, Vr - p->Vr));
-	p->Vr = Vr;
-
-	ReturnErrIf(rowRHSPlus(p->rowS, Vs - p->Vs));
-	p->Vs = Vs;
+	StampRHSValue(p->stamp, IR, Vr);
+	StampRHSValue(p->stamp, IS, Vs);
 
 	/* Check to see if we changed the voltage enough to warrant a break */
 	*breakPoint = checkbreakIsBreak(p->checkbreakR, Vr);
@@ -202,7 +272,6 @@ static int deviceClassStep(device_ *r, int *breakPoint)
 		*breakPoint = checkbreakIsBreak(p->checkbreakS, Vs);
 		ReturnErrIf(*breakPoint < 0);
 	}
-
 	return 0;
 }
 
@@ -221,8 +290,6 @@ static int deviceClassLoad(device_ *r)
 	ReturnErrIf(checkbreakInitialize(p->checkbreakR, 0.0));
 	ReturnErrIf(checkbreakInitialize(p->checkbreakS, 0.0));
 	ReturnErrIf(historyInterpInitialize(p->historyInterp));
-	p->Vr = 0.0;
-	p->Vs = 0.0;
 	p->IrIC = 0.0;
 	p->IsIC = 0.0;
 	p->VkIC = 0.0;
@@ -233,14 +300,14 @@ static int deviceClassLoad(device_ *r)
 	/* These short the output to the input for opertaing point analysis
 	 * they're removed during the first timestep.
 	 */
-	ReturnErrIf(nodeDataSet(p->nodeRL, -1.0));
-	ReturnErrIf(nodeDataSet(p->nodeRM, 1.0));
-	ReturnErrIf(nodeDataSet(p->nodeSK, -1.0));
-	ReturnErrIf(nodeDataSet(p->nodeSJ, 1.0));
-	ReturnErrIf(nodeDataSet(p->nodeKS, 1.0));
-	ReturnErrIf(nodeDataSet(p->nodeJS, -1.0));
-	ReturnErrIf(nodeDataSet(p->nodeLR, -1.0));
-	ReturnErrIf(nodeDataSet(p->nodeMR, 1.0));
+	StampSet(p->stamp, RL, -1.0);
+	StampSet(p->stamp, RM, 1.0);
+	StampSet(p->stamp, SK, -1.0);
+	StampSet(p->stamp, SJ, 1.0);
+	StampSet(p->stamp, KS, 1.0);
+	StampSet(p->stamp, JS, -1.0);
+	StampSet(p->stamp, LR, -1.0);
+	StampSet(p->stamp, MR, 1.0);
 
 	/* Modified Nodal Analysis Stamp
 	 *	                     		 	     /\     gmin   -
@@ -253,18 +320,18 @@ static int deviceClassLoad(device_ *r)
 	 *	s |  1 -1  -- 1 -1 -gm | --  |       \/ Vs = Vkj
 	 */
 
-	ReturnErrIf(nodeDataSet(p->nodeRK, 1.0));
-	ReturnErrIf(nodeDataSet(p->nodeRJ, -1.0));
-	ReturnErrIf(nodeDataSet(p->nodeKR, 1.0));
-	ReturnErrIf(nodeDataSet(p->nodeJR, -1.0));
+	StampSet(p->stamp, RK, 1.0);
+	StampSet(p->stamp, RJ, -1.0);
+	StampSet(p->stamp, KR, 1.0);
+	StampSet(p->stamp, JR, -1.0);
 
-	ReturnErrIf(nodeDataSet(p->nodeSL, 1.0));
-	ReturnErrIf(nodeDataSet(p->nodeSM, -1.0));
-	ReturnErrIf(nodeDataSet(p->nodeLS, 1.0));
-	ReturnErrIf(nodeDataSet(p->nodeMS, -1.0));
+	StampSet(p->stamp, SL, 1.0);
+	StampSet(p->stamp, SM, -1.0);
+	StampSet(p->stamp, LS, 1.0);
+	StampSet(p->stamp, MS, -1.0);
 
-	ReturnErrIf(nodeDataPlus(p->nodeRR, -(*p->Z0)));
-	ReturnErrIf(nodeDataPlus(p->nodeSS, -(*p->Z0)));
+	StampPlus(p->stamp, RR, -(*p->Z0));
+	StampPlus(p->stamp, SS, -(*p->Z0));
 
 	return 0;
 }
@@ -341,7 +408,8 @@ deviceClass_ deviceTLine = {
 	.initStep = deviceClassInitStep,
 	.step = deviceClassStep,
 	.minStep = NULL,
-	.nextStep = NULL,
+	.nextBreak = NULL,
+	.delay = deviceClassDelay,
 	.integrate = NULL,
 	.print = deviceClassPrint,
 };
@@ -353,6 +421,9 @@ deviceClass_ deviceTLine = {
 int deviceTLineConfig(device_ *r, double *Z0, double *Td, double *loss)
 {
 	devicePrivate_ *p;
+	node_ *nodes[18];
+	row_ *rows[6];
+	int i;
 
 	ReturnErrIf(r == NULL);
 	ReturnErrIf(r->class != NULL);
@@ -406,43 +477,57 @@ int deviceTLineConfig(device_ *r, double *Z0, double *Td, double *loss)
 	ReturnErrIf(p->rowL == NULL);
 	p->rowS = matrixFindOrAddRow(r->matrix, 'i', p->rowSName);
 	ReturnErrIf(p->rowS == NULL);
-	p->nodeRK = matrixFindOrAddNode(r->matrix, p->rowR, p->rowK);
-	ReturnErrIf(p->nodeRK == NULL);
-	p->nodeRJ = matrixFindOrAddNode(r->matrix, p->rowR, p->rowJ);
-	ReturnErrIf(p->nodeRJ == NULL);
-	p->nodeKR = matrixFindOrAddNode(r->matrix, p->rowK, p->rowR);
-	ReturnErrIf(p->nodeKR == NULL);
-	p->nodeJR = matrixFindOrAddNode(r->matrix, p->rowJ, p->rowR);
-	ReturnErrIf(p->nodeJR == NULL);
-	p->nodeRL = matrixFindOrAddNode(r->matrix, p->rowR, p->rowL);
-	ReturnErrIf(p->nodeRL == NULL);
-	p->nodeRM = matrixFindOrAddNode(r->matrix, p->rowR, p->rowM);
-	ReturnErrIf(p->nodeRM == NULL);
-	p->nodeSL = matrixFindOrAddNode(r->matrix, p->rowS, p->rowL);
-	ReturnErrIf(p->nodeSL == NULL);
-	p->nodeSM = matrixFindOrAddNode(r->matrix, p->rowS, p->rowM);
-	ReturnErrIf(p->nodeSM == NULL);
-	p->nodeLS = matrixFindOrAddNode(r->matrix, p->rowL, p->rowS);
-	ReturnErrIf(p->nodeLS == NULL);
-	p->nodeMS = matrixFindOrAddNode(r->matrix, p->rowM, p->rowS);
-	ReturnErrIf(p->nodeMS == NULL);
-	p->nodeSK = matrixFindOrAddNode(r->matrix, p->rowS, p->rowK);
-	ReturnErrIf(p->nodeSK == NULL);
-	p->nodeSJ = matrixFindOrAddNode(r->matrix, p->rowS, p->rowJ);
-	ReturnErrIf(p->nodeSJ == NULL);
-	p->nodeRR = matrixFindOrAddNode(r->matrix, p->rowR, p->rowR);
-	ReturnErrIf(p->nodeRR == NULL);
-	p->nodeSS = matrixFindOrAddNode(r->matrix, p->rowS, p->rowS);
-	ReturnErrIf(p->nodeSS == NULL);
-	p->nodeKS = matrixFindOrAddNode(r->matrix, p->rowK, p->rowS);
-	ReturnErrIf(p->nodeKS == NULL);
-	p->nodeJS = matrixFindOrAddNode(r->matrix, p->rowJ, p->rowS);
-	ReturnErrIf(p->nodeJS == NULL);
-	p->nodeLR = matrixFindOrAddNode(r->matrix, p->rowL, p->rowR);
-	ReturnErrIf(p->nodeLR == NULL);
-	p->nodeMR = matrixFindOrAddNode(r->matrix, p->rowM, p->rowR);
-	ReturnErrIf(p->nodeMR == NULL);
-
+	rows[K] = p->rowK;
+	rows[J] = p->rowJ;
+	rows[L] = p->rowL;
+	rows[M] = p->rowM;
+	rows[IR] = p->rowR;
+	rows[IS] = p->rowS;
+	nodes[RK] = matrixFindOrAddNode(r->matrix, rows[IR], rows[K]);
+	ReturnErrIf(nodes[RK] == NULL);
+	nodes[RJ] = matrixFindOrAddNode(r->matrix, rows[IR], rows[J]);
+	ReturnErrIf(nodes[RJ] == NULL);
+	nodes[KR] = matrixFindOrAddNode(r->matrix, rows[K], rows[IR]);
+	ReturnErrIf(nodes[KR] == NULL);
+	nodes[JR] = matrixFindOrAddNode(r->matrix, rows[J], rows[IR]);
+	ReturnErrIf(nodes[JR] == NULL);
+	nodes[RL] = matrixFindOrAddNode(r->matrix, rows[IR], rows[L]);
+	ReturnErrIf(nodes[RL] == NULL);
+	nodes[RM] = matrixFindOrAddNode(r->matrix, rows[IR], rows[M]);
+	ReturnErrIf(nodes[RM] == NULL);
+	nodes[SL] = matrixFindOrAddNode(r->matrix, rows[IS], rows[L]);
+	ReturnErrIf(nodes[SL] == NULL);
+	nodes[SM] = matrixFindOrAddNode(r->matrix, rows[IS], rows[M]);
+	ReturnErrIf(nodes[SM] == NULL);
+	nodes[LS] = matrixFindOrAddNode(r->matrix, rows[L], rows[IS]);
+	ReturnErrIf(nodes[LS] == NULL);
+	nodes[MS] = matrixFindOrAddNode(r->matrix, rows[M], rows[IS]);
+	ReturnErrIf(nodes[MS] == NULL);
+	nodes[SK] = matrixFindOrAddNode(r->matrix, rows[IS], rows[K]);
+	ReturnErrIf(nodes[SK] == NULL);
+	nodes[SJ] = matrixFindOrAddNode(r->matrix, rows[IS], rows[J]);
+	ReturnErrIf(nodes[SJ] == NULL);
+	nodes[RR] = matrixFindOrAddNode(r->matrix, rows[IR], rows[IR]);
+	ReturnErrIf(nodes[RR] == NULL);
+	nodes[SS] = matrixFindOrAddNode(r->matrix, rows[IS], rows[IS]);
+	ReturnErrIf(nodes[SS] == NULL);
+	nodes[KS] = matrixFindOrAddNode(r->matrix, rows[K], rows[IS]);
+	ReturnErrIf(nodes[KS] == NULL);
+	nodes[JS] = matrixFindOrAddNode(r->matrix, rows[J], rows[IS]);
+	ReturnErrIf(nodes[JS] == NULL);
+	nodes[LR] = matrixFindOrAddNode(r->matrix, rows[L], rows[IR]);
+	ReturnErrIf(nodes[LR] == NULL);
+	nodes[MR] = matrixFindOrAddNode(r->matrix, rows[M], rows[IR]);
+	ReturnErrIf(nodes[MR] == NULL);
+	p->stamp = matrixAddStamp(r->matrix, 18, nodes, 6, rows, 1);
+	ReturnErrIf(p->stamp == NULL);
+
+	/* The delayed values come out of the history, so keep these rows in
+	 * it even if they aren't saved, but only for as long as the delay
+	 */
+	for(i = 0; i < 6; i++) {
+		ReturnErrIf(matrixRequireRow(r->matrix, rows[i], p->Td));
+	}
 	p->historyInterp = historyInterpNew(p->historyInterp,
 			matrixGetHistory(r->matrix));
 	ReturnErrIf(p->historyInterp == NULL);
@@ -705,7 +705,8 @@ deviceClass_ deviceTLineW = {
 	.initStep = deviceClassInitStep,
 	.step = deviceClassStep,
 	.minStep = NULL,
-	.nextStep = NULL,
+	.nextBreak = NULL,
+	.delay = NULL,
 	.integrate = NULL,
 	.print = deviceClassPrint,
 };
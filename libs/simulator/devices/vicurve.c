@@ -25,6 +25,7 @@
 #include "checkbreak.h"
 #include "piecewise.h"
 #include "checklinear.h"
+#include "checkbypass.h"
 #include "device_internal.h"
 
 /* Pin Designations */
@@ -32,6 +33,20 @@
 #define J			1
 #define NP			2
 
+/* Stamp Rows (pins first) */
+#define IR			2
+#define VM			3
+
+/* Stamp Entries */
+#define RK			0
+#define RM			1
+#define KR			2
+#define MR			3
+#define JJ			4
+#define JM			5
+#define MJ			6
+#define MM			7
+
 /*===========================================================================
  |                            Private Structure                              |
   ===========================================================================*/
@@ -40,33 +55,24 @@ struct _devicePrivate {
 	double G;		/* Value of Differential (Siemens) */
 	double Ieq;		/* Equalization Current (Amps) */
 	double a;		/* Multiplier (determined by pw) */
+	double ic;		/* Calculated Current (Amps) */
 	checklinear_ *checklinear;
+	checkbypass_ *checkbypass;
 	checkbreak_ *checkbreak;
 	piecewise_ *ta;
 	int taIndex;
 	piecewise_ *vi;
 	int viIndex;
-	node_ *nodeRK;
-	node_ *nodeRM;
-	node_ *nodeKR;
-	node_ *nodeMR;
-	node_ *nodeJJ;
-	node_ *nodeJM;
-	node_ *nodeMJ;
-	node_ *nodeMM;
-	row_ *rowR;
-	row_ *rowK;
-	row_ *rowJ;
-	row_ *rowM;
+	stamp_ *stamp;
 };
 
 /*===========================================================================
  |                             Class Functions                               |
   ===========================================================================*/
 
-static int deviceClassNextStep(device_ *r, double *nextStep)
+static int deviceClassNextBreak(device_ *r, double time, double *nextBreak)
 {
-	double nextTime, time;
+	double nextTime;
 
 	devicePrivate_ *p;
 	ReturnErrIf(r == NULL);
@@ -74,9 +80,10 @@ static int deviceClassNextStep(device_ *r, double *nextStep)
 	ReturnErrIf(p == NULL);
 
 	if(p->ta != NULL) {
-		time = r->control->time;
 		ReturnErrIf(piecewiseGetNextX(p->ta, &p->taIndex, time, &nextTime));
-		*nextStep = nextTime - time;
+		if(nextTime > time) {
+			*nextBreak = nextTime;
+		}
 	}
 
 	return 0;
@@ -94,7 +101,11 @@ static int deviceClassStep(device_ *r, int *breakPoint)
 	ReturnErrIf(p == NULL);
 
 	Debug("Stepping %s %s %p", r->class->type, r->refdes, r);
+
 	if(p->ta != NULL) {
+		/* The value moves with time so the bypass record is stale */
+		ReturnErrIf(checkbypassInitialize(p->checkbypass));
+
 		ReturnErrIf(piecewiseCalcValue(p->ta, &p->taIndex,
 				r->control->time, &p->a, &dadt));
 
@@ -112,18 +123,32 @@ static int deviceClassLinearize(device_ *r, int *linear)
 {
 	double G, Ieq, v0, i0, gc, ic;
 	devicePrivate_ *p;
+	int bypass;
 	ReturnErrIf(r == NULL);
 	p = r->private;
 	ReturnErrIf(p == NULL);
 
 	Debug("Linearizing %s %s %p", r->class->type, r->refdes, r);
 
-	i0 = rowGetSolution(p->rowR);
+	i0 = StampSolution(p->stamp, IR);
 	ReturnErrIf(isnan(i0));
 
-	v0 = rowGetSolution(p->rowK) - rowGetSolution(p->rowJ);
+	v0 = StampSolution(p->stamp, K) - StampSolution(p->stamp, J);
 	ReturnErrIf(isnan(v0));
 
+	/* Keep the last stamp if neither the current, the voltage nor the
+	 * current they predict have moved
+	 */
+	bypass = checkbypassIsBypass(p->checkbypass);
+	ReturnErrIf(bypass < 0);
+	if(bypass) {
+		*linear = checklinearIsLinear(p->checklinear, i0, p->ic);
+		ReturnErrIf(*linear < 0);
+		ReturnErrIf(checkbypassConverged(p->checkbypass,
+				checklinearPassed(p->checklinear)));
+		return 0;
+	}
+
 	/* If there's no current through the device then it must be an
 	 * open, so calculated current is forced to 0Amps
 	 */
@@ -135,10 +160,13 @@ static int deviceClassLinearize(device_ *r, int *linear)
 		ic *= p->a;
 		gc *= p->a;
 	}
+	p->ic = ic;
 
 	/* Check convergence */
 	*linear = checklinearIsLinear(p->checklinear, i0, ic);
 	ReturnErrIf(*linear < 0);
+	ReturnErrIf(checkbypassRecord(p->checkbypass, ic,
+			checklinearPassed(p->checklinear)));
 
 	/* If not linear update conductances to try again */
 	if(!(*linear)) {
@@ -152,14 +180,14 @@ static int deviceClassLinearize(device_ *r, int *linear)
 		Ieq = (ic - gc * v0);
 		G = gc;
 
-		ReturnErrIf(nodeDataPlus(p->nodeJJ, G - p->G));
-		ReturnErrIf(nodeDataPlus(p->nodeJM, -(G - p->G)));
-		ReturnErrIf(nodeDataPlus(p->nodeMJ, -(G - p->G)));
-		ReturnErrIf(nodeDataPlus(p->nodeMM, G - p->G));
+		StampValue(p->stamp, JJ, G);
+		StampValue(p->stamp, JM, -G);
+		StampValue(p->stamp, MJ, -G);
+		StampValue(p->stamp, MM, G);
 		p->G = G;
 
-		ReturnErrIf(rowRHSPlus(p->rowJ, Ieq - p->Ieq));
-		ReturnErrIf(rowRHSPlus(p->rowM, -(Ieq - p->Ieq)));
+		StampRHSValue(p->stamp, J, Ieq);
+		StampRHSValue(p->stamp, VM, -Ieq);
 		p->Ieq = Ieq;
 
 	}
@@ -181,6 +209,8 @@ static int deviceClassLoad(device_ *r)
 	/* Initialise / Reset State Data */
 	ReturnErrIf(checklinearInitialize(p->checklinear, 0.0));
 	ReturnErrIf(checkbreakInitialize(p->checkbreak, 0.0));
+	ReturnErrIf(checkbypassInitialize(p->checkbypass));
+	p->ic = 0.0;
 	if(p->ta != NULL) {
 		ReturnErrIf(piecewiseInitialize(p->ta));
 		ReturnErrIf(piecewiseCalcValue(p->ta,&p->taIndex, 0.0, &p->a, &p->G));
@@ -204,18 +234,18 @@ static int deviceClassLoad(device_ *r)
 	 *			- g is the derviatvie of the function wrt the volatge Vkj
 	 */
 
-	ReturnErrIf(nodeDataSet(p->nodeRK, 1.0));
-	ReturnErrIf(nodeDataSet(p->nodeRM, -1.0));
-	ReturnErrIf(nodeDataSet(p->nodeKR, 1.0));
-	ReturnErrIf(nodeDataSet(p->nodeMR, -1.0));
+	StampSet(p->stamp, RK, 1.0);
+	StampSet(p->stamp, RM, -1.0);
+	StampSet(p->stamp, KR, 1.0);
+	StampSet(p->stamp, MR, -1.0);
 
-	ReturnErrIf(nodeDataPlus(p->nodeJJ, p->G));
-	ReturnErrIf(nodeDataPlus(p->nodeJM, -(p->G)));
-	ReturnErrIf(nodeDataPlus(p->nodeMJ, -(p->G)));
-	ReturnErrIf(nodeDataPlus(p->nodeMM, p->G));
+	StampValue(p->stamp, JJ, p->G);
+	StampValue(p->stamp, JM, -(p->G));
+	StampValue(p->stamp, MJ, -(p->G));
+	StampValue(p->stamp, MM, p->G);
 
-	ReturnErrIf(rowRHSPlus(p->rowJ, p->Ieq));
-	ReturnErrIf(rowRHSPlus(p->rowM, -(p->Ieq)));
+	StampRHSValue(p->stamp, J, p->Ieq);
+	StampRHSValue(p->stamp, VM, -(p->Ieq));
 
 	return 0;
 }
@@ -242,6 +272,12 @@ static int deviceClassUnconfig(device_ *r)
 		}
 	}
 
+	if(p->checkbypass != NULL) {
+		if(checkbypassDestroy(&p->checkbypass)) {
+			Warn("Error destroying bypass check");
+		}
+	}
+
 	if(p->vi != NULL) {
 		if(piecewiseDestroy(&p->vi)) {
 			Warn("Error destroying piecewise");
@@ -286,7 +322,8 @@ deviceClass_ deviceVICurve = {
 	.initStep = NULL,
 	.step = deviceClassStep,
 	.minStep = NULL,
-	.nextStep = deviceClassNextStep,
+	.nextBreak = deviceClassNextBreak,
+	.delay = NULL,
 	.integrate = NULL,
 	.print = deviceClassPrint,
 };
@@ -299,6 +336,8 @@ int deviceVICurveConfig(device_ *r, double **vi, int *viLength, char viType,
 		double **ta, int *taLength, char taType)
 {
 	devicePrivate_ *p;
+	node_ *nodes[8];
+	row_ *rows[4];
 
 	ReturnErrIf(r == NULL);
 	ReturnErrIf(r->class != NULL);
@@ -330,30 +369,38 @@ int deviceVICurveConfig(device_ *r, double **vi, int *viLength, char viType,
 	ReturnErrIf(p->checkbreak == NULL)
 
 	/* Create required nodes and rows (see MNA stamps above) */
-	p->rowR = matrixFindOrAddRow(r->matrix, 'i', r->refdes);
-	ReturnErrIf(p->rowR == NULL);
-	p->rowM = matrixFindOrAddRow(r->matrix, 'v', r->refdes);
-	ReturnErrIf(p->rowM == NULL);
-	p->rowK = r->pin[K];
-	ReturnErrIf(p->rowK == NULL);
-	p->rowJ = r->pin[J];
-	ReturnErrIf(p->rowJ == NULL);
-	p->nodeRK = matrixFindOrAddNode(r->matrix, p->rowR, p->rowK);
-	ReturnErrIf(p->nodeRK == NULL);
-	p->nodeRM = matrixFindOrAddNode(r->matrix, p->rowR, p->rowM);
-	ReturnErrIf(p->nodeRM == NULL);
-	p->nodeKR = matrixFindOrAddNode(r->matrix, p->rowK, p->rowR);
-	ReturnErrIf(p->nodeKR == NULL);
-	p->nodeMR = matrixFindOrAddNode(r->matrix, p->rowM, p->rowR);
-	ReturnErrIf(p->nodeMR == NULL);
-	p->nodeJJ = matrixFindOrAddNode(r->matrix, p->rowJ, p->rowJ);
-	ReturnErrIf(p->nodeJJ == NULL);
-	p->nodeJM = matrixFindOrAddNode(r->matrix, p->rowJ, p->rowM);
-	ReturnErrIf(p->nodeJM == NULL);
-	p->nodeMJ = matrixFindOrAddNode(r->matrix, p->rowM, p->rowJ);
-	ReturnErrIf(p->nodeMJ == NULL);
-	p->nodeMM = matrixFindOrAddNode(r->matrix, p->rowM, p->rowM);
-	ReturnErrIf(p->nodeMM == NULL);
+	rows[K] = r->pin[K];
+	rows[J] = r->pin[J];
+	rows[IR] = matrixFindOrAddRow(r->matrix, 'i', r->refdes);
+	ReturnErrIf(rows[IR] == NULL);
+	rows[VM] = matrixFindOrAddRow(r->matrix, 'v', r->refdes);
+	ReturnErrIf(rows[VM] == NULL);
+	nodes[RK] = matrixFindOrAddNode(r->matrix, rows[IR], rows[K]);
+	ReturnErrIf(nodes[RK] == NULL);
+	nodes[RM] = matrixFindOrAddNode(r->matrix, rows[IR], rows[VM]);
+	ReturnErrIf(nodes[RM] == NULL);
+	nodes[KR] = matrixFindOrAddNode(r->matrix, rows[K], rows[IR]);
+	ReturnErrIf(nodes[KR] == NULL);
+	nodes[MR] = matrixFindOrAddNode(r->matrix, rows[VM], rows[IR]);
+	ReturnErrIf(nodes[MR] == NULL);
+	nodes[JJ] = matrixFindOrAddNode(r->matrix, rows[J], rows[J]);
+	ReturnErrIf(nodes[JJ] == NULL);
+	nodes[JM] = matrixFindOrAddNode(r->matrix, rows[J], rows[VM]);
+	ReturnErrIf(nodes[JM] == NULL);
+	nodes[MJ] = matrixFindOrAddNode(r->matrix, rows[VM], rows[J]);
+	ReturnErrIf(nodes[MJ] == NULL);
+	nodes[MM] = matrixFindOrAddNode(r->matrix, rows[VM], rows[VM]);
+	ReturnErrIf(nodes[MM] == NULL);
+	p->stamp = matrixAddStamp(r->matrix, 8, nodes, 4, rows, 1);
+	ReturnErrIf(p->stamp == NULL);
+
+	/* Setup the bypass checking object, the inputs are the current through
+	 * the device and the voltage across it */
+	p->checkbypass = checkbypassNew(p->checkbypass, r->control, 'A');
+	ReturnErrIf(p->checkbypass == NULL);
+	ReturnErrIf(checkbypassAddInput(p->checkbypass, rows[IR], NULL, 'A', NULL));
+	ReturnErrIf(checkbypassAddInput(p->checkbypass, rows[K], rows[J], 'V',
+			&p->G));
 
 	return 0;
 }
@@ -0,0 +1,40 @@
+/*
+ * Copyright (C) 2006 Cooper Street Innovations Inc.
+ *	Charles Eidsness    <charles@cooper-street.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ */
+
+#ifndef BREAKQUEUE_H
+#define BREAKQUEUE_H
+
+/* Min-heap of future break-points, each one tagged with the owner that
+ * registered it so the owner can be asked for its next one once it's
+ * been reached.
+ */
+typedef struct _breakqueue breakqueue_;
+
+int breakqueueAdd(breakqueue_ *r, double time, void *owner);
+int breakqueuePeek(breakqueue_ *r, double *time, void **owner);
+int breakqueuePop(breakqueue_ *r);
+
+int breakqueueClear(breakqueue_ *r);
+
+int breakqueueDestroy(breakqueue_ **r);
+breakqueue_ * breakqueueNew(breakqueue_ *r);
+
+#endif
@@ -0,0 +1,41 @@
+/*
+ * Copyright (C) 2006 Cooper Street Innovations Inc.
+ *	Charles Eidsness    <charles@cooper-street.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ */
+
+#ifndef CHECKBYPASS_H
+#define CHECKBYPASS_H
+
+#include "control.h"
+#include "row.h"
+
+typedef struct _checkbypass checkbypass_;
+
+int checkbypassIsBypass(checkbypass_ *r);
+int checkbypassRecord(checkbypass_ *r, double value, int converged);
+int checkbypassConverged(checkbypass_ *r, int converged);
+int checkbypassAddInput(checkbypass_ *r, row_ *pos, row_ *neg, char units,
+		double *deriv);
+
+int checkbypassInitialize(checkbypass_ *r);
+
+int checkbypassDestroy(checkbypass_ **r);
+checkbypass_ * checkbypassNew(checkbypass_ *r, control_ *control, char units);
+
+#endif
@@ -27,6 +27,7 @@
 typedef struct _checklinear checklinear_;
 
 int checklinearIsLinear(checklinear_ *r, double V, double calcedV);
+int checklinearPassed(checklinear_ *r);
 
 int checklinearInitialize(checklinear_ *r, double ic);
 
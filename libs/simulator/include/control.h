@@ -24,8 +24,20 @@
 
 typedef enum {
 	CONTROL_LU_SUPERLU,
+	CONTROL_LU_DENSE,		/* LAPACK dgetrf/dgetrs */
+	CONTROL_LU_CKTLU,		/* BTF, AMD and Gilbert-Peierls (libs/cktlu) */
+	CONTROL_LU_AUTO,		/* Dense up to luDenseSize, above that CktLU if
+							   luThreads > 1, SuperLU otherwise */
 } controlLULibrary_;
 
+typedef enum {
+	CONTROL_ORDER_COLAMD,		/* approximate minimum degree on A'A */
+	CONTROL_ORDER_MMD_ATA,		/* multiple minimum degree on A'A */
+	CONTROL_ORDER_MMD_ATPLUSA,	/* multiple minimum degree on A'+A */
+	CONTROL_ORDER_NATURAL,		/* no column reordering */
+	CONTROL_ORDER_AUTO,			/* least fill of the above, tried on A */
+} controlOrdering_;
+
 typedef enum {
 	CONTROL_NIMETHOD_TRAP,		/* Trapazoidal */
 	CONTROL_NIMETHOD_GEAR,		/* Gear */
@@ -43,18 +55,37 @@ typedef struct {
 	double trtol;
 	double minstep; /* same as  minbreak in Old Spice */
 	double gmin;
-	int maxorder;
+	double pivrel;
+	int maxorder; /* up to 2 for Trapazoidal, CONTROL_GEAR_MAX_ORDER for Gear,
+					Gear above 2 isn't stable for lossless LC circuits */
 /*-- New eispice Options --*/
 	controlLULibrary_ luLibrary;
+	int luDenseSize;
+	controlOrdering_ luOrdering; /* fill reducing column order (SuperLU) */
+	controlNIMethod_ niMethod; /* numerical integration method */
+	int chord; /* reuse the factored Jacobian across Newton iterations */
+	double chordRate;
+	int woodburyRank; /* solve low rank changes to A without refactoring */
+	int luCache; /* number of factorizations to keep, 0 to disable */
+	int luThreads; /* threads used to refactor large circuits (CktLU) */
+	int luSingle; /* single precision factors with refinement (CktLU) */
+	int bypass; /* skip nonlinear devices whose inputs have not moved */
+	int predictor; /* extrapolate each step's starting point and LTE */
+	double stepLadder; /* ratio between transient step sizes, 0 to disable */
 	double maxAngleA;
 	double maxAngleV;
+/*-- Statistics --*/
+	int bypasses; /* device evaluations skipped by bypass */
 /*-- Transient Analysis State --*/
 	double tstop;
 	double tstep;
 	int integratorOrder;
 	double time;
+	double step; /* time - the last accepted time, as the simulator chose it */
 } control_;
 
+#define CONTROL_GEAR_MAX_ORDER	6
+
 #define ControlIntegratorOrderUp(cntrl) \
 		((cntrl->integratorOrder < cntrl->maxorder) ? \
 		cntrl->integratorOrder + 1 : cntrl->integratorOrder)
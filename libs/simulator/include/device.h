@@ -56,18 +56,7 @@ int deviceCallbackVoltageConfig(device_ *r, char *vars[], double values[],
 int deviceCallbackCurrentConfig(device_ *r, char *vars[], double values[],
 		double derivs[], int numVars, deviceCallback_ callback, void *private);
 
-/* Operating Point */
-int deviceLoad(device_ *r, void *data);
-int deviceLinearize(device_ *r, int *linear);
-
-/* Transient Analysis */
-int deviceInitStep(device_ *r, void *data);
-int deviceStep(device_ *r, int *breakPoint);
-int deviceMinStep(device_ *r, double *minStep);
-int deviceNextStep(device_ *r, double *nextStep);
-int deviceIntegrate(device_ *r, void *data);
-
-listAddReturn_ deviceCheckDuplicate(device_ *old, device_ *new);
+char * deviceGetRefdes(device_ *r);
 
 int devicePrint(device_ *r, void *data);
 int deviceDestroy(device_ *r);
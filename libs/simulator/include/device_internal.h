@@ -35,7 +35,20 @@ typedef int (*deviceInitStep_)(device_ *r);
 typedef int (*deviceStep_)(device_ *r, int *breakPoint);
 typedef int (*deviceIntegrate_)(device_ *r);
 typedef int (*deviceMinStep_)(device_ *r, double *minStep);
-typedef int (*deviceNextStep_)(device_ *r, double *nextStep);
+typedef int (*deviceNextBreak_)(device_ *r, double time, double *nextBreak);
+typedef int (*deviceDelay_)(device_ *r, double *delay);
+
+/* Batched transient hooks, a class can handle every one of its devices in
+ * one call instead of one call per device. The batch is built by the
+ * dispatch (see dispatch.c) once the circuit is locked and each class
+ * defines its own struct _deviceBatch.
+ */
+typedef struct _deviceBatch deviceBatch_;
+typedef int (*deviceBatchInitStep_)(deviceBatch_ *r);
+typedef int (*deviceBatchIntegrate_)(deviceBatch_ *r);
+typedef int (*deviceBatchMinStep_)(deviceBatch_ *r, double *minStep);
+typedef int (*deviceBatchDestroy_)(deviceBatch_ **r);
+typedef deviceBatch_ * (*deviceBatchNew_)(device_ **devices, int numDevices);
 
 typedef struct _deviceClass deviceClass_;
 struct _deviceClass {
@@ -50,8 +63,15 @@ struct _deviceClass {
 	deviceInitStep_ initStep;
 	deviceStep_ step;
 	deviceMinStep_ minStep;
-	deviceNextStep_ nextStep;
+	deviceNextBreak_ nextBreak; /* first break-point after time */
+	deviceDelay_ delay; /* a corner it saw reappears this much later */
 	deviceIntegrate_ integrate;
+	/* Batched Transient Analysis (can be NULL) */
+	deviceBatchNew_ batchNew;
+	deviceBatchDestroy_ batchDestroy;
+	deviceBatchInitStep_ batchInitStep;
+	deviceBatchMinStep_ batchMinStep;
+	deviceBatchIntegrate_ batchIntegrate;
 };
 
 /* Basic Data Structure Defintion */
@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 2006 Cooper Street Innovations Inc.
+ *	Charles Eidsness    <charles@cooper-street.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ */
+
+#ifndef DISPATCH_H
+#define DISPATCH_H
+
+#include <data.h>
+
+#include "device.h"
+
+/* Per analysis phase arrays of the devices that implement the phase,
+ * grouped by device class. Built once the circuit is locked so the time
+ * stepping loop only visits devices that have something to do.
+ */
+typedef struct _dispatch dispatch_;
+
+/* Operating Point */
+int dispatchLoad(dispatch_ *r);
+int dispatchLinearize(dispatch_ *r, int *linear);
+
+/* Transient Analysis */
+int dispatchInitStep(dispatch_ *r);
+int dispatchStep(dispatch_ *r, int *breakPoint);
+int dispatchMinStep(dispatch_ *r, double *minStep);
+
+/* Future break-points are kept in a queue, each device's next one is added
+ * by dispatchInitBreak and replaced once it's reached. dispatchBreak is
+ * called after every step and adds the delayed copies of the corners the
+ * devices with a delay saw.
+ */
+int dispatchInitBreak(dispatch_ *r);
+int dispatchNextStep(dispatch_ *r, double *nextStep);
+int dispatchBreak(dispatch_ *r, double time);
+
+int dispatchIntegrate(dispatch_ *r);
+
+int dispatchDestroy(dispatch_ **r);
+dispatch_ * dispatchNew(dispatch_ *r, control_ *control, list_ *devices);
+
+#endif
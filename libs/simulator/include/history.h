@@ -22,25 +22,30 @@
 #ifndef HISTORY_H
 #define HISTORY_H
 
-#include <data.h>
-
+/* Every accepted time-point, stored as rows of time followed by the
+ * solution so the buffer can be handed to the caller as the results
+ * without a copy. The times are also kept in a dense array of their own
+ * for searching. A history can keep just some of the solution rows, and
+ * only the most recent points if it's told how far back it has to go.
+ */
 typedef struct _history history_;
 
-listSearchReturn_ historySearch(history_ *r, history_ *next, double *time);
-listSearchReturn_ historySearchBreak(history_ *r, history_ *next,
-		double *time);
+int historyRecord(history_ *r, double time, double *data, unsigned int flag);
+int historySearch(history_ *r, double time, int *index);
 
-int historyRecall(history_ *r, double *data, int length);
-int historyGetTime(history_ *r, double *time);
-int historyGetData(history_ *r, double *data, int index);
-int historyGetAllData(history_ *r, double *data, int length);
+int historyGetTime(history_ *r, int index, double *time);
+int historyGetData(history_ *r, int index, int row, double *data);
 int historyGetLength(history_ *r);
+int historyTakeData(history_ *r, double **data, int *numPoints);
+
+int historyClear(history_ *r);
+int historyRetain(history_ *r, double window);
+int historyInitialize(history_ *r, int length, int *rows, int numRows);
 
-int historyDestroy(history_ *r);
+int historyDestroy(history_ **r);
 
 #define HISTORY_FLAG_BRKPOINT	(1<<0)
 #define HISTORY_FLAG_END		(1<<1)
-history_ * historyNew(double time, double *data,int length,
-		unsigned int flag);
+history_ * historyNew(history_ *r);
 
 #endif
@@ -31,6 +31,6 @@ int historyInterpGetData(historyInterp_ *r, int index, double *data);
 
 int historyInterpInitialize(historyInterp_ *r);
 int historyInterpDestroy(historyInterp_ **r);
-historyInterp_ * historyInterpNew(historyInterp_ *r, list_ *history);
+historyInterp_ * historyInterpNew(historyInterp_ *r, history_ *history);
 
 #endif
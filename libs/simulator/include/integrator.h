@@ -24,6 +24,8 @@
 
 #include "control.h"
 
+double integratorErrorConstant(control_ *control, int order);
+
 typedef struct _integrator integrator_;
 
 int integratorNextStep(integrator_ *r, double x0, double *h);
@@ -37,4 +39,18 @@ int integratorDestroy(integrator_ **r);
 integrator_ * integratorNew(integrator_ *r, control_ *control, double *ydtdx,
 		char units);
 
+/* Structure of arrays version for elements that are always integrated
+ * together, the arguments are arrays with one entry per element.
+ */
+typedef struct _integratorBank integratorBank_;
+
+int integratorBankNextStep(integratorBank_ *r, double *x0, double *h);
+int integratorBankIntegrate(integratorBank_ *r, double *x0, double *dydx0,
+		double *y0);
+int integratorBankInitialize(integratorBank_ *r, double *ic);
+
+int integratorBankDestroy(integratorBank_ **r);
+integratorBank_ * integratorBankNew(integratorBank_ *r, control_ *control,
+		int length, double *ydtdx[], char units);
+
 #endif
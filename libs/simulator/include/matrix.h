@@ -25,22 +25,37 @@
 #include <data.h>
 #include "row.h"
 #include "node.h"
+#include "stamp.h"
 #include "control.h"
+#include "history.h"
 
 typedef struct _matrix matrix_;
 
 int matrixSolve(matrix_ *r);
 int matrixSolveAgain(matrix_ *r);
+int matrixSetStep(matrix_ *r, double step, int order);
 
 node_ * matrixFindOrAddNode(matrix_ *r, row_ *row, row_ *col);
 row_ * matrixFindOrAddRow(matrix_ *r, char rowType, char *rowName);
+stamp_ * matrixAddStamp(matrix_ *r, int numNodes, node_ *nodes[],
+		int numRows, row_ *rows[], int dynamic);
 
 int matrixWriteRawfile(matrix_ *r, control_ *control);
 
 int matrixClear(matrix_ *r);
 int matrixRecall(matrix_ *r);
 int matrixRecord(matrix_ *r, double time, unsigned int flag);
-list_ * matrixGetHistory(matrix_ *r);
+int matrixPredict(matrix_ *r, double time, int order);
+int matrixPredictConverged(matrix_ *r, control_ *control);
+int matrixPredictStep(matrix_ *r, control_ *control, double step, int order,
+		double *nextStep);
+history_ * matrixGetHistory(matrix_ *r);
+int matrixRequireRow(matrix_ *r, row_ *row, double *lookBack);
+int matrixSave(matrix_ *r, char *variable);
+int matrixGetBlocks(matrix_ *r, int *numBlocks, int *maxBlock);
+int matrixGetSymbolicStats(int *hits, int *misses);
+int matrixGetStats(matrix_ *r, int *factorizations, int *refactorizations,
+		int *substitutions);
 int matrixGetSolution(matrix_ *r, double *data[], char **variables[],
 		int *numPoints, int *numVariables);
 
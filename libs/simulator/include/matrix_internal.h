@@ -0,0 +1,205 @@
+/*
+ * Copyright (C) 2006 Cooper Street Innovations Inc.
+ *	Charles Eidsness    <charles@cooper-street.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ */
+
+#ifndef MATRIX_INTERNAL_H
+#define MATRIX_INTERNAL_H
+
+#include <data.h>
+
+#include "matrix.h"
+
+/* LU Library (Backend) Class Definitions
+ *
+ * Every LU library works on the same compressed column copy of A that the
+ * matrix object builds in matrixInitialize (A, aRow, aColStart, lenA and
+ * lenXB) and solves A*X = B in place in the X and B vectors. The matrix
+ * object decides which of the class functions to call:
+ *
+ *	config   -- Allocate the private structure and any workspace. Called
+ *				once after the pattern of A is fixed.
+ *	unconfig -- Release everything allocated by config and factor.
+ *	factor   -- Full factorization of A, including pivoting and any
+ *				symbolic analysis. Must always succeed on a non-singular A.
+ *	refactor -- Numeric only factorization reusing the pivot order and
+ *				structure of the last factor call. Returns a positive value
+ *				if the old pivot order is no longer stable, factor is called
+ *				in that case. Can be NULL if the library doesn't support it.
+ *	solve    -- Forward/back substitution, X = inv(A)*B, using the factors
+ *				from the last factor or refactor call. Returns a positive
+ *				value if the factors aren't accurate enough for X, they're
+ *				dropped and factor is called before solving again.
+ */
+typedef int (*matrixLibraryConfig_)(matrix_ *r, control_ *control);
+typedef int (*matrixLibraryUnconfig_)(matrix_ *r);
+typedef int (*matrixLibraryFactor_)(matrix_ *r);
+typedef int (*matrixLibraryRefactor_)(matrix_ *r);
+typedef int (*matrixLibrarySolve_)(matrix_ *r);
+
+typedef struct _matrixLibraryClass matrixLibraryClass_;
+struct _matrixLibraryClass {
+	char *name;
+	matrixLibraryConfig_ config;
+	matrixLibraryUnconfig_ unconfig;
+	matrixLibraryFactor_ factor;
+	matrixLibraryRefactor_ refactor;
+	matrixLibrarySolve_ solve;
+};
+
+/* Basic Data Structure Definition */
+typedef struct _matrixLibrary matrixLibrary_;
+typedef struct {
+	int row;
+	int col;
+	node_ *node;
+} matrixNodeEntry_;
+
+/* Accepted points kept for the predictor, enough for the highest order */
+#define MATRIX_PREDICT_POINTS	7
+
+/* One cached factorization, A is kept to be sure it's the same matrix */
+typedef struct {
+	matrixLibrary_ *library;
+	double *A;
+	double step;
+	int order;
+	int valid;
+	unsigned int used; /* for least recently used replacement */
+} matrixCacheEntry_;
+
+/* Symbolic analysis shared by every matrix with the same pattern, for the
+ * life of the process. Found by the fingerprint of the pattern, see
+ * matrixSymbolicFind and matrixSymbolicAdd in matrix.c, the table has to be
+ * locked while an entry is in use.
+ */
+typedef struct {
+	unsigned long long fingerprint;
+	int lenXB;
+	int lenA;
+	int *aColStart; /* a copy of the pattern */
+	int *aRow;
+	int numBlocks; /* see matrixInitializeBlocks */
+	int maxBlock;
+	int superluOrdering; /* control ordering superluPermC came from */
+	int *superluPermC; /* NULL until the first SuperLU factorization */
+	int cktluBlocks; /* 0 until the first CktLU analysis */
+	int *cktluPs;
+	int *cktluQ;
+	int *cktluR;
+	unsigned int used; /* for least recently used replacement */
+} matrixSymbolic_;
+
+struct _matrix {
+	list_ *nodes;
+	list_ *rows;
+	history_ *history; /* results, the saved rows at every time-point */
+	history_ *internal; /* the rows devices need to look back at */
+	list_ *stamps;
+	/* Lookup Tables */
+	hash_ *rowHash; /* row name to row */
+	char *rowKey;
+	int rowKeyLength;
+	matrixNodeEntry_ *nodeTable; /* open addressed, (row, col) to node */
+	unsigned int nodeTableSize; /* always a power of 2 */
+	unsigned int nodeTableCount;
+	/* Data */
+	double *A;
+	int *aRow;
+	int *aColStart;
+	double *X;
+	double *B;
+	double *aBase; /* A without the dynamic stamps, see matrixAssemble */
+	double *bBase;
+	stamp_ **dynamic;
+	int numDynamic;
+	int lenA;
+	int lenXB;
+	int index;
+	unsigned long long fingerprint; /* of the pattern of A */
+	int numBlocks; /* diagonal blocks in block triangular form */
+	int maxBlock;
+	int changed; /* A has changed since it was last factored */
+	int factored; /* The LU library holds valid factors */
+	double *XLast; /* X at the last recorded time-point */
+	/* Saved Variables */
+	char **saveNames; /* NULL to save everything */
+	row_ **saveRows;
+	int numSaves;
+	int saveChanged; /* the results history has to be set up again */
+	int *required; /* row indexes kept in the internal history */
+	double **lookBacks; /* how far back each required row is needed */
+	int numRequired;
+	/* Chord (Modified Newton) Iterations */
+	int chord;
+	double chordRate; /* maximum accepted ratio of successive updates */
+	double chordDelta; /* size of the last update, 0 if unknown */
+	int chordSlow; /* converging too slowly, refactor on the next pass */
+	double *chordX;
+	double *chordR;
+	/* Low Rank (Woodbury) Updates */
+	int woodburyRank; /* maximum rank of A - Afactored, 0 to disable */
+	int woodburyUsed;
+	int woodburySolved;
+	int *woodburySlot; /* row/col index to slot, -1 if not in the update */
+	int *woodburyIndex; /* slot to row/col index */
+	int *woodburyPiv;
+	double *woodburyA; /* A when it was last factored */
+	double *woodburyZ; /* inv(Afactored) column for each slot */
+	double *woodburyM; /* A - Afactored on the slots */
+	double *woodburyG;
+	double *woodburyT;
+	double *woodburyE;
+	/* Factorization Cache */
+	matrixCacheEntry_ *cache;
+	int cacheSize; /* 0 to disable */
+	int cacheCurrent; /* entry that's in library */
+	unsigned int cacheClock;
+	double cacheStep; /* time step the next solve is for, 0 if not stepping */
+	int cacheOrder;
+	/* Predictor, the points accepted since the last break-point */
+	int predict; /* 0 to disable */
+	char *units; /* V or A for each entry in X */
+	double predictT[MATRIX_PREDICT_POINTS];
+	double *predictPast; /* MATRIX_PREDICT_POINTS copies of X */
+	int predictHead; /* slot of the newest point */
+	int predictCount;
+	int predictOrder; /* of the last prediction, 0 if there wasn't one */
+	double predictTime;
+	double *predictX; /* the last prediction */
+	/* Statistics */
+	int factorCount;
+	int refactorCount;
+	int substituteCount;
+	/* LU Library */
+	matrixLibraryClass_ *class;
+	matrixLibrary_ *library;
+};
+
+int matrixSymbolicLock();
+int matrixSymbolicUnlock();
+matrixSymbolic_ * matrixSymbolicFind(matrix_ *r);
+matrixSymbolic_ * matrixSymbolicAdd(matrix_ *r);
+
+/* Available LU Libraries */
+extern matrixLibraryClass_ matrixSuperLU;
+extern matrixLibraryClass_ matrixDense;
+extern matrixLibraryClass_ matrixCktLU;
+
+#endif
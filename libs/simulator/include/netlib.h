@@ -46,6 +46,9 @@ int netlibRPOLY(double *op, int *degree, double *zeror, double *zeroi);
 
 int netlibDGETRF(int m, int n, double *A, int lda, int *ipiv);
 
+int netlibDGETRS(char trans, int n, int nrhs, double *A, int lda, int *ipiv,
+		double *b, int ldb);
+
 int netlibDGETRI(int n, double *A, int lda, int *ipiv, double *work, int lwork);
 
 int netlibERF(double x, double *y);
@@ -31,8 +31,7 @@ typedef struct {
 
 extern node_ gndNode;
 
-listFindReturn_ nodeCompare(node_ *r, nodeIndex_ *index);
-listAddReturn_ nodeAdd(node_ *r, node_ *newNode);
+int nodeCompare(node_ **a, node_ **b);
 
 int nodeGetCol(node_ *r);
 int nodeGetRow(node_ *r);
@@ -40,7 +39,8 @@ int nodeGetRow(node_ *r);
 int nodeDataPlus(node_ *r, double plus);
 int nodeDataSet(node_ *r, double value);
 int nodeDataClear(node_ *r);
-int nodeSetDataPtr(node_ *r, double *data);
+int nodeSetDataPtr(node_ *r, double *data, int *changed);
+double * nodeGetDataPtr(node_ *r);
 
 int nodeDestroy(node_ *r);
 node_ * nodeNew(nodeIndex_ index);
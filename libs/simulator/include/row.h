@@ -33,8 +33,6 @@ typedef struct {
 
 extern row_ gndRow;
 
-listFindReturn_ rowCompare(row_ *r, rowName_ *name);
-
 char * rowGetName(row_ *r);
 int rowGetIndex(row_ *r);
 double rowGetSolution(row_ *r);
@@ -27,6 +27,11 @@
 
 typedef struct _simulator simulator_;
 
+/* The data returned by a run is handed over without a copy, it belongs to
+ * the caller and has to be freed by it. Every run only returns the points
+ * it added, so a transient that's continued (restart == 0) starts where
+ * the last one ended and its first point repeats that run's last time.
+ */
 int simulatorRunTransient(simulator_ *r,
 	double tstep,	/* Seconds */
 	double tstop,	/* Seconds */
@@ -42,6 +47,25 @@ int simulatorRunOperatingPoint(simulator_ *r,
 	int *numPoints,
 	int *numVariables);
 
+/* Only the saved variables (i.e. v(1) or i(Vx)) are returned from a run,
+ * everything is if none are, NULL clears the list. Takes effect the next
+ * time the simulator is (re)started.
+ */
+int simulatorSave(simulator_ *r,
+	char *variable);
+
+/* Sets an analysis option by its lower case Spice style name (i.e. reltol,
+ * maxorder), enumerated options take the number of their value:
+ *	method		0 trap, 1 gear
+ *	lulibrary	0 superlu, 1 dense, 2 cktlu, 3 auto
+ *	luordering	0 colamd, 1 mmd_ata, 2 mmd_atplusa, 3 natural, 4 auto
+ * The lu options, chord, woodburyrank and predictor have to be set before
+ * the first analysis.
+ */
+int simulatorSetOption(simulator_ *r,
+	char *name,
+	double value);
+
 int simulatorAddResistor(simulator_ *r,
 	char *refdes,
 	char *pNode,
@@ -142,6 +166,17 @@ int simulatorAddCallbackSource(simulator_ *r,
 
 int simulatorInfo(void);
 int simulatorPrintDevices(simulator_ *r);
+int simulatorGetStats(simulator_ *r,
+	int *factorizations,	/* Full LU factorizations (can be NULL) */
+	int *refactorizations,	/* Numeric only refactorizations (can be NULL) */
+	int *substitutions,		/* Solves that reused the last LU (can be NULL) */
+	int *bypasses);			/* Device evaluations skipped (can be NULL) */
+int simulatorGetBlocks(simulator_ *r,
+	int *numBlocks,		/* Independent diagonal blocks (can be NULL) */
+	int *maxBlock);		/* Unknowns in the largest block (can be NULL) */
+int simulatorGetSymbolicStats(	/* Shared by every simulator in the process */
+	int *hits,			/* Topologies that had been analyzed (can be NULL) */
+	int *misses);		/* Topologies analyzed from scratch (can be NULL) */
 
 int simulatorDestroy(simulator_ **r);
 simulator_ * simulatorNew(simulator_ *r);
@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2006 Cooper Street Innovations Inc.
+ *	Charles Eidsness    <charles@cooper-street.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ */
+
+#ifndef STAMP_H
+#define STAMP_H
+
+#include "row.h"
+#include "node.h"
+
+/* A stamp is a device's set of entries in A and B compiled into offsets
+ * when the matrix is initialized, entries in the gnd row or column point
+ * at a scratch slot past the end of the arrays. The macros below are meant
+ * for the load, linearize and integrate paths, they don't check anything.
+ *
+ * StampPlus, StampSet and StampRHSPlus write into the matrix's base A and
+ * B, that's where time invariant values belong. A dynamic stamp also holds
+ * a full value for each of its entries, set with StampValue and
+ * StampRHSValue, which are added to the base before every solve.
+ */
+typedef struct _stamp stamp_;
+struct _stamp {
+	int numNodes;
+	int numRows;
+	node_ **nodes;	/* Only valid until the stamp has been compiled */
+	row_ **rows;
+	int *a;		/* Offset into A for each node */
+	int *b;		/* Offset into B and X for each row */
+	double *value;	/* Dynamic value for each node, NULL if static */
+	double *rhs;	/* Dynamic value for each row, NULL if static */
+	double *A;
+	double *B;
+	double *X;
+	int *changed;
+};
+
+/* Add plus to A for node i */
+#define StampPlus(s, i, plus) \
+	do { \
+		double *_data = &(s)->A[(s)->a[i]]; \
+		if((*_data + (plus)) != *_data) { \
+			*_data += (plus); \
+			*(s)->changed = 1; \
+		} \
+	} while(0)
+
+/* Set A for node i to value */
+#define StampSet(s, i, value) \
+	do { \
+		double *_data = &(s)->A[(s)->a[i]]; \
+		if(*_data != (value)) { \
+			*_data = (value); \
+			*(s)->changed = 1; \
+		} \
+	} while(0)
+
+/* Add plus to B for row i */
+#define StampRHSPlus(s, i, plus) ((s)->B[(s)->b[i]] += (plus))
+
+/* Set the dynamic value for node i */
+#define StampValue(s, i, v) \
+	do { \
+		if((s)->value[i] != (v)) { \
+			(s)->value[i] = (v); \
+			*(s)->changed = 1; \
+		} \
+	} while(0)
+
+/* Set the dynamic value for row i */
+#define StampRHSValue(s, i, v) ((s)->rhs[i] = (v))
+
+/* Solution for row i, always 0.0 for the gnd row */
+#define StampSolution(s, i) ((s)->X[(s)->b[i]])
+
+int stampCompile(stamp_ *r, double *A, int lenA, double *B, double *X,
+		int lenXB, int *changed);
+
+int stampAssemble(stamp_ *r, double *A, double *B, int changed);
+int stampClear(stamp_ *r);
+
+int stampDestroy(stamp_ *r);
+stamp_ * stampNew(int numNodes, node_ *nodes[], int numRows, row_ *rows[],
+		int dynamic);
+
+#endif
@@ -26,7 +26,8 @@
 
 typedef struct _waveform waveform_;
 
-int waveformNextStep(waveform_ *r, double *nextStep);
+/* The first break-point (corner) after time, HUGE_VAL if there isn't one */
+int waveformNextBreak(waveform_ *r, double time, double *nextBreak);
 int waveformCalcValue(waveform_ *r, double *value);
 
 int waveformInitialize(waveform_ *r);
@@ -0,0 +1,162 @@
+/*
+ * Copyright (C) 2006 Cooper Street Innovations Inc.
+ *	Charles Eidsness    <charles@cooper-street.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ */
+
+#include <math.h>
+#include <log.h>
+
+#include "breakqueue.h"
+
+#define BREAKQUEUE_START	16	/* Initial number of entries */
+
+typedef struct {
+	double time;
+	void *owner;
+} breakqueueEntry_;
+
+struct _breakqueue {
+	breakqueueEntry_ *heap;	/* heap[0] is the earliest break-point */
+	int length;
+	int size;
+};
+
+/*===========================================================================*/
+
+int breakqueueAdd(breakqueue_ *r, double time, void *owner)
+{
+	breakqueueEntry_ *heap, entry;
+	int i;
+
+	ReturnErrIf(r == NULL);
+	ReturnErrIf(isnan(time));
+
+	if(r->length >= r->size) {
+		heap = realloc(r->heap, 2 * r->size * sizeof(breakqueueEntry_));
+		ReturnErrIf(heap == NULL, "Malloc Failed");
+		r->heap = heap;
+		r->size *= 2;
+	}
+
+	/* Sift up from the end */
+	entry.time = time;
+	entry.owner = owner;
+	for(i = r->length++; i > 0; i = (i - 1) / 2) {
+		if(r->heap[(i - 1) / 2].time <= time) {
+			break;
+		}
+		r->heap[i] = r->heap[(i - 1) / 2];
+	}
+	r->heap[i] = entry;
+
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+int breakqueuePeek(breakqueue_ *r, double *time, void **owner)
+{
+	ReturnErrIf(r == NULL);
+	ReturnErrIf(time == NULL);
+	ReturnErrIf(owner == NULL);
+
+	if(r->length == 0) {
+		*time = HUGE_VAL;
+		*owner = NULL;
+	} else {
+		*time = r->heap[0].time;
+		*owner = r->heap[0].owner;
+	}
+
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+int breakqueuePop(breakqueue_ *r)
+{
+	breakqueueEntry_ entry;
+	int i, child;
+
+	ReturnErrIf(r == NULL);
+	ReturnErrIf(r->length == 0);
+
+	/* Sift the last entry down from the top */
+	entry = r->heap[--r->length];
+	for(i = 0; (child = 2 * i + 1) < r->length; i = child) {
+		if((child + 1 < r->length) &&
+				(r->heap[child + 1].time < r->heap[child].time)) {
+			child++;
+		}
+		if(entry.time <= r->heap[child].time) {
+			break;
+		}
+		r->heap[i] = r->heap[child];
+	}
+	r->heap[i] = entry;
+
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+int breakqueueClear(breakqueue_ *r)
+{
+	ReturnErrIf(r == NULL);
+	r->length = 0;
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+int breakqueueDestroy(breakqueue_ **r)
+{
+	ReturnErrIf(r == NULL);
+	ReturnErrIf((*r) == NULL);
+	Debug("Destroying Break Queue %p", *r);
+
+	if((*r)->heap != NULL) {
+		free((*r)->heap);
+	}
+
+	free(*r);
+	*r = NULL;
+
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+breakqueue_ * breakqueueNew(breakqueue_ *r)
+{
+	ReturnNULLIf(r != NULL);
+
+	r = calloc(1, sizeof(breakqueue_));
+	ReturnNULLIf(r == NULL, "Malloc Failed");
+
+	Debug("Creating Break Queue %p", r);
+
+	r->heap = malloc(BREAKQUEUE_START * sizeof(breakqueueEntry_));
+	ReturnNULLAndFreeIf(r, r->heap == NULL, "Malloc Failed");
+	r->size = BREAKQUEUE_START;
+
+	return r;
+}
+
+/*===========================================================================*/
@@ -0,0 +1,253 @@
+/*
+ * Copyright (C) 2006 Cooper Street Innovations Inc.
+ *	Charles Eidsness    <charles@cooper-street.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ */
+
+#include <math.h>
+#include <log.h>
+
+#include "control.h"
+#include "row.h"
+#include "checkbypass.h"
+
+#define MaxAbs(x,y) ((fabs(x) > fabs(y)) ? fabs(x) : fabs(y))
+
+/* Spice style device bypass, a nonlinear device remembers the inputs and
+ * the value it was last fully evaluated at and is skipped, keeping its
+ * stamp, while its last verdict was converged, none of the inputs has
+ * moved by more than the convergence tolerances and the value predicted
+ * from the derivatives hasn't moved either. The record is kept from one
+ * time point to the next so an idle device is skipped from the first
+ * pass, only a device whose value moves with time has to start over.
+ */
+
+typedef struct {
+	row_ *pos;
+	row_ *neg;		/* NULL if it's a single row */
+	char units;
+	double *deriv;	/* d(value)/d(input), NULL if there is none */
+	double last;	/* at the last full evaluation */
+	double now;
+} checkbypassInput_;
+
+struct _checkbypass {
+	control_ *control;
+	int valid;		/* there's been a full evaluation since the last reset */
+	int converged;	/* the device passed its last convergence check */
+	char units;
+	double value;	/* at the last full evaluation */
+	int length;
+	checkbypassInput_ *inputs;
+};
+
+/*===========================================================================*/
+
+static double checkbypassTolerance(checkbypass_ *r, char units, double x,
+		double y)
+{
+	if(units == 'V') {
+		return r->control->reltol * MaxAbs(x, y) + r->control->vntol;
+	} else if(units == 'A') {
+		return r->control->reltol * MaxAbs(x, y) + r->control->abstol;
+	}
+	return r->control->reltol * MaxAbs(x, y) + r->control->captol;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static int checkbypassGetInputs(checkbypass_ *r)
+{
+	checkbypassInput_ *input;
+	int i;
+
+	for(i = 0; i < r->length; i++) {
+		input = &r->inputs[i];
+		input->now = rowGetSolution(input->pos);
+		if(input->neg != NULL) {
+			input->now -= rowGetSolution(input->neg);
+		}
+		ReturnErrIf(isnan(input->now));
+	}
+
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+int checkbypassIsBypass(checkbypass_ *r)
+{
+	checkbypassInput_ *input;
+	double predicted;
+	int i;
+
+	ReturnErrIf(r == NULL);
+
+	if(!r->control->bypass) {
+		return 0;
+	}
+
+	ReturnErrIf(checkbypassGetInputs(r));
+
+	/* Never skip the evaluation after a pass that didn't converge, the
+	 * stamp has to move for the next one to get any closer
+	 */
+	if(!r->valid || !r->converged) {
+		return 0;
+	}
+
+	predicted = r->value;
+	for(i = 0; i < r->length; i++) {
+		input = &r->inputs[i];
+		if(!(fabs(input->now - input->last) <= checkbypassTolerance(r,
+				input->units, input->now, input->last))) {
+			return 0;
+		}
+		if(input->deriv != NULL) {
+			predicted += (*input->deriv) * (input->now - input->last);
+		}
+	}
+
+	/* The inputs can be within tolerance while the value isn't, i.e. a
+	 * forward biased diode's current
+	 */
+	if(!(fabs(predicted - r->value) <= checkbypassTolerance(r, r->units,
+			predicted, r->value))) {
+		return 0;
+	}
+
+	r->control->bypasses++;
+	return 1;
+}
+
+/*---------------------------------------------------------------------------*/
+
+int checkbypassRecord(checkbypass_ *r, double value, int converged)
+{
+	int i;
+
+	ReturnErrIf(r == NULL);
+
+	if(!r->control->bypass) {
+		return 0;
+	}
+
+	for(i = 0; i < r->length; i++) {
+		r->inputs[i].last = r->inputs[i].now;
+	}
+	r->value = value;
+	r->converged = converged;
+	r->valid = 1;
+
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Records the convergence check of a pass that was bypassed */
+int checkbypassConverged(checkbypass_ *r, int converged)
+{
+	ReturnErrIf(r == NULL);
+	r->converged = converged;
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Adds an input, the solution of pos minus the solution of neg (neg can be
+ * NULL). If units is 0x0 they come from the row name, i.e. v(...) or i(...)
+ */
+int checkbypassAddInput(checkbypass_ *r, row_ *pos, row_ *neg, char units,
+		double *deriv)
+{
+	checkbypassInput_ *inputs;
+	char *name;
+
+	ReturnErrIf(r == NULL);
+	ReturnErrIf(pos == NULL);
+
+	if(units == 0x0) {
+		name = rowGetName(pos);
+		ReturnErrIf(name == NULL);
+		units = (name[0] == 'v') ? 'V' : 'A';
+	}
+	ReturnErrIf((units != 'A') && (units != 'V') && (units != 'F'));
+
+	inputs = realloc(r->inputs, (r->length + 1) * sizeof(checkbypassInput_));
+	ReturnErrIf(inputs == NULL, "Malloc Failed");
+	r->inputs = inputs;
+
+	inputs[r->length].pos = pos;
+	inputs[r->length].neg = neg;
+	inputs[r->length].units = units;
+	inputs[r->length].deriv = deriv;
+	inputs[r->length].last = 0.0;
+	inputs[r->length].now = 0.0;
+	r->length++;
+
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+int checkbypassInitialize(checkbypass_ *r)
+{
+	ReturnErrIf(r == NULL);
+	r->valid = 0;
+	r->converged = 0;
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+int checkbypassDestroy(checkbypass_ **r)
+{
+	ReturnErrIf(r == NULL);
+	ReturnErrIf((*r) == NULL);
+	Debug("Destroying Bypass Check %p", *r);
+
+	if((*r)->inputs != NULL) {
+		free((*r)->inputs);
+	}
+	free(*r);
+	*r = NULL;
+
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* units are the units of the device's value, i.e. its calculated current */
+checkbypass_ * checkbypassNew(checkbypass_ *r, control_ *control, char units)
+{
+	ReturnNULLIf(r != NULL);
+	ReturnNULLIf(control == NULL);
+	ReturnNULLIf((units != 'A') && (units != 'V') && (units != 'F'));
+
+	r = calloc(1, sizeof(checkbypass_));
+	ReturnNULLIf(r == NULL, "Malloc Failed");
+
+	Debug("Creating Bypass Check %p", r);
+
+	r->control = control;
+	r->units = units;
+
+	return r;
+}
+
+/*===========================================================================*/
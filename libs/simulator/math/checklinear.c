@@ -92,6 +92,17 @@ int checklinearIsLinear(checklinear_ *r, double V, double calcedV)
 
 /*---------------------------------------------------------------------------*/
 
+/* The last value passed both checks, it may still be waiting on a second
+ * pass to be declared linear.
+ */
+int checklinearPassed(checklinear_ *r)
+{
+	ReturnErrIf(r == NULL);
+	return (r->state != 'a');
+}
+
+/*---------------------------------------------------------------------------*/
+
 int checklinearInitialize(checklinear_ *r, double ic)
 {
 	ReturnErrIf(r == NULL);
@@ -29,11 +29,10 @@
 #define MaxAbs(x,y) ((fabs(x) > fabs(y)) ? fabs(x) : fabs(y))
 
 struct _historyInterp {
-	list_ *history;
-	listNode_ *historyNode; /* This is used to store the history of the last
-						   	history search, to speed up the next one */
-	history_ *prevData;
-	history_ *nextData;
+	history_ *history;
+	int index; /* Point found by the last search, to speed up the next one */
+	int prev;
+	int next;
 	double time;
 };
 
@@ -45,19 +44,16 @@ int historyInterpSetTime(historyInterp_ *r, double time)
 	r->time = time;
 
 	/* first get the point before the time */
-	ReturnErrIf(listSearch(r->history, &r->time, (listSearch_)historySearch,
-			&r->historyNode, (void*)&r->prevData));
-	ReturnErrIf(r->historyNode == NULL);
-
-	/* first get the point after the time */
-	ReturnErrIf(listNodeGetNext(r->historyNode, (void*)&r->nextData));
+	ReturnErrIf(historySearch(r->history, r->time, &r->index));
+	r->prev = r->index;
+	r->next = r->index + 1;
 
 	/* If we're at the end of the history list use previous two
 	 * points for interpolation
 	 */
-	if(r->nextData == NULL) {
-		r->nextData = r->prevData;
-		ReturnErrIf(listNodeGetPrevious(r->historyNode, (void*)&r->prevData));
+	if(r->next >= historyGetLength(r->history)) {
+		r->next = r->prev;
+		r->prev = r->prev - 1;
 	}
 
 	return 0;
@@ -70,17 +66,16 @@ int historyInterpGetData(historyInterp_ *r, int index, double *data)
 	double tP, tN, xP, xN;
 
 	ReturnErrIf(r == NULL);
-	ReturnErrIf(r->prevData == NULL);
-	ReturnErrIf(r->nextData == NULL);
+	ReturnErrIf(r->prev < 0);
 	ReturnErrIf(data == NULL);
 	ReturnErrIf(index < 0);
 
 	if(index != rowGetIndex(&gndRow)) {
-		ReturnErrIf(historyGetTime(r->prevData, &tP));
-		ReturnErrIf(historyGetTime(r->nextData, &tN));
+		ReturnErrIf(historyGetTime(r->history, r->prev, &tP));
+		ReturnErrIf(historyGetTime(r->history, r->next, &tN));
 
-		ReturnErrIf(historyGetData(r->prevData, &xP, index-1));
-		ReturnErrIf(historyGetData(r->nextData, &xN, index-1));
+		ReturnErrIf(historyGetData(r->history, r->prev, index, &xP));
+		ReturnErrIf(historyGetData(r->history, r->next, index, &xN));
 
 		/* Linear Interpolation */
 		*data = ( (xN-xP) / (tN-tP) ) * (r->time - tP) + xP;
@@ -96,9 +91,9 @@ int historyInterpGetData(historyInterp_ *r, int index, double *data)
 int historyInterpInitialize(historyInterp_ *r)
 {
 	ReturnErrIf(r == NULL);
-	r->historyNode = NULL;
-	r->prevData = NULL;
-	r->nextData = NULL;
+	r->index = 0;
+	r->prev = -1;
+	r->next = -1;
 	r->time = 0.0;
 	return 0;
 }
@@ -119,7 +114,7 @@ int historyInterpDestroy(historyInterp_ **r)
 
 /*---------------------------------------------------------------------------*/
 
-historyInterp_ * historyInterpNew(historyInterp_ *r, list_ *history)
+historyInterp_ * historyInterpNew(historyInterp_ *r, history_ *history)
 {
 	ReturnNULLIf(r != NULL);
 	ReturnNULLIf(history == NULL);
@@ -130,9 +125,9 @@ historyInterp_ * historyInterpNew(historyInterp_ *r, list_ *history)
 	Debug("Creating History Interpolation %p", r);
 
 	r->history = history;
-	r->historyNode = NULL;
-	r->prevData = NULL;
-	r->nextData = NULL;
+	r->index = 0;
+	r->prev = -1;
+	r->next = -1;
 	r->time = 0.0;
 
 	return r;
@@ -27,7 +27,7 @@
 
 #define MaxAbs(x,y) ((fabs(x) > fabs(y)) ? fabs(x) : fabs(y))
 
-#define N	4	/* Number of stored timesteps (i.e. max NI order plus 1) */
+#define N	8	/* Number of stored timesteps (i.e. max NI order plus 2) */
 
 /* DD = Divided Difference */
 #define DD1(xnp1, xn, hn) \
@@ -41,6 +41,114 @@
 		DD2(xn, x1, x2, h1, h2)) / \
 		(hn + h1 + h2))
 
+/* Gear (BDF) truncation error constants by order, as used by Spice */
+static const double integratorGearError[CONTROL_GEAR_MAX_ORDER] = {
+	1.0/2.0, 2.0/9.0, 3.0/22.0, 12.0/125.0, 10.0/137.0, 20.0/343.0
+};
+
+/*===========================================================================
+ |                             Gear Integration                              |
+  ===========================================================================*/
+
+/* Variable step Gear (BDF) coefficients, the derivative at tau[0] of the
+ * polynomial through tau[0], tau[1], ..., tau[order] is
+ * sum(alpha[j]*x(tau[j])).
+ */
+static int integratorGearCoefficients(double *tau, int order, double *alpha)
+{
+	double num, den;
+	int j, m;
+
+	alpha[0] = 0.0;
+	for(m = 1; m <= order; m++) {
+		alpha[0] += 1.0 / (tau[0] - tau[m]);
+	}
+
+	for(j = 1; j <= order; j++) {
+		num = 1.0;
+		den = 1.0;
+		for(m = 0; m <= order; m++) {
+			if(m != j) {
+				den *= tau[j] - tau[m];
+				if(m != 0) {
+					num *= tau[0] - tau[m];
+				}
+			}
+		}
+		alpha[j] = num / den;
+	}
+
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Divided difference of q over all of tau[0..order], q is overwritten */
+static double integratorDividedDifference(double *tau, double *q, int order)
+{
+	int j, k;
+
+	for(k = 1; k <= order; k++) {
+		for(j = 0; j <= order - k; j++) {
+			q[j] = (q[j] - q[j+1]) / (tau[j] - tau[j+k]);
+		}
+	}
+
+	return q[0];
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* The time-points relative to the newest one, n + 1, built up from the
+ * steps rather than from differences of absolute times, which pick up a
+ * different rounding error at every point, so steps of the same size
+ * always give the same coefficients.
+ */
+static int integratorTau(double *h, int n, int order, double *tau)
+{
+	int j;
+
+	tau[0] = 0.0;
+	for(j = 1; j <= order; j++) {
+		tau[j] = tau[j-1] - h[(n+1-j)%N];
+	}
+
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* The order actually used, limited by the number of points since the
+ * integrator was initialized, n, and for the error estimate, which
+ * needs one more point than the integration, by n - 1.
+ */
+static int integratorGearOrder(control_ *control, int n)
+{
+	int order = control->integratorOrder;
+
+	order = (order < n) ? order : n;
+	order = (order < CONTROL_GEAR_MAX_ORDER) ? order : CONTROL_GEAR_MAX_ORDER;
+
+	return order;
+}
+
+/*---------------------------------------------------------------------------*/
+
+double integratorErrorConstant(control_ *control, int order)
+{
+	if(control->niMethod == CONTROL_NIMETHOD_GEAR) {
+		order = (order < CONTROL_GEAR_MAX_ORDER) ?
+				order : CONTROL_GEAR_MAX_ORDER;
+		return integratorGearError[(order < 1) ? 0 : order - 1];
+	}
+
+	return (order < 2) ? 1.0/2.0 : 1.0/12.0;
+}
+
+/*===========================================================================
+ |                               Integration                                 |
+  ===========================================================================*/
+
 struct _integrator {
 	control_ *control;
 	char units;
@@ -61,6 +169,8 @@ struct _integrator {
 int integratorNextStep(integrator_ *r, double x0, double *h)
 {
 	double y0, ey = 0.0, eyp, e, dd;
+	double tau[CONTROL_GEAR_MAX_ORDER+2], q[CONTROL_GEAR_MAX_ORDER+2];
+	int j, k;
 
 	ReturnErrIf(r == NULL);
 	ReturnErrIf(h == NULL);
@@ -78,22 +188,36 @@ int integratorNextStep(integrator_ *r, double x0, double *h)
 	e = MaxAbs(eyp, ey);
 
 	/* Calculate Estimated Error of Numerical Intergration */
-	if(r->control->integratorOrder < 2) { /* Backward-Euler */
+	if(r->control->niMethod == CONTROL_NIMETHOD_GEAR) {
+		k = integratorGearOrder(r->control, r->n - 1);
+		if(k < 1) {
+			return 0;
+		}
+		ReturnErrIf(integratorTau(r->h, r->n, k + 1, tau));
+		q[0] = (*r->ydtdx) * x0;
+		for(j = 1; j <= k + 1; j++) {
+			q[j] = r->f[(r->n+1-j)%N] * r->x[(r->n+1-j)%N];
+		}
+		dd = integratorDividedDifference(tau, q, k + 1);
+		dd *= integratorGearError[k-1];
+		/* Root of the order rather than order + 1, as in Spice */
+		*h = pow(r->control->trtol * e / MaxAbs(dd , r->abstol), 1.0/k);
+	} else if(r->control->integratorOrder < 2) { /* Backward-Euler */
 		dd = DD2(((*r->ydtdx) * x0),
 				(r->f[r->n%N] * r->x[r->n%N]),
-				(r->f[(r->n-1)%N] * r->x[(r->n-1)%N]),
+				(r->f[(r->n+N-1)%N] * r->x[(r->n+N-1)%N]),
 				r->h[r->n%N],
-				r->h[(r->n-1)%N]);
+				r->h[(r->n+N-1)%N]);
 		dd *= 1.0/2.0;
 		*h = r->control->trtol * e / MaxAbs(dd , r->abstol);
 	} else { /* Trapazoidal */
 		dd = DD3(((*r->ydtdx) * x0),
 				(r->f[r->n%N] * r->x[(r->n)%N]),
-				(r->f[(r->n-1)%N] * r->x[(r->n-1)%N]),
-				(r->f[(r->n-2)%N] * r->x[(r->n-2)%N]),
+				(r->f[(r->n+N-1)%N] * r->x[(r->n+N-1)%N]),
+				(r->f[(r->n+N-2)%N] * r->x[(r->n+N-2)%N]),
 				r->h[r->n%N],
-				r->h[(r->n-1)%N],
-				r->h[(r->n-2)%N]);
+				r->h[(r->n+N-1)%N],
+				r->h[(r->n+N-2)%N]);
 				/* See page 309 of "The Spice Book" */
 		dd *= 1.0/12.0;
 		*h = sqrtf(r->control->trtol * e / MaxAbs(dd , r->abstol));
@@ -110,6 +234,8 @@ int integratorNextStep(integrator_ *r, double x0, double *h)
 int integratorIntegrate(integrator_ *r, double x0, double *dydx0, double *y0)
 {
 	double t0, mult;
+	double tau[CONTROL_GEAR_MAX_ORDER+1], alpha[CONTROL_GEAR_MAX_ORDER+1];
+	int j, k;
 
 	ReturnErrIf(r == NULL);
 	ReturnErrIf(dydx0 == NULL);
@@ -125,8 +251,10 @@ int integratorIntegrate(integrator_ *r, double x0, double *dydx0, double *y0)
 		r->n++;
 	}
 
-	/* Set New Time */
-	r->h[r->n%N] = t0 - r->t[r->n%N];
+	/* Set New Time, the step is the one the simulator chose rather than
+	 * t0 - t[n] so it matches the one the LU factors are cached under
+	 */
+	r->h[r->n%N] = r->control->step;
 	r->t[(r->n+1)%N] = t0;
 
 	/* Record X, Y, and F*/
@@ -136,12 +264,22 @@ int integratorIntegrate(integrator_ *r, double x0, double *dydx0, double *y0)
 
 	/* Calculate Next dydx0 and y0 Using Numerical Integration */
 
-	if(r->control->integratorOrder < 2) { /* Backward-Euler */
-		*dydx0 = r->f[(r->n-1)%N] / r->h[r->n%N];
+	if(r->control->niMethod == CONTROL_NIMETHOD_GEAR) {
+		/* y = f*dx/dt with f held at its present value, as for Trapazoidal */
+		k = integratorGearOrder(r->control, r->n);
+		ReturnErrIf(integratorTau(r->h, r->n, k, tau));
+		ReturnErrIf(integratorGearCoefficients(tau, k, alpha));
+		*dydx0 = alpha[0] * r->f[r->n%N];
+		*y0 = 0.0;
+		for(j = 1; j <= k; j++) {
+			*y0 -= alpha[j] * r->f[r->n%N] * r->x[(r->n+1-j)%N];
+		}
+	} else if(r->control->integratorOrder < 2) { /* Backward-Euler */
+		*dydx0 = r->f[(r->n+N-1)%N] / r->h[r->n%N];
 		*y0 = (*dydx0) * r->x[r->n%N];
 	} else { /* Trapazoidal */
 		*dydx0 = 2.0 * r->f[r->n%N] / r->h[r->n%N];
-		mult = r->f[r->n%N]/r->f[(r->n-1)%N];
+		mult = r->f[r->n%N]/r->f[(r->n+N-1)%N];
 		if(isnan(mult)) {
 			mult = 1/r->control->gmin;
 		}
@@ -235,5 +373,295 @@ integrator_ * integratorNew(integrator_ *r, control_ *control, double *ydtdx,
 	return r;
 }
 
+/*===========================================================================
+ |                            Batched Integration                            |
+  ===========================================================================*/
+
+/* The same integration as above for a set of elements that always step
+ * together, so time is shared and everything else is kept in arrays with
+ * one entry per element. x[k][i] is element i at time-point k.
+ */
+struct _integratorBank {
+	control_ *control;
+	char units;
+	double abstol;
+	int length;
+	double **ydtdx;	/* y*dt/dx of each element */
+	double *y0;
+	double *dydx0;
+	double t[N];
+	double h[N];
+	double *x[N];
+	double *y[N];
+	double *f[N];
+	double *data;	/* all of the arrays above */
+	int n;
+};
+
+/*---------------------------------------------------------------------------*/
+
+/* Lowers *h to the smallest step any element can take */
+int integratorBankNextStep(integratorBank_ *r, double *x0, double *h)
+{
+	double *xn, *x1, *x2, *yn, *fn, *f1, *f2, *y0, *dydx0;
+	double hn, h1, h2, reltol, chgtol, trtol, abstol, step, minStep;
+	double yi, ey, eyp, e, dd;
+	double tau[CONTROL_GEAR_MAX_ORDER+2], q[CONTROL_GEAR_MAX_ORDER+2];
+	int i, j, k, n, bad = 0;
+
+	ReturnErrIf(r == NULL);
+	ReturnErrIf(x0 == NULL);
+	ReturnErrIf(h == NULL);
+
+	n = r->n%N;
+	xn = r->x[n]; x1 = r->x[(r->n+N-1)%N]; x2 = r->x[(r->n+N-2)%N];
+	fn = r->f[n]; f1 = r->f[(r->n+N-1)%N]; f2 = r->f[(r->n+N-2)%N];
+	hn = r->h[n]; h1 = r->h[(r->n+N-1)%N]; h2 = r->h[(r->n+N-2)%N];
+	yn = r->y[n];
+	y0 = r->y0;
+	dydx0 = r->dydx0;
+	reltol = r->control->reltol;
+	chgtol = r->control->chgtol;
+	trtol = r->control->trtol;
+	abstol = r->abstol;
+	minStep = *h;
+
+	/* fn is y*dt/dx at this time-point, recorded by integratorBankIntegrate */
+	if(r->control->niMethod == CONTROL_NIMETHOD_GEAR) {
+		k = integratorGearOrder(r->control, r->n - 1);
+		if(k < 1) {
+			return 0;
+		}
+		ReturnErrIf(integratorTau(r->h, r->n, k + 1, tau));
+		for(i = 0; i < r->length; i++) {
+			yi = dydx0[i] * x0[i] - y0[i];
+			ey = reltol * MaxAbs(yn[i], yi) + abstol;
+			eyp = reltol * MaxAbs(MaxAbs(x0[i], xn[i]) * (fn[i] / hn), chgtol);
+			e = MaxAbs(eyp, ey);
+			q[0] = fn[i] * x0[i];
+			for(j = 1; j <= k + 1; j++) {
+				q[j] = r->f[(r->n+1-j)%N][i] * r->x[(r->n+1-j)%N][i];
+			}
+			dd = integratorDividedDifference(tau, q, k + 1);
+			dd *= integratorGearError[k-1];
+			step = pow(trtol * e / MaxAbs(dd , abstol), 1.0/k);
+			bad |= isnan(x0[i]) | isnan(step);
+			minStep = ((step > 0.0) && (step < minStep)) ? step : minStep;
+		}
+	} else if(r->control->integratorOrder < 2) { /* Backward-Euler */
+		for(i = 0; i < r->length; i++) {
+			yi = dydx0[i] * x0[i] - y0[i];
+			ey = reltol * MaxAbs(yn[i], yi) + abstol;
+			eyp = reltol * MaxAbs(MaxAbs(x0[i], xn[i]) * (fn[i] / hn), chgtol);
+			e = MaxAbs(eyp, ey);
+			dd = DD2((fn[i] * x0[i]), (fn[i] * xn[i]), (f1[i] * x1[i]), hn, h1);
+			dd *= 1.0/2.0;
+			step = trtol * e / MaxAbs(dd , abstol);
+			bad |= isnan(x0[i]) | isnan(step);
+			minStep = ((step > 0.0) && (step < minStep)) ? step : minStep;
+		}
+	} else { /* Trapazoidal */
+		for(i = 0; i < r->length; i++) {
+			yi = dydx0[i] * x0[i] - y0[i];
+			ey = reltol * MaxAbs(yn[i], yi) + abstol;
+			eyp = reltol * MaxAbs(MaxAbs(x0[i], xn[i]) * (fn[i] / hn), chgtol);
+			e = MaxAbs(eyp, ey);
+			dd = DD3((fn[i] * x0[i]), (fn[i] * xn[i]), (f1[i] * x1[i]),
+					(f2[i] * x2[i]), hn, h1, h2);
+			dd *= 1.0/12.0;
+			step = sqrtf(trtol * e / MaxAbs(dd , abstol));
+			bad |= isnan(x0[i]) | isnan(step);
+			minStep = ((step > 0.0) && (step < minStep)) ? step : minStep;
+		}
+	}
+
+	ReturnErrIf(bad);
+	*h = minStep;
+
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+int integratorBankIntegrate(integratorBank_ *r, double *x0, double *dydx0,
+		double *y0)
+{
+	double *xn, *yn, *fn, *f1;
+	double t0, hn, mult, gmin;
+	double tau[CONTROL_GEAR_MAX_ORDER+1], alpha[CONTROL_GEAR_MAX_ORDER+1];
+	int i, j, k, n, bad = 0;
+
+	ReturnErrIf(r == NULL);
+	ReturnErrIf(x0 == NULL);
+	ReturnErrIf(dydx0 == NULL);
+	ReturnErrIf(y0 == NULL);
+
+	/* See integratorIntegrate */
+	t0 = r->control->time;
+	ReturnErrIf(isnan(t0));
+	if(t0 > r->t[(r->n+1)%N]) {
+		r->n++;
+	}
+
+	n = r->n%N;
+	r->h[n] = r->control->step;
+	r->t[(r->n+1)%N] = t0;
+	hn = r->h[n];
+	xn = r->x[n];
+	yn = r->y[n];
+	fn = r->f[n];
+	f1 = r->f[(r->n+N-1)%N];
+
+	/* Record X, Y, and F */
+	for(i = 0; i < r->length; i++) {
+		fn[i] = *r->ydtdx[i];
+	}
+	for(i = 0; i < r->length; i++) {
+		xn[i] = x0[i];
+		yn[i] = r->dydx0[i] * x0[i] - r->y0[i];
+		bad |= isnan(x0[i]);
+	}
+	ReturnErrIf(bad);
+
+	if(r->control->niMethod == CONTROL_NIMETHOD_GEAR) {
+		/* See integratorIntegrate */
+		k = integratorGearOrder(r->control, r->n);
+		ReturnErrIf(integratorTau(r->h, r->n, k, tau));
+		ReturnErrIf(integratorGearCoefficients(tau, k, alpha));
+		for(i = 0; i < r->length; i++) {
+			dydx0[i] = alpha[0] * fn[i];
+			y0[i] = 0.0;
+		}
+		for(j = 1; j <= k; j++) {
+			for(i = 0; i < r->length; i++) {
+				y0[i] -= alpha[j] * fn[i] * r->x[(r->n+1-j)%N][i];
+			}
+		}
+	} else if(r->control->integratorOrder < 2) { /* Backward-Euler */
+		for(i = 0; i < r->length; i++) {
+			dydx0[i] = f1[i] / hn;
+			y0[i] = dydx0[i] * xn[i];
+		}
+	} else { /* Trapazoidal */
+		gmin = 1/r->control->gmin;
+		for(i = 0; i < r->length; i++) {
+			dydx0[i] = 2.0 * fn[i] / hn;
+			mult = fn[i] / f1[i];
+			mult = isnan(mult) ? gmin : mult;
+			y0[i] = dydx0[i] * xn[i] + mult * yn[i];
+		}
+	}
+
+	/* Store values for next time */
+	for(i = 0; i < r->length; i++) {
+		r->dydx0[i] = dydx0[i];
+		r->y0[i] = y0[i];
+	}
+
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+int integratorBankInitialize(integratorBank_ *r, double *ic)
+{
+	int i, k;
+	ReturnErrIf(r == NULL);
+	ReturnErrIf(ic == NULL);
+
+	r->n = 0;
+	for(k = 0; k < N; k++) {
+		r->t[k] = 0.0;
+		r->h[k] = r->control->tstop;
+		for(i = 0; i < r->length; i++) {
+			r->x[k][i] = ic[i];
+			r->y[k][i] = 0.0;
+			r->f[k][i] = *r->ydtdx[i];
+		}
+	}
+	for(i = 0; i < r->length; i++) {
+		r->y0[i] = 0.0;
+		r->dydx0[i] = 0.0;
+	}
+
+	if(r->units == 'V') {
+		r->abstol = r->control->vntol;
+	} else if(r->units == 'A') {
+		r->abstol = r->control->abstol;
+	} else if(r->units == 'F') {
+		r->abstol = r->control->captol;
+	} else {
+		ReturnErr("Unsupported units type");
+	}
+
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+int integratorBankDestroy(integratorBank_ **r)
+{
+	ReturnErrIf(r == NULL);
+	ReturnErrIf((*r) == NULL);
+	Debug("Destroying NI Bank %p", (*r));
+
+	if((*r)->ydtdx != NULL)
+		free((*r)->ydtdx);
+	if((*r)->data != NULL)
+		free((*r)->data);
+
+	free(*r);
+	*r = NULL;
+
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+integratorBank_ * integratorBankNew(integratorBank_ *r, control_ *control,
+		int length, double *ydtdx[], char units)
+{
+	int i, k;
+
+	ReturnNULLIf(r != NULL);
+	ReturnNULLIf(control == NULL);
+	ReturnNULLIf(length < 1);
+	ReturnNULLIf(ydtdx == NULL);
+	ReturnNULLIf((units != 'A') && (units != 'V') && (units != 'F'));
+
+	r = calloc(1, sizeof(integratorBank_));
+	ReturnNULLIf(r == NULL);
+
+	Debug("Creating NI Bank %p (%i elements)", r, length);
+
+	r->control = control;
+	r->units = units;
+	r->length = length;
+
+	r->ydtdx = malloc(length * sizeof(double*));
+	GotoFailedIf(r->ydtdx == NULL);
+	for(i = 0; i < length; i++) {
+		GotoFailedIf(ydtdx[i] == NULL);
+		r->ydtdx[i] = ydtdx[i];
+	}
+
+	/* y0, dydx0 and x, y and f for each time-point */
+	r->data = calloc((2 + 3*N) * length, sizeof(double));
+	GotoFailedIf(r->data == NULL);
+	r->y0 = r->data;
+	r->dydx0 = r->data + length;
+	for(k = 0; k < N; k++) {
+		r->x[k] = r->data + (2 + k) * length;
+		r->y[k] = r->data + (2 + N + k) * length;
+		r->f[k] = r->data + (2 + 2*N + k) * length;
+	}
+
+	return r;
+
+failed:
+	integratorBankDestroy(&r);
+	return NULL;
+}
+
 /*===========================================================================*/
 
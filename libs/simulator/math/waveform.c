@@ -170,47 +170,62 @@ static int waveformParseArgs(waveform_ *r, double *args[7], double **dcPtr)
 
 /*===========================================================================*/
 
-int waveformNextStep(waveform_ *r, double *nextStep)
+int waveformNextBreak(waveform_ *r, double time, double *nextBreak)
 {
-	double tp, time;
+	double base, per, tp;
+	int i;
+
 	ReturnErrIf(r == NULL);
-	ReturnErrIf(nextStep == NULL);
+	ReturnErrIf(nextBreak == NULL);
 
-	time = r->control->time;
+	*nextBreak = HUGE_VAL;
 
 	switch(r->type) {
 	case 'p': /* pulse */
-		tp = fmod(time,  *r->d.pulse.per);
-		*nextStep = *r->d.pulse.td - tp;
-		if(*nextStep > 0) break;
-		*nextStep += *r->d.pulse.tr;
-		if(*nextStep > 0) break;
-		*nextStep += *r->d.pulse.pw;
-		if(*nextStep > 0) break;
-		*nextStep += *r->d.pulse.tf;
-		if(*nextStep > 0) break;
-		*nextStep = *r->d.pulse.per - tp;
+		/* The corners of this period then the next, only the first one
+		 * after time is returned so the edges are found one at a time
+		 */
+		per = *r->d.pulse.per;
+		if(!(per > 0.0)) {
+			break;
+		}
+		base = time - fmod(time, per);
+		for(i = 0; i < 2; i++, base += per) {
+			tp = base + *r->d.pulse.td;
+			if(tp > time) break;
+			tp += *r->d.pulse.tr;
+			if(tp > time) break;
+			tp += *r->d.pulse.pw;
+			if(tp > time) break;
+			tp += *r->d.pulse.tf;
+			if(tp > time) break;
+			tp = base + per;
+			if(tp > time) break;
+		}
+		if(i < 2) {
+			*nextBreak = tp;
+		}
 		break;
 	case 'g': /* gauss */
 		/* Should be a smooth waveform so don't expect break-points */
 		break;
 	case 's': /* sin */
 		if(time < *r->d.sin.td) {
-			*nextStep = *r->d.sin.td;
+			*nextBreak = *r->d.sin.td;
 		}
 		break;
 	case 'e': /* exp */
 		if(time < *r->d.exp.td1) {
-			*nextStep = *r->d.exp.td1 - time;
+			*nextBreak = *r->d.exp.td1;
 		} else if(time < *r->d.exp.td2) {
-			*nextStep = *r->d.exp.td2 - time;
+			*nextBreak = *r->d.exp.td2;
 		}
 		break;
 	case 'l': /* pwl */
 	case 'c': /* pwc */
 		ReturnErrIf(piecewiseGetNextX(r->d.pw.pw, &r->d.pw.index, time, &tp));
-		if(tp != HUGE_VAL) {
-			*nextStep = tp - time;
+		if(tp > time) {
+			*nextBreak = tp;
 		}
 		break;
 	default:
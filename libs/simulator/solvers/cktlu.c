@@ -0,0 +1,272 @@
+/*
+ * Copyright (C) 2006 Cooper Street Innovations Inc.
+ *	Charles Eidsness    <charles@cooper-street.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ */
+
+#include <math.h>
+#include <log.h>
+#include <cktlu.h>
+
+#include "matrix_internal.h"
+
+/*===========================================================================
+ |                            Private Structure                              |
+  ===========================================================================*/
+
+#define CKTLU_THREADS_MIN	2000
+#define CKTLU_REFINE_MAX	10
+
+struct _matrixLibrary {
+	cktlu_ *lu;
+	double pivrel;
+	/* Mixed Precision */
+	int single;
+	double refineTol; /* relative size of the last correction */
+	double *A; /* A as it was factored */
+	double *R;
+};
+
+/*===========================================================================
+ |                             Class Functions                               |
+  ===========================================================================*/
+
+static int matrixFactorCktLU(matrix_ *r)
+{
+	matrixLibrary_ *p;
+
+	ReturnErrIf(r == NULL);
+	p = r->library;
+	ReturnErrIf(p == NULL);
+
+	ReturnErrIf(cktluFactor(p->lu, r->A, p->pivrel));
+	if(p->single) {
+		memcpy(p->A, r->A, r->lenA*sizeof(double));
+	}
+
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static int matrixRefactorCktLU(matrix_ *r)
+{
+	matrixLibrary_ *p;
+	int unstable;
+
+	ReturnErrIf(r == NULL);
+	p = r->library;
+	ReturnErrIf(p == NULL);
+
+	unstable = cktluRefactor(p->lu, r->A, p->pivrel);
+	if(p->single && !unstable) {
+		memcpy(p->A, r->A, r->lenA*sizeof(double));
+	}
+
+	return unstable;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Iterative refinement against the A that was factored, X = X + inv(LU)*R
+ * with R = B - A*X in double precision. Returns 1 if it stalls.
+ */
+static int matrixRefineCktLU(matrix_ *r)
+{
+	matrixLibrary_ *p = r->library;
+	double delta, last = HUGE_VAL, max;
+	int n, i, j;
+
+	for(n = 0; n < CKTLU_REFINE_MAX; n++) {
+		memcpy(p->R, r->B, r->lenXB*sizeof(double));
+		for(j = 0; j < r->lenXB; j++) {
+			for(i = r->aColStart[j]; i < r->aColStart[j+1]; i++) {
+				p->R[r->aRow[i]] -= p->A[i]*r->X[j];
+			}
+		}
+		ReturnErrIf(cktluSolve(p->lu, p->R));
+
+		delta = 0.0;
+		max = 0.0;
+		for(i = 0; i < r->lenXB; i++) {
+			r->X[i] += p->R[i];
+			delta = (fabs(p->R[i]) > delta) ? fabs(p->R[i]) : delta;
+			max = (fabs(r->X[i]) > max) ? fabs(r->X[i]) : max;
+		}
+
+		if(delta <= p->refineTol*max) {
+			return 0;
+		} else if(delta > 0.5*last) {
+			Debug("Refinement stalled, %e -> %e", last, delta);
+			return 1;
+		}
+		last = delta;
+	}
+
+	return 1;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static int matrixSolveCktLU(matrix_ *r)
+{
+	matrixLibrary_ *p;
+	int stalled;
+
+	ReturnErrIf(r == NULL);
+	p = r->library;
+	ReturnErrIf(p == NULL);
+
+	memcpy(r->X, r->B, r->lenXB*sizeof(double));
+	ReturnErrIf(cktluSolve(p->lu, r->X));
+
+	if(p->single) {
+		stalled = matrixRefineCktLU(r);
+		ReturnErrIf(stalled < 0);
+		if(stalled) {
+			/* Single precision isn't good enough for this circuit, go back
+			 * to double for good, the matrix factors A again.
+			 */
+			Debug("Mixed precision refinement stalled, using double precision");
+			p->single = 0;
+			ReturnErrIf(cktluSetSingle(p->lu, 0));
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static int matrixUnconfigCktLU(matrix_ *r)
+{
+	matrixLibrary_ *p;
+
+	ReturnErrIf(r == NULL);
+	p = r->library;
+	ReturnErrIf(p == NULL);
+
+	Debug("Unconfiguring Solution %p", r);
+
+	if(p->lu != NULL) {
+		ReturnErrIf(cktluDestroy(&p->lu));
+	}
+	if(p->A != NULL)
+		free(p->A);
+	if(p->R != NULL)
+		free(p->R);
+
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Builds the solver from the ordering in the symbolic table, or finds the
+ * ordering and adds it to the table, which has to be locked.
+ */
+static int matrixOrderCktLU(matrix_ *r)
+{
+	matrixLibrary_ *p = r->library;
+	matrixSymbolic_ *s;
+
+	s = matrixSymbolicFind(r);
+	if((s != NULL) && (s->cktluBlocks > 0)) {
+		p->lu = cktluNewOrdered(p->lu, r->lenXB, r->aColStart, r->aRow,
+				s->cktluBlocks, s->cktluPs, s->cktluQ, s->cktluR);
+		ReturnErrIf(p->lu == NULL);
+		return 0;
+	}
+
+	p->lu = cktluNew(p->lu, r->lenXB, r->aColStart, r->aRow);
+	ReturnErrIf(p->lu == NULL);
+	s = matrixSymbolicAdd(r);
+	ReturnErrIf(s == NULL);
+	s->cktluPs = malloc((r->lenXB + 1) * sizeof(int));
+	ReturnErrIf(s->cktluPs == NULL);
+	s->cktluQ = malloc((r->lenXB + 1) * sizeof(int));
+	ReturnErrIf(s->cktluQ == NULL);
+	s->cktluR = malloc((r->lenXB + 1) * sizeof(int));
+	ReturnErrIf(s->cktluR == NULL);
+	s->cktluBlocks = cktluGetOrder(p->lu, s->cktluPs, s->cktluQ, s->cktluR);
+	ReturnErrIf(s->cktluBlocks < 0);
+
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static int matrixConfigCktLU(matrix_ *r, control_ *control)
+{
+	matrixLibrary_ *p;
+	int error;
+
+	ReturnErrIf(r == NULL);
+	ReturnErrIf(r->library != NULL);
+
+	Debug("Configuring Solution %p", r);
+
+	r->library = calloc(1, sizeof(matrixLibrary_));
+	ReturnErrIf(r->library == NULL);
+
+	p = r->library;
+
+	/* The ordering only depends on the pattern so it's done up front, or
+	 * taken from the symbolic cache if this pattern has been seen before
+	 */
+	ReturnErrIf(matrixSymbolicLock());
+	error = matrixOrderCktLU(r);
+	ReturnErrIf(matrixSymbolicUnlock());
+	ReturnErrIf(error);
+	p->pivrel = control->pivrel;
+
+	/* Threads only pay off once there are enough independent columns */
+	if((control->luThreads > 1) && (r->lenXB >= CKTLU_THREADS_MIN)) {
+		ReturnErrIf(cktluSetThreads(p->lu, control->luThreads));
+	}
+
+	/* Single precision factors need a copy of A and a residual to refine
+	 * the solution back to double precision.
+	 */
+	if(control->luSingle) {
+		p->single = 1;
+		p->refineTol = control->reltol*1e-6;
+		ReturnErrIf(cktluSetSingle(p->lu, 1));
+		p->A = calloc(r->lenA + 1, sizeof(double));
+		ReturnErrIf(p->A == NULL);
+		p->R = calloc(r->lenXB + 1, sizeof(double));
+		ReturnErrIf(p->R == NULL);
+	}
+
+	return 0;
+}
+
+/*===========================================================================
+ |                                  Class                                    |
+  ===========================================================================*/
+
+matrixLibraryClass_ matrixCktLU = {
+	.name = "CktLU",
+	.config = matrixConfigCktLU,
+	.unconfig = matrixUnconfigCktLU,
+	.factor = matrixFactorCktLU,
+	.refactor = matrixRefactorCktLU,
+	.solve = matrixSolveCktLU,
+};
+
+/*===========================================================================*/
@@ -0,0 +1,142 @@
+/*
+ * Copyright (C) 2006 Cooper Street Innovations Inc.
+ *	Charles Eidsness    <charles@cooper-street.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ */
+
+#include <log.h>
+
+#include "matrix_internal.h"
+#include "netlib.h"
+
+/*===========================================================================
+ |                            Private Structure                              |
+  ===========================================================================*/
+
+struct _matrixLibrary {
+	double *LU;		/* Column major n x n copy of A, and then its factors */
+	int *ipiv;
+};
+
+/*===========================================================================
+ |                             Class Functions                               |
+  ===========================================================================*/
+
+static int matrixFactorDense(matrix_ *r)
+{
+	matrixLibrary_ *p;
+	int n, col, i;
+
+	ReturnErrIf(r == NULL);
+	p = r->library;
+	ReturnErrIf(p == NULL);
+
+	n = r->lenXB;
+
+	/* Expand the compressed column A into the dense matrix */
+	memset(p->LU, 0x0, n*n*sizeof(double));
+	for(col = 0; col < n; col++) {
+		for(i = r->aColStart[col]; i < r->aColStart[col+1]; i++) {
+			p->LU[col*n + r->aRow[i]] = r->A[i];
+		}
+	}
+
+	ReturnErrIf(netlibDGETRF(n, n, p->LU, n, p->ipiv),
+			"Dense: U is singular");
+
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static int matrixSolveDense(matrix_ *r)
+{
+	matrixLibrary_ *p;
+
+	ReturnErrIf(r == NULL);
+	p = r->library;
+	ReturnErrIf(p == NULL);
+
+	memcpy(r->X, r->B, r->lenXB*sizeof(double));
+	ReturnErrIf(netlibDGETRS('N', r->lenXB, 1, p->LU, r->lenXB, p->ipiv,
+			r->X, r->lenXB));
+
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static int matrixUnconfigDense(matrix_ *r)
+{
+	matrixLibrary_ *p;
+
+	ReturnErrIf(r == NULL);
+	p = r->library;
+	ReturnErrIf(p == NULL);
+
+	Debug("Unconfiguring Solution %p", r);
+
+	if(p->LU != NULL)
+		free(p->LU);
+	if(p->ipiv != NULL)
+		free(p->ipiv);
+
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static int matrixConfigDense(matrix_ *r, control_ *control)
+{
+	matrixLibrary_ *p;
+
+	ReturnErrIf(r == NULL);
+	ReturnErrIf(r->library != NULL);
+
+	Debug("Configuring Solution %p", r);
+
+	r->library = calloc(1, sizeof(matrixLibrary_));
+	ReturnErrIf(r->library == NULL);
+
+	p = r->library;
+
+	p->LU = malloc(r->lenXB * r->lenXB * sizeof(double));
+	ReturnErrIf(p->LU == NULL);
+	p->ipiv = malloc(r->lenXB * sizeof(int));
+	ReturnErrIf(p->ipiv == NULL);
+
+	return 0;
+}
+
+/*===========================================================================
+ |                                  Class                                    |
+  ===========================================================================*/
+
+/* There's no symbolic analysis to reuse, so no refactor function, a
+ * full factorization is just as fast.
+ */
+matrixLibraryClass_ matrixDense = {
+	.name = "Dense",
+	.config = matrixConfigDense,
+	.unconfig = matrixUnconfigDense,
+	.factor = matrixFactorDense,
+	.refactor = NULL,
+	.solve = matrixSolveDense,
+};
+
+/*===========================================================================*/
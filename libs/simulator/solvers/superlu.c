@@ -0,0 +1,555 @@
+/*
+ * Copyright (C) 2006 Cooper Street Innovations Inc.
+ *	Charles Eidsness    <charles@cooper-street.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ */
+
+#include <math.h>
+#include <log.h>
+#include <superlu.h>
+
+#include "matrix_internal.h"
+
+#define MaxAbs(x,y) ((fabs(x) > fabs(y)) ? fabs(x) : fabs(y))
+
+/*===========================================================================
+ |                            Private Structure                              |
+  ===========================================================================*/
+
+/* One entry of U in the order used by the numeric refactorization */
+typedef struct {
+	int row;
+	double *value;
+} matrixRefactorEntry_;
+
+struct _matrixLibrary {
+	SuperMatrix A;
+	SuperMatrix B;
+	SuperMatrix X;
+	SuperMatrix L;
+	SuperMatrix U;
+	int *perm_r;
+    int *perm_c;
+	int *etree;
+	char equed;
+	int info;
+	double *R;
+	double *C;
+	double rpg;
+	double rcond;
+	double *ferr;
+	double *berr;
+	mem_usage_t mem_usage;
+	superlu_options_t control;
+    SuperLUStat_t stat;
+	int firstPass;
+	int ordering; /* control ordering, kept with perm_c in the symbolic cache */
+	int select; /* pick the column ordering on the first factor */
+	int store; /* save perm_c in the symbolic cache after the first factor */
+	/* Numeric Refactorization */
+	double pivrel;
+	int *iperm_c;
+	int *uStart;
+	matrixRefactorEntry_ *u;
+	double *work;
+};
+
+/*===========================================================================
+ |                             Class Functions                               |
+  ===========================================================================*/
+
+/* Automatic column ordering. Each candidate ordering is tried with a full
+ * factorization of the first A and the one with the least fill in L and
+ * U, then the fewest flops, is kept. The first A of a run is only a
+ * guess at the values that follow, but MNA pivots mostly follow the
+ * structure so the fill is a good predictor for the rest of the run.
+ * The resulting perm_c goes to the symbolic cache with every other
+ * ordering so another run of the same circuit goes straight to it.
+ */
+static int matrixOrderingSuperLU(matrix_ *r)
+{
+	static const colperm_t candidates[] = {COLAMD, MMD_AT_PLUS_A, MMD_ATA,
+			NATURAL};
+	matrixLibrary_ *p;
+	colperm_t best;
+	double fill, bestFill, flops, bestFlops;
+	int i;
+
+	ReturnErrIf(r == NULL);
+	p = r->library;
+	ReturnErrIf(p == NULL);
+
+	best = COLAMD;
+	bestFill = -1.0;
+	bestFlops = 0.0;
+	for(i = 0; i < (int)(sizeof(candidates)/sizeof(colperm_t)); i++) {
+		p->control.Fact = DOFACT;
+		p->control.ColPerm = candidates[i];
+		p->stat.ops[FACT] = 0.0;
+
+		dgssvx(&p->control, &p->A, p->perm_c, p->perm_r, p->etree,
+				&p->equed, p->R, p->C, &p->L, &p->U, NULL, 0, &p->B, &p->X,
+				&p->rpg, &p->rcond, p->ferr, p->berr, &p->mem_usage,
+				&p->stat, &p->info);
+
+		ReturnErrIf(p->info < 0, "SuperLU: %ith arg had illegal value",
+				-p->info);
+		if(p->info > p->A.ncol) {
+			/* Out of memory, L and U have already been released */
+			continue;
+		}
+
+		fill = ((SCformat*)p->L.Store)->nnz + ((NCformat*)p->U.Store)->nnz;
+		flops = p->stat.ops[FACT];
+		Destroy_SuperNode_Matrix(&p->L);
+		Destroy_CompCol_Matrix(&p->U);
+
+		Debug("Column ordering %i, fill %g, flops %g", candidates[i],
+				fill, flops);
+
+		if(p->info != 0) {
+			continue;
+		}
+		if((bestFill < 0.0) || (fill < bestFill) ||
+				((fill == bestFill) && (flops < bestFlops))) {
+			best = candidates[i];
+			bestFill = fill;
+			bestFlops = flops;
+		}
+	}
+
+	Debug("Picked column ordering %i", best);
+	p->control.ColPerm = best;
+	p->stat.ops[FACT] = 0.0;
+
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static int matrixRefactorCompare(const void *a, const void *b)
+{
+	return ((matrixRefactorEntry_*)a)->row - ((matrixRefactorEntry_*)b)->row;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Builds the per column list of U entries, sorted by row, that the numeric
+ * refactorization uses to apply the left-looking updates in a valid order.
+ * The list points directly into SuperLU's L and U storage so it has to be
+ * rebuilt every time SuperLU does a full factorization.
+ */
+static int matrixRefactorSetupSuperLU(matrix_ *r)
+{
+	matrixLibrary_ *p;
+	SCformat *Lstore;
+	NCformat *Ustore;
+	double *Lval;
+	int n, i, j, k, fsupc, length;
+
+	ReturnErrIf(r == NULL);
+	p = r->library;
+	ReturnErrIf(p == NULL);
+
+	Lstore = p->L.Store;
+	Ustore = p->U.Store;
+	Lval = Lstore->nzval;
+	n = r->lenXB;
+
+	/* Entries of U come from U itself plus the upper part of the supernode */
+	length = 0;
+	for(j = 0; j < n; j++) {
+		length += U_NZ_START(j+1) - U_NZ_START(j);
+		length += j - L_FST_SUPC(Lstore->col_to_sup[j]);
+	}
+
+	if(p->u != NULL) {
+		free(p->u);
+	}
+	p->u = malloc((length + 1) * sizeof(matrixRefactorEntry_));
+	ReturnErrIf(p->u == NULL);
+
+	length = 0;
+	for(j = 0; j < n; j++) {
+		p->uStart[j] = length;
+		for(i = U_NZ_START(j); i < U_NZ_START(j+1); i++) {
+			p->u[length].row = U_SUB(i);
+			p->u[length].value = &((double*)Ustore->nzval)[i];
+			length++;
+		}
+		qsort(&p->u[p->uStart[j]], length - p->uStart[j],
+				sizeof(matrixRefactorEntry_), matrixRefactorCompare);
+
+		/* Rows in this supernode always come after rows in U */
+		fsupc = L_FST_SUPC(Lstore->col_to_sup[j]);
+		for(k = fsupc; k < j; k++) {
+			p->u[length].row = k;
+			p->u[length].value = &Lval[L_NZ_START(j) + (k - fsupc)];
+			length++;
+		}
+	}
+	p->uStart[n] = length;
+
+	for(j = 0; j < n; j++) {
+		p->iperm_c[p->perm_c[j]] = j;
+	}
+
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Numeric only refactorization, similar to KLU's klu_refactor. The
+ * permutations, supernode partition and L/U storage from the last full
+ * factorization are kept and only the values are recomputed, column by
+ * column, using a left-looking algorithm. Returns non-zero if a pivot
+ * fails the pivrel test, a full factorization is required in that case.
+ */
+static int matrixRefactorSuperLU(matrix_ *r)
+{
+	matrixLibrary_ *p;
+	SCformat *Lstore;
+	double *Lval, *Ljval, *Lkval, *x;
+	double ukj, pivot, max;
+	int *Lsub;
+	int n, i, j, k, e, q, fsupc, kfsupc, istart, kstart, nsupr, knsupr;
+
+	p = r->library;
+	Lstore = p->L.Store;
+	Lval = Lstore->nzval;
+	Lsub = Lstore->rowind;
+	x = p->work;
+	n = r->lenXB;
+
+	for(j = 0; j < n; j++) {
+		fsupc = L_FST_SUPC(Lstore->col_to_sup[j]);
+		istart = L_SUB_START(fsupc);
+		nsupr = L_SUB_START(fsupc+1) - istart;
+		Ljval = &Lval[L_NZ_START(j)];
+
+		/* Scatter the permuted column of A */
+		k = p->iperm_c[j];
+		for(i = r->aColStart[k]; i < r->aColStart[k+1]; i++) {
+			x[p->perm_r[r->aRow[i]]] += r->A[i];
+		}
+
+		/* Apply the updates from the columns of L to the left */
+		for(e = p->uStart[j]; e < p->uStart[j+1]; e++) {
+			k = p->u[e].row;
+			ukj = x[k];
+			x[k] = 0.0;
+			*p->u[e].value = ukj;
+			if(ukj == 0.0) {
+				continue;
+			}
+			kfsupc = L_FST_SUPC(Lstore->col_to_sup[k]);
+			kstart = L_SUB_START(kfsupc);
+			knsupr = L_SUB_START(kfsupc+1) - kstart;
+			Lkval = &Lval[L_NZ_START(k)];
+			for(q = k - kfsupc + 1; q < knsupr; q++) {
+				x[Lsub[kstart + q]] -= Lkval[q] * ukj;
+			}
+		}
+
+		/* Check the pivot against the rest of the column */
+		pivot = x[j];
+		max = fabs(pivot);
+		for(q = j - fsupc + 1; q < nsupr; q++) {
+			max = MaxAbs(max, x[Lsub[istart + q]]);
+		}
+		if((pivot == 0.0) || !(fabs(pivot) >= p->pivrel*max)) {
+			for(q = j - fsupc; q < nsupr; q++) {
+				x[Lsub[istart + q]] = 0.0;
+			}
+			Debug("Refactor pivot %i failed (%e, %e)", j, pivot, max);
+			return j + 1;
+		}
+
+		/* Gather the column of L */
+		Ljval[j - fsupc] = pivot;
+		x[j] = 0.0;
+		for(q = j - fsupc + 1; q < nsupr; q++) {
+			i = Lsub[istart + q];
+			Ljval[q] = x[i] / pivot;
+			x[i] = 0.0;
+		}
+	}
+
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Keeps the column ordering for other matrices with the same pattern, the
+ * symbolic table has to be locked.
+ */
+static int matrixStoreOrderingSuperLU(matrix_ *r)
+{
+	matrixLibrary_ *p = r->library;
+	matrixSymbolic_ *s;
+
+	s = matrixSymbolicAdd(r);
+	ReturnErrIf(s == NULL);
+	if(s->superluPermC == NULL) {
+		s->superluPermC = malloc(r->lenXB * sizeof(int));
+		ReturnErrIf(s->superluPermC == NULL);
+	}
+	memcpy(s->superluPermC, p->perm_c, r->lenXB * sizeof(int));
+	s->superluOrdering = p->ordering;
+
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static int matrixFactorSuperLU(matrix_ *r)
+{
+	matrixLibrary_ *p;
+	int error;
+
+	ReturnErrIf(r == NULL);
+	p = r->library;
+	ReturnErrIf(p == NULL);
+
+	if(p->select) {
+		ReturnErrIf(matrixOrderingSuperLU(r));
+		p->select = 0;
+	}
+
+	p->control.Fact = DOFACT;
+
+	if(p->firstPass) {
+		p->firstPass = 0;
+	} else {
+		/* Free the LU Matrices so we can use them */
+		Destroy_SuperNode_Matrix(&p->L);
+		Destroy_CompCol_Matrix(&p->U);
+	}
+
+	/* Check out the SuperLU Header files and the SuperLU User's manual
+	 * to make sense of this mess...
+	 */
+	dgssvx(&p->control, &p->A, p->perm_c, p->perm_r, p->etree, &p->equed,
+			p->R, p->C, &p->L, &p->U, NULL, 0, &p->B, &p->X, &p->rpg,
+			&p->rcond, p->ferr, p->berr, &p->mem_usage, &p->stat, &p->info);
+
+	ReturnErrIf(p->info < 0, "SuperLU: %ith arg had illegal value", -p->info);
+	if(p->info > 0) {
+		ReturnErrIf((p->info <= p->A.ncol), "SuperLU: U is singular");
+		ReturnErrIf((p->info == (p->A.ncol + 1)),
+				"SuperLU: RCOND is singular to working precision");
+		ReturnErrIf((p->info > (p->A.ncol + 1)),
+				"SuperLU: memory allocation error");
+	}
+
+	ReturnErrIf(matrixRefactorSetupSuperLU(r));
+
+	/* The column ordering only depends on the pattern, keep it for the
+	 * next full factorization and for other matrices with the same pattern
+	 */
+	p->control.ColPerm = MY_PERMC;
+	if(p->store) {
+		ReturnErrIf(matrixSymbolicLock());
+		error = matrixStoreOrderingSuperLU(r);
+		ReturnErrIf(matrixSymbolicUnlock());
+		ReturnErrIf(error);
+		p->store = 0;
+	}
+
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static int matrixSolveSuperLU(matrix_ *r)
+{
+	matrixLibrary_ *p;
+
+	ReturnErrIf(r == NULL);
+	p = r->library;
+	ReturnErrIf(p == NULL);
+
+	memcpy(r->X, r->B, r->lenXB*sizeof(double));
+	dgstrs(NOTRANS, &p->L, &p->U, p->perm_c, p->perm_r, &p->X, &p->stat,
+			&p->info);
+	ReturnErrIf(p->info != 0, "SuperLU: %ith arg had illegal value", -p->info);
+
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static int matrixUnconfigSuperLU(matrix_ *r)
+{
+	matrixLibrary_ *p;
+
+	ReturnErrIf(r == NULL);
+	p = r->library;
+	ReturnErrIf(p == NULL);
+
+	Debug("Unconfiguring Solution %p", r);
+
+	SUPERLU_FREE(p->perm_r);
+	SUPERLU_FREE(p->perm_c);
+	SUPERLU_FREE(p->etree);
+	SUPERLU_FREE(p->R);
+    SUPERLU_FREE(p->C);
+	SUPERLU_FREE(p->ferr);
+    SUPERLU_FREE(p->berr);
+	if(p->iperm_c != NULL)
+		free(p->iperm_c);
+	if(p->uStart != NULL)
+		free(p->uStart);
+	if(p->u != NULL)
+		free(p->u);
+	if(p->work != NULL)
+		free(p->work);
+	/* A, X and B belong to the matrix object, they can be shared by more
+	 * than one copy of the library.
+	 */
+	Destroy_SuperMatrix_Store(&p->A);
+	Destroy_SuperMatrix_Store(&p->B);
+	Destroy_SuperMatrix_Store(&p->X);
+	StatFree(&p->stat);
+	if(!p->firstPass) {
+		Destroy_SuperNode_Matrix(&p->L);
+		Destroy_CompCol_Matrix(&p->U);
+	}
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static int matrixConfigSuperLU(matrix_ *r, control_ *control)
+{
+	matrixLibrary_ *p;
+	matrixSymbolic_ *s;
+
+	ReturnErrIf(r == NULL);
+	ReturnErrIf(r->library != NULL);
+
+	Debug("Configuring Solution %p", r);
+
+	r->library = calloc(1, sizeof(matrixLibrary_));
+	ReturnErrIf(r->library == NULL);
+
+	p = r->library;
+
+	/* Create solution A in the format expected by SuperLU. */
+	dCreate_CompCol_Matrix(&p->A, r->lenXB, r->lenXB, r->lenA, r->A,
+			r->aRow, r->aColStart, SLU_NC, SLU_D, SLU_GE);
+
+	/* Create right-hand solution matrix X. */
+	dCreate_Dense_Matrix(&p->B, r->lenXB, 1, r->B, r->lenXB,
+			SLU_DN, SLU_D, SLU_GE);
+
+	dCreate_Dense_Matrix(&p->X, r->lenXB, 1, r->X, r->lenXB,
+			SLU_DN, SLU_D, SLU_GE);
+
+	/* Create permitation matrices. */
+	p->perm_r = intMalloc(r->lenXB);
+	ReturnErrIf(p->perm_r == NULL);
+	p->perm_c = intMalloc(r->lenXB);
+	ReturnErrIf(p->perm_r == NULL);
+	p->etree = intMalloc(r->lenXB);
+	ReturnErrIf(p->etree == NULL);
+	p->R = (double *) SUPERLU_MALLOC(p->A.nrow * sizeof(double));
+	ReturnErrIf(p->R == NULL);
+	p->C = (double *) SUPERLU_MALLOC(p->A.ncol * sizeof(double));
+	ReturnErrIf(p->C == NULL);
+	p->ferr = (double *) SUPERLU_MALLOC(1 * sizeof(double));
+	ReturnErrIf(p->ferr == NULL);
+	p->berr = (double *) SUPERLU_MALLOC(1 * sizeof(double));
+	ReturnErrIf(p->berr == NULL);
+
+	/* Refactorization workspace, the U entry list is built after the
+	 * first full factorization.
+	 */
+	p->iperm_c = malloc(r->lenXB * sizeof(int));
+	ReturnErrIf(p->iperm_c == NULL);
+	p->uStart = malloc((r->lenXB + 1) * sizeof(int));
+	ReturnErrIf(p->uStart == NULL);
+	p->work = calloc(r->lenXB, sizeof(double));
+	ReturnErrIf(p->work == NULL);
+	p->pivrel = control->pivrel;
+
+	/* Set the default input control. */
+	p->control.Fact = DOFACT;
+	p->control.Equil = NO;
+	switch(control->luOrdering) {
+	case CONTROL_ORDER_MMD_ATA:
+		p->control.ColPerm = MMD_ATA;
+		break;
+	case CONTROL_ORDER_MMD_ATPLUSA:
+		p->control.ColPerm = MMD_AT_PLUS_A;
+		break;
+	case CONTROL_ORDER_NATURAL:
+		p->control.ColPerm = NATURAL;
+		break;
+	case CONTROL_ORDER_AUTO:
+		p->control.ColPerm = COLAMD;
+		p->select = 1;
+		break;
+	default:
+		p->control.ColPerm = COLAMD;
+	}
+
+	/* Skip the ordering if this pattern has been factored before */
+	p->ordering = control->luOrdering;
+	ReturnErrIf(matrixSymbolicLock());
+	s = matrixSymbolicFind(r);
+	if((s != NULL) && (s->superluPermC != NULL) &&
+			(s->superluOrdering == p->ordering)) {
+		memcpy(p->perm_c, s->superluPermC, r->lenXB * sizeof(int));
+		p->control.ColPerm = MY_PERMC;
+		p->select = 0;
+	} else {
+		p->store = 1;
+	}
+	ReturnErrIf(matrixSymbolicUnlock());
+	p->control.Trans = NOTRANS;
+	p->control.IterRefine = NOREFINE;
+	p->control.PrintStat = NO;
+	p->control.SymmetricMode = NO;
+	p->control.DiagPivotThresh = 1.0;
+	p->control.PivotGrowth = NO;
+	p->control.ConditionNumber = NO;
+
+	/* Initialize the statistics variables. */
+    StatInit(&p->stat);
+
+	/* Ready for first pass (used to know when to free the LU Matrices) */
+	p->firstPass = -1;
+
+	return 0;
+}
+
+/*===========================================================================
+ |                                  Class                                    |
+  ===========================================================================*/
+
+matrixLibraryClass_ matrixSuperLU = {
+	.name = "SuperLU",
+	.config = matrixConfigSuperLU,
+	.unconfig = matrixUnconfigSuperLU,
+	.factor = matrixFactorSuperLU,
+	.refactor = matrixRefactorSuperLU,
+	.solve = matrixSolveSuperLU,
+};
+
+/*===========================================================================*/
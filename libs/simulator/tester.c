@@ -20,6 +20,8 @@
  */
 
 #include <unistd.h>
+#include <string.h>
+#include <math.h>
 #define _GNU_SOURCE
 #include <getopt.h>
 #define ML 4
@@ -87,6 +89,430 @@ void plot(FILE *outFile, double *data, char **variables, int numPoints,
 
 }
 
+/* A pulse driving a diode through a t-line, run with each set of options
+ * and compared against the default run. The options change the time-steps
+ * so the edges are allowed to move by up to one sample (tstep).
+ */
+
+typedef struct {
+	char *name[2];
+	double value[2];
+} options_;
+
+static options_ optionsList[] = {
+	{{"method", NULL}, {1, 0}},
+	{{"method", "maxorder"}, {1, 4}},
+	{{"chord", NULL}, {1, 0}},
+	{{"woodburyrank", NULL}, {4, 0}},
+	{{"lucache", "stepladder"}, {16, 2}},
+	{{"lulibrary", "lusingle"}, {2, 1}},
+	{{"lulibrary", "luthreads"}, {2, 4}},
+	{{"lulibrary", "luordering"}, {0, 4}},
+	{{"bypass", NULL}, {1, 0}},
+	{{"predictor", NULL}, {1, 0}},
+	{{NULL, NULL}, {0, 0}},
+};
+
+#define OPTIONS_SAMPLES		601		/* tstep apart */
+#define OPTIONS_TOLERANCE	2e-3	/* of the largest value */
+#define OPTIONS_GROWTH		1.25	/* most time-points relative to the default */
+
+int optionsRun(options_ *options, double *samples, int *numPoints,
+		int *numSolves)
+{
+	simulator_ *simulator = NULL;
+	double R = 10, Z0 = 50, Td = 3e-9, loss = 0.0, C = 1e-12, t;
+	double pulseD[7] = { 0, 5, 2e-9, 1e-9, 1e-9, 8e-9, 20e-9 };
+	double *pulse[7] = { &pulseD[0], &pulseD[1], &pulseD[2], &pulseD[3],
+			&pulseD[4], &pulseD[5], &pulseD[6] };
+	double *data;
+	char **variables;
+	int numVariables, i, j, k, factors, refactors, substitutions;
+
+	simulator = simulatorNew(simulator);
+	ReturnErrIf(simulator == NULL);
+
+	ReturnErrIf(simulatorAddSource(simulator, "V1", "n1", "0",'v',
+			NULL, 'p', pulse));
+	ReturnErrIf(simulatorAddResistor(simulator, "R1", "n1", "n2", &R));
+	ReturnErrIf(simulatorAddTLine(simulator, "T1", "n2", "0", "n3", "0",
+			&Z0, &Td, &loss));
+	ReturnErrIf(simulatorAddCapacitor(simulator, "C1", "n3", "0", &C));
+	ReturnErrIf(simulatorAddNonlinearSource(simulator, "D1", "n3", "0", 'i',
+			"1e-14*(exp(v(n3)/0.0259)-1)"));
+
+	for(i = 0; (options != NULL) && (i < 2); i++) {
+		if(options->name[i] != NULL) {
+			ReturnErrIf(simulatorSetOption(simulator, options->name[i],
+					options->value[i]));
+		}
+	}
+
+	ReturnErrIf(simulatorSave(simulator, "v(n3)"));
+	ReturnErrIf(simulatorRunTransient(simulator, 0.1e-9, 60e-9, 0.0, 0,
+			&data, &variables, numPoints, &numVariables));
+	ReturnErrIf(numVariables != 2);
+	ReturnErrIf(simulatorGetStats(simulator, &factors, &refactors,
+			&substitutions, NULL));
+	*numSolves = factors + refactors + substitutions;
+
+	/* Linear interpolation onto evenly spaced samples */
+	for(i = 0, j = 0; i < OPTIONS_SAMPLES; i++) {
+		t = 60e-9 * i / (OPTIONS_SAMPLES - 1);
+		while((j < *numPoints - 2) && (data[2*(j + 1)] <= t)) {
+			j++;
+		}
+		k = 2*j;
+		samples[i] = data[k + 1] + (data[k + 3] - data[k + 1]) *
+				(t - data[k]) / (data[k + 2] - data[k]);
+	}
+
+	if(simulatorDestroy(&simulator)) {
+		Warn("Failed to close simulator");
+	}
+	free(data);
+	free(variables);
+
+	return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+int optionsCompare()
+{
+	double base[OPTIONS_SAMPLES], samples[OPTIONS_SAMPLES];
+	double scale = 0.0, error, lo, hi, e;
+	int numPoints, basePoints, numSolves, i, j, k, bad, failed = 0;
+
+	ReturnErrIf(optionsRun(NULL, base, &basePoints, &numSolves));
+	for(i = 0; i < OPTIONS_SAMPLES; i++) {
+		scale = (fabs(base[i]) > scale) ? fabs(base[i]) : scale;
+	}
+	Info("default: %i points, %i solves", basePoints, numSolves);
+
+	for(j = 0; optionsList[j].name[0] != NULL; j++) {
+		ReturnErrIf(optionsRun(&optionsList[j], samples, &numPoints,
+				&numSolves));
+		error = 0.0;
+		for(i = 0; i < OPTIONS_SAMPLES; i++) {
+			lo = hi = samples[i];
+			for(k = i - 1; k <= i + 1; k++) {
+				if((k >= 0) && (k < OPTIONS_SAMPLES)) {
+					lo = (samples[k] < lo) ? samples[k] : lo;
+					hi = (samples[k] > hi) ? samples[k] : hi;
+				}
+			}
+			e = (base[i] < lo) ? (lo - base[i]) : (base[i] - hi);
+			error = (e > error) ? e : error;
+		}
+		/* An option can also stall the solver without changing the answer */
+		bad = (error > OPTIONS_TOLERANCE*scale) ||
+				(numPoints > OPTIONS_GROWTH*basePoints);
+		if(optionsList[j].name[1] != NULL) {
+			Info("%s=%g %s=%g: %i points, %i solves, max difference %g%s",
+					optionsList[j].name[0], optionsList[j].value[0],
+					optionsList[j].name[1], optionsList[j].value[1],
+					numPoints, numSolves, error / scale,
+					bad ? " FAILED" : "");
+		} else {
+			Info("%s=%g: %i points, %i solves, max difference %g%s",
+					optionsList[j].name[0], optionsList[j].value[0],
+					numPoints, numSolves, error / scale,
+					bad ? " FAILED" : "");
+		}
+		if(bad) {
+			failed++;
+		}
+	}
+
+	return failed;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static int cacheCompare(const void *a, const void *b)
+{
+	return (*(double*)a > *(double*)b) - (*(double*)a < *(double*)b);
+}
+
+/* A linear RLC ladder with the LU cache and step ladder turned on, A only
+ * depends on the step size and integration order so there should be one
+ * factorization for each pair that was actually used, no matter how many
+ * time-points there are.
+ */
+int cacheFactorizations()
+{
+	simulator_ *simulator = NULL;
+	double R1 = 10, R2 = 50, C = 1e-12, L = 5e-9, *steps;
+	double sineD[5] = { 0, 5, 50e6, 0, 0 };
+	double *sine[7] = { &sineD[0], &sineD[1], &sineD[2], &sineD[3],
+			&sineD[4], NULL, NULL };
+	double *data;
+	char **variables;
+	int numPoints, numVariables, factors, refactors, sizes, i;
+
+	simulator = simulatorNew(simulator);
+	ReturnErrIf(simulator == NULL);
+
+	ReturnErrIf(simulatorAddSource(simulator, "V1", "n1", "0",'v',
+			NULL, 's', sine));
+	ReturnErrIf(simulatorAddResistor(simulator, "R1", "n1", "n2", &R1));
+	ReturnErrIf(simulatorAddCapacitor(simulator, "C1", "n2", "0", &C));
+	ReturnErrIf(simulatorAddInductor(simulator, "L1", "n2", "n3", &L));
+	ReturnErrIf(simulatorAddCapacitor(simulator, "C2", "n3", "0", &C));
+	ReturnErrIf(simulatorAddInductor(simulator, "L2", "n3", "n4", &L));
+	ReturnErrIf(simulatorAddCapacitor(simulator, "C3", "n4", "0", &C));
+	ReturnErrIf(simulatorAddResistor(simulator, "R2", "n4", "0", &R2));
+
+	ReturnErrIf(simulatorSetOption(simulator, "lucache", 64));
+	ReturnErrIf(simulatorSetOption(simulator, "stepladder", 2));
+	ReturnErrIf(simulatorSave(simulator, "v(n4)"));
+	ReturnErrIf(simulatorRunTransient(simulator, 0.1e-9, 200e-9, 0.0, 0,
+			&data, &variables, &numPoints, &numVariables));
+	ReturnErrIf(simulatorGetStats(simulator, &factors, &refactors, NULL,
+			NULL));
+
+	/* Count the different step sizes, tmax/2^k apart from the last one */
+	steps = malloc((numPoints - 1)*sizeof(double));
+	ReturnErrIf(steps == NULL);
+	for(i = 1; i < numPoints; i++) {
+		steps[i - 1] = data[2*i] - data[2*(i - 1)];
+	}
+	qsort(steps, numPoints - 1, sizeof(double), cacheCompare);
+	for(i = 1, sizes = 1; i < numPoints - 1; i++) {
+		if(steps[i] > steps[i - 1]*(1 + 1e-6)) {
+			sizes++;
+		}
+	}
+	free(steps);
+
+	Info("%i points, %i factorizations, %i step sizes, maxorder 2",
+			numPoints, factors + refactors, sizes);
+
+	if(simulatorDestroy(&simulator)) {
+		Warn("Failed to close simulator");
+	}
+	free(data);
+	free(variables);
+
+	return ((factors + refactors) > 2*sizes);
+}
+
+/*---------------------------------------------------------------------------*/
+
+#define LATTICE_TOLERANCE	1e-3	/* Volts, 0.02% of the pulse */
+
+static double latticePulse(double *pulse, double t)
+{
+	if(t < pulse[2]) {
+		return pulse[0];
+	}
+	t = fmod(t - pulse[2], pulse[6]);
+	if(t < pulse[3]) {
+		return pulse[0] + (pulse[1] - pulse[0])*t/pulse[3];
+	} else if(t < pulse[3] + pulse[5]) {
+		return pulse[1];
+	} else if(t < pulse[3] + pulse[5] + pulse[4]) {
+		return pulse[1] + (pulse[0] - pulse[1])*(t - pulse[3] - pulse[5])/
+				pulse[4];
+	}
+	return pulse[0];
+}
+
+/* A pulse into a mismatched lossless t-line, the voltage at the load is
+ * checked against the lattice diagram, i.e. the sum of the reflections
+ * that have arrived so far.
+ */
+int tlineLattice()
+{
+	simulator_ *simulator = NULL;
+	double Rs = 10, Z0 = 50, Td = 3e-9, loss = 0.0, RL = 200;
+	double pulseD[7] = { 0, 5, 2e-9, 1e-9, 1e-9, 4e-9, 15e-9 };
+	double *pulse[7] = { &pulseD[0], &pulseD[1], &pulseD[2], &pulseD[3],
+			&pulseD[4], &pulseD[5], &pulseD[6] };
+	double gammaL = (RL - Z0)/(RL + Z0), gammaS = (Rs - Z0)/(Rs + Z0);
+	double *data, t, v, error = 0.0;
+	char **variables;
+	int numPoints, numVariables, i, k;
+
+	simulator = simulatorNew(simulator);
+	ReturnErrIf(simulator == NULL);
+
+	ReturnErrIf(simulatorAddSource(simulator, "V1", "n1", "0",'v',
+			NULL, 'p', pulse));
+	ReturnErrIf(simulatorAddResistor(simulator, "R1", "n1", "n2", &Rs));
+	ReturnErrIf(simulatorAddTLine(simulator, "T1", "n2", "0", "n3", "0",
+			&Z0, &Td, &loss));
+	ReturnErrIf(simulatorAddResistor(simulator, "R2", "n3", "0", &RL));
+
+	ReturnErrIf(simulatorSave(simulator, "v(n3)"));
+	ReturnErrIf(simulatorRunTransient(simulator, 0.1e-9, 60e-9, 0.0, 0,
+			&data, &variables, &numPoints, &numVariables));
+
+	for(i = 0; i < numPoints; i++) {
+		t = data[2*i];
+		v = 0.0;
+		for(k = 0; (2*k + 1)*Td <= t; k++) {
+			v += (1 + gammaL)*pow(gammaL*gammaS, k)*Z0/(Rs + Z0)*
+					latticePulse(pulseD, t - (2*k + 1)*Td);
+		}
+		error = (fabs(v - data[2*i + 1]) > error) ?
+				fabs(v - data[2*i + 1]) : error;
+	}
+
+	Info("%i points, max error %gV", numPoints, error);
+
+	if(simulatorDestroy(&simulator)) {
+		Warn("Failed to close simulator");
+	}
+	free(data);
+	free(variables);
+
+	return (error > LATTICE_TOLERANCE);
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* An RC driven by a pulse, run to 20ns and continued to 40ns. Each run
+ * hands over only its own points, the second one starts at the first one's
+ * last time and has to end where a single run to 40ns does.
+ */
+int continuedRun()
+{
+	simulator_ *simulator = NULL;
+	double R = 100, C = 10e-12;
+	double pulseD[7] = { 0, 5, 2e-9, 1e-9, 1e-9, 4e-9, 15e-9 };
+	double *pulse[7] = { &pulseD[0], &pulseD[1], &pulseD[2], &pulseD[3],
+			&pulseD[4], &pulseD[5], &pulseD[6] };
+	double *data[3], tstop[3] = { 20e-9, 40e-9, 40e-9 };
+	char **variables[3];
+	int numPoints[3], numVariables[3], k, failed;
+
+	for(k = 0; k < 3; k++) {
+		if(k != 1) {
+			simulator = simulatorNew(simulator);
+			ReturnErrIf(simulator == NULL);
+			ReturnErrIf(simulatorAddSource(simulator, "V1", "n1", "0",'v',
+					NULL, 'p', pulse));
+			ReturnErrIf(simulatorAddResistor(simulator, "R1", "n1", "n2", &R));
+			ReturnErrIf(simulatorAddCapacitor(simulator, "C1", "n2", "0", &C));
+			ReturnErrIf(simulatorSave(simulator, "v(n2)"));
+		}
+		ReturnErrIf(simulatorRunTransient(simulator, 0.1e-9, tstop[k], 0.0,
+				(k != 1), &data[k], &variables[k], &numPoints[k],
+				&numVariables[k]));
+		if(k != 0) {
+			if(simulatorDestroy(&simulator)) {
+				Warn("Failed to close simulator");
+			}
+		}
+	}
+
+	Info("%i points then %i continued, %i in one run", numPoints[0],
+			numPoints[1], numPoints[2]);
+	Info("v(n2) at 40ns: %g continued, %g in one run",
+			data[1][2*numPoints[1] - 1], data[2][2*numPoints[2] - 1]);
+
+	failed = (data[0][2*numPoints[0] - 2] != tstop[0]) ||
+			(data[1][0] != tstop[0]) ||
+			(data[1][1] != data[0][2*numPoints[0] - 1]) ||
+			(data[1][2*numPoints[1] - 2] != tstop[1]) ||
+			(numPoints[1] >= numPoints[2]) ||
+			(fabs(data[1][2*numPoints[1] - 1] -
+			data[2][2*numPoints[2] - 1]) > 1e-3);
+
+	for(k = 0; k < 3; k++) {
+		free(data[k]);
+		free(variables[k]);
+	}
+
+	return failed;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* A bus with one line switching and the rest parked, each line clamped by
+ * a pair of diodes. Run with and without bypass, the parked lines' diodes
+ * have to be skipped and the switching line can't move.
+ */
+
+#define BYPASS_LINES	8
+
+int bypassIdle()
+{
+	simulator_ *simulator = NULL;
+	double R = 50, C = 2e-12, Vdd = 3.3;
+	double pulseD[7] = { 0, 3.3, 2e-9, 1e-9, 1e-9, 8e-9, 20e-9 };
+	double *pulse[7] = { &pulseD[0], &pulseD[1], &pulseD[2], &pulseD[3],
+			&pulseD[4], &pulseD[5], &pulseD[6] };
+	double *data[2], error = 0.0;
+	char **variables[2], name[3][16], equation[64];
+	int numPoints[2], numVariables[2], bypasses[2], i, k;
+
+	for(k = 0; k < 2; k++) {
+		simulator = simulatorNew(simulator);
+		ReturnErrIf(simulator == NULL);
+		ReturnErrIf(simulatorAddSource(simulator, "VDD", "vdd", "0", 'v',
+				&Vdd, 0x0, NULL));
+		for(i = 0; i < BYPASS_LINES; i++) {
+			sprintf(name[0], "V%i", i);
+			sprintf(name[1], "in%i", i);
+			sprintf(name[2], "out%i", i);
+			if(i == 0) {
+				ReturnErrIf(simulatorAddSource(simulator, name[0], name[1],
+						"0", 'v', NULL, 'p', pulse));
+			} else {
+				ReturnErrIf(simulatorAddSource(simulator, name[0], name[1],
+						"0", 'v', &Vdd, 0x0, NULL));
+			}
+			sprintf(name[0], "R%i", i);
+			ReturnErrIf(simulatorAddResistor(simulator, name[0], name[1],
+					name[2], &R));
+			sprintf(name[0], "C%i", i);
+			ReturnErrIf(simulatorAddCapacitor(simulator, name[0], name[2],
+					"0", &C));
+			sprintf(name[0], "DL%i", i);
+			sprintf(equation, "1e-14*(exp(-v(%s)/0.0259)-1)", name[2]);
+			ReturnErrIf(simulatorAddNonlinearSource(simulator, name[0],
+					"0", name[2], 'i', equation));
+			sprintf(name[0], "DH%i", i);
+			sprintf(equation, "1e-14*(exp((v(%s)-v(vdd))/0.0259)-1)", name[2]);
+			ReturnErrIf(simulatorAddNonlinearSource(simulator, name[0],
+					name[2], "vdd", 'i', equation));
+		}
+		ReturnErrIf(simulatorSetOption(simulator, "bypass", k));
+		ReturnErrIf(simulatorSave(simulator, "v(out0)"));
+		ReturnErrIf(simulatorRunTransient(simulator, 0.1e-9, 40e-9, 0.0, 0,
+				&data[k], &variables[k], &numPoints[k], &numVariables[k]));
+		ReturnErrIf(simulatorGetStats(simulator, NULL, NULL, NULL,
+				&bypasses[k]));
+		if(simulatorDestroy(&simulator)) {
+			Warn("Failed to close simulator");
+		}
+	}
+
+	for(i = 0; (i < numPoints[0]) && (i < numPoints[1]); i++) {
+		if(data[0][2*i] != data[1][2*i]) {
+			break;
+		}
+		error = (fabs(data[0][2*i + 1] - data[1][2*i + 1]) > error) ?
+				fabs(data[0][2*i + 1] - data[1][2*i + 1]) : error;
+	}
+
+	Info("%i points, %i bypassed, %i points, %i bypassed with bypass=1",
+			numPoints[0], bypasses[0], numPoints[1], bypasses[1]);
+	Info("v(out0) matches for %i points, max difference %gV", i, error);
+
+	for(k = 0; k < 2; k++) {
+		free(data[k]);
+		free(variables[k]);
+	}
+
+	return (bypasses[0] != 0) || (bypasses[1] <= 0) || (error > 1e-3);
+}
+
+/*---------------------------------------------------------------------------*/
+
 int main(int argc, char *argv[])
 {
 	int opt;
@@ -102,6 +528,11 @@ int main(int argc, char *argv[])
 			{"test2", 1, NULL, '2'},
 			{"test3", 1, NULL, '3'},
 			{"test4", 1, NULL, '4'},
+			{"test5", 1, NULL, '5'},
+			{"test6", 1, NULL, '6'},
+			{"test7", 1, NULL, '7'},
+			{"test8", 1, NULL, '8'},
+			{"test9", 1, NULL, '9'},
 			{0, 0, 0, 0}
     };
 	simulator_ *simulator = NULL;
@@ -119,7 +550,7 @@ int main(int argc, char *argv[])
 			&gaussD[4], &gaussD[5], &gaussD[6] };
 
 	/* Process the command line options */
-	while((opt = getopt_long(argc,argv,"hvae:l:01234o:",longopts,NULL)) != -1) {
+	while((opt = getopt_long(argc,argv,"hvae:l:0123456789o:",longopts,NULL)) != -1) {
 		switch(opt) {
 		case '0':
 			/* Create a new simulator object */
@@ -250,6 +681,28 @@ int main(int argc, char *argv[])
 			free(data);
 			free(variables);
 			break;
+		case '5':
+			/* Compare each of the options against the default run */
+			ExitFailureIf(optionsCompare(), "Options changed the results");
+			break;
+		case '6':
+			/* Count the factorizations of a linear circuit */
+			ExitFailureIf(cacheFactorizations(),
+					"The LU cache missed on a linear circuit");
+			break;
+		case '7':
+			/* Check a t-line against its lattice diagram */
+			ExitFailureIf(tlineLattice(), "The t-line reflections are off");
+			break;
+		case '8':
+			/* Continue a transient from where the last run ended */
+			ExitFailureIf(continuedRun(),
+					"A continued run didn't pick up where the last one ended");
+			break;
+		case '9':
+			/* Skip the diodes on the parked lines of a bus */
+			ExitFailureIf(bypassIdle(), "Bypass never skipped an idle device");
+			break;
 		case 'a':
 		case 'v': version(); ExitSuccess;
 		case 'o':
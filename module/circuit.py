@@ -38,6 +38,13 @@ Voltage = 'v'
 Time = 'time'
 GND = '0'
 
+# Names of the enumerated option values, in the simulator's order
+_optionValues = {
+    'method' : ['trap', 'gear'],
+    'lulibrary' : ['superlu', 'dense', 'cktlu', 'auto'],
+    'luordering' : ['colamd', 'mmd_ata', 'mmd_atplusa', 'natural', 'auto'],
+}
+
 def sign(value):
     """Returns the signe of a value."""
     if value >= 0:
@@ -211,6 +218,11 @@ class Circuit(Circuit_):
         >>> cct.tran('0.1n','1n', '0.5n')
         >>> cct.check_v(1, '1','0.5n')
         True
+        >>> cct.tran('0.1n','2n', '0.5n')
+        >>> cct.check_v(1, '1','0.5n')
+        True
+        >>> cct.check_v(1, '1','1.5n')
+        True
         """
         self.tran_(units.float(tstep), units.float(tstop), units.float(tmax),
                 restart)
@@ -238,6 +250,66 @@ class Circuit(Circuit_):
         """Prints a list of the devices in the circuit."""
         self.devices_()
 
+    def options(self, **options):
+        """
+        Sets simulator options, it's equivalent to the Spice3 .options
+        command. The LU options (lulibrary, ludensesize, luordering,
+        luthreads, lusingle, lucache), chord, chordrate, woodburyrank and
+        predictor have to be set before the first analysis.
+
+        Arguments:
+        options -- name=value pairs, i.e. reltol=1e-4 or method='gear',
+            method can be trap or gear, lulibrary can be superlu, dense,
+            cktlu or auto, luordering can be colamd, mmd_ata, mmd_atplusa,
+            natural or auto
+
+        Example:
+        >>> import eispice
+        >>> cct = eispice.Circuit("Circuit Options Test")
+        >>> cct.Vx = eispice.V(1, eispice.GND, 1)
+        >>> cct.Rx = eispice.R(1, 2, '1')
+        >>> cct.Cx = eispice.C(2, eispice.GND, '1n')
+        >>> cct.options(method='gear', maxorder=3, reltol=1e-4)
+        >>> cct.tran('0.1n','10n')
+        >>> cct.check_v(2, '1','10n')
+        True
+        """
+        for (name, value) in options.items():
+            name = name.lower()
+            if name in _optionValues:
+                value = _optionValues[name].index(str(value).lower())
+            elif isinstance(value, str):
+                value = units.float(value)
+            self.option_(name, float(value))
+
+    def save(self, *variables):
+        """
+        Only keeps the listed variables in the results, by default every
+        node voltage and branch current is kept. Calling it with no
+        arguments goes back to keeping everything. It is equivalent to
+        the Spice3 save command and takes effect on the next analysis
+        that starts from the beginning.
+
+        Arguments:
+        variables -- names of the variables to keep, i.e. 'v(1)' or 'i(Vx)'
+
+        Example:
+        >>> import eispice
+        >>> cct = eispice.Circuit("Circuit Save Test")
+        >>> cct.Vx = eispice.V(1, eispice.GND, 1)
+        >>> cct.Rx = eispice.R(1, 2, '1')
+        >>> cct.Ry = eispice.R(2, eispice.GND, '1')
+        >>> cct.save('v(2)')
+        >>> cct.op()
+        >>> cct.check_v(2, '0.5')
+        True
+        >>> cct.variables
+        ['time', 'v(2)']
+        """
+        self.save_()
+        for variable in variables:
+            self.save_(str(variable))
+
     def _check(self, name, value, time, simValue):
         """
         Raises an exception if the value of the variable at time (seconds)
@@ -1441,6 +1441,7 @@ typedef struct {
     simulator_ *simulator;
     PyArrayObject *results;
     PyObject *variables;
+    int tran; /* results are from a transient that can be continued */
 } circuit_;
 
 /*---------------------------------------------------------------------------*/
@@ -1486,6 +1487,30 @@ static int circuitBuildResults(circuit_ *r, double *data, int dims[2])
 
 /*---------------------------------------------------------------------------*/
 
+/* A continued transient only hands back the points it added, they're
+ * appended to the last results so those still cover the whole run.
+ */
+static int circuitAppendResults(circuit_ *r, double **data, int dims[2])
+{
+    double *all;
+    int old;
+
+    ReturnErrIf(PyArray_DIM(r->results, 1) != dims[1]);
+    old = PyArray_DIM(r->results, 0);
+
+    all = malloc((old + dims[0]) * dims[1] * sizeof(double));
+    ReturnErrIf(all == NULL);
+    memcpy(all, PyArray_DATA(r->results), old * dims[1] * sizeof(double));
+    memcpy(&all[old * dims[1]], *data, dims[0] * dims[1] * sizeof(double));
+    free(*data);
+
+    *data = all;
+    dims[0] += old;
+    return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
 static int circuitBuildNames(circuit_ *r, char **vars, int dims[2])
 {
     long int i;
@@ -1514,6 +1539,7 @@ static PyObject * circuitOP(circuit_ *r, PyObject *args)
 
     ReturnNULLIf(circuitBuildResults(r, data, dims));
     ReturnNULLIf(circuitBuildNames(r, vars, dims));
+    r->tran = 0;
 
     Py_RETURN_NONE;
 }
@@ -1523,7 +1549,7 @@ static PyObject * circuitOP(circuit_ *r, PyObject *args)
 static PyObject * circuitTran(circuit_ *r, PyObject *args)
 {
     double tstep, tstop, tmax = 0.0;
-    int restart;
+    int restart = 0;
     double *data;
     int dims[2];
     char **vars;
@@ -1535,8 +1561,37 @@ static PyObject * circuitTran(circuit_ *r, PyObject *args)
     ReturnNULLIf(simulatorRunTransient(r->simulator, tstep, tstop, tmax,
             restart, &data, &vars, &dims[0], &dims[1]));
 
+    if(!restart && r->tran && (r->results != NULL)) {
+        ReturnNULLIf(circuitAppendResults(r, &data, dims));
+    }
     ReturnNULLIf(circuitBuildResults(r, data, dims));
     ReturnNULLIf(circuitBuildNames(r, vars, dims));
+    r->tran = 1;
+
+    Py_RETURN_NONE;
+}
+
+/*------------------------------- Save Variables ----------------------------*/
+
+static PyObject * circuitSave(circuit_ *r, PyObject *args)
+{
+    char *variable = NULL;
+
+    ReturnNULLIf(!PyArg_ParseTuple(args, "|z:save", &variable));
+    ReturnNULLIf(simulatorSave(r->simulator, variable));
+
+    Py_RETURN_NONE;
+}
+
+/*------------------------------- Set Options -------------------------------*/
+
+static PyObject * circuitOption(circuit_ *r, PyObject *args)
+{
+    char *name;
+    double value;
+
+    ReturnNULLIf(!PyArg_ParseTuple(args, "sd:option", &name, &value));
+    ReturnNULLIf(simulatorSetOption(r->simulator, name, value));
 
     Py_RETURN_NONE;
 }
@@ -1558,6 +1613,10 @@ static PyMethodDef circuitMethods[] = {
             PyDoc_STR("Transient Analysis")},
     {"devices_", (PyCFunction)circuitPrintDevices, METH_VARARGS,
             PyDoc_STR("Print Circuit")},
+    {"save_", (PyCFunction)circuitSave, METH_VARARGS,
+            PyDoc_STR("Save Variables")},
+    {"option_", (PyCFunction)circuitOption, METH_VARARGS,
+            PyDoc_STR("Set Option")},
     {NULL, NULL}        /* sentinel */
 };
 
@@ -1651,6 +1710,7 @@ static int circuitInit(circuit_ *r, PyObject *args, PyObject *kwds)
 
     r->results = NULL;
     r->variables = NULL;
+    r->tran = 0;
 
     return 0;
 }
@@ -8,8 +8,10 @@ numpy_include = get_python_lib(True) + '/numpy/core/include'
 
 if os.name == 'nt':
     extra_compile_args = ["-mnop-fun-dllimport"]
+    libthread = []
 else:
     extra_compile_args = []
+    libthread = ['pthread']
 
 # set fortran library depending on type of compiler
 try:
@@ -28,8 +30,8 @@ simulator = Extension('simulator_',
     include_dirs = ['./include', numpy_include],
     sources = ['./module/simulatormodule.c'],
     library_dirs=['./libs'],
-    libraries=['simulator', 'superlu', 'lapack', 'blas', 'toms', 'cephes',
-            'calc', 'data', libfortran],
+    libraries=['simulator', 'cktlu', 'superlu', 'lapack', 'blas', 'toms', 'cephes',
+            'calc', 'data', libfortran] + libthread,
     extra_compile_args = extra_compile_args)
 
 setup(name = 'eispice',